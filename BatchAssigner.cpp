@@ -0,0 +1,310 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "BatchAssigner.h"
+#include "Distance.h"
+
+// number of centroids of a panel
+static const size_t PanelWidth = 8;
+
+// number of points of the register blocked kernel
+static const size_t MicroRows  = 4;
+
+// number of points of a tile
+static const size_t TileSize   = 64;
+
+// number of dimensions of a cache block
+static const size_t DimBlock   = 256;
+
+// The dot product kernel is compiled for several instruction sets, and the
+// best one is chosen at load time.
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define BATCH_TARGET_CLONES __attribute__((target_clones("avx512f","avx2","default")))
+#else
+#define BATCH_TARGET_CLONES
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// dots[i][j] = x[i] . panel[j], for the nbRows points of x (row-major,
+// nbRows x dim, nbRows multiple of MicroRows) and the PanelWidth centroids of
+// the panel (dim x PanelWidth).
+//
+BATCH_TARGET_CLONES
+static void computePanelDots(const double* x,
+                             const size_t  nbRows,
+                             const size_t  dim,
+                             const double* panel,
+                             double*       dots)
+{
+    std::fill(dots, dots + nbRows * PanelWidth, 0.0);
+    for(size_t k0=0; k0<dim; k0+=DimBlock)
+    {
+        const size_t k1 = std::min(dim, k0 + DimBlock);
+        for(size_t r=0; r<nbRows; r+=MicroRows)
+        {
+            // one accumulator per row, so they stay in registers
+            double acc0[PanelWidth] = { 0 };
+            double acc1[PanelWidth] = { 0 };
+            double acc2[PanelWidth] = { 0 };
+            double acc3[PanelWidth] = { 0 };
+            const double* x0 = x + r * dim;
+            const double* x1 = x0 + dim;
+            const double* x2 = x1 + dim;
+            const double* x3 = x2 + dim;
+            for(size_t d=k0; d<k1; d++)
+            {
+                const double* c = panel + d * PanelWidth;
+                for(size_t j=0; j<PanelWidth; j++)
+                {
+                    acc0[j] += x0[d] * c[j];
+                    acc1[j] += x1[d] * c[j];
+                    acc2[j] += x2[d] * c[j];
+                    acc3[j] += x3[d] * c[j];
+                }
+            }
+            double* dr = dots + r * PanelWidth;
+            for(size_t j=0; j<PanelWidth; j++)
+            {
+                dr[j]                  += acc0[j];
+                dr[j + PanelWidth]     += acc1[j];
+                dr[j + 2 * PanelWidth] += acc2[j];
+                dr[j + 3 * PanelWidth] += acc3[j];
+            }
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BatchAssigner::BatchAssigner( )
+    :   m_nbCentroid(0)
+    ,   m_dim(0)
+    ,   m_nbPanel(0)
+    ,   m_maxNorm(0)
+    ,   m_errorScale(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void BatchAssigner::setCentroids(const Coord* centroids,
+                                 const size_t nbCentroid,
+                                 const size_t dim)
+{
+    m_nbCentroid = nbCentroid;
+    m_dim        = dim;
+    m_nbPanel    = (nbCentroid + PanelWidth - 1) / PanelWidth;
+    m_centroids.assign(centroids, centroids + nbCentroid * dim);
+
+    // the center: the mean of the centroids (the centroid of an empty
+    // cluster is NaN, and is never the closest)
+    std::vector<bool> bFinite(nbCentroid, true);
+    size_t nbFinite = 0;
+    m_center.assign(dim, 0.0);
+    for(size_t cid=0; cid<nbCentroid; cid++)
+    {
+        const Coord* c = centroids + cid * dim;
+        for(size_t d=0; d<dim && bFinite[cid]; d++)
+        {
+            bFinite[cid] = std::isfinite(c[d]);
+        }
+        if(!bFinite[cid]) continue;
+        for(size_t d=0; d<dim; d++)
+        {
+            m_center[d] += c[d];
+        }
+        nbFinite++;
+    }
+    for(size_t d=0; d<dim && nbFinite>0; d++)
+    {
+        m_center[d] /= (double)nbFinite;
+    }
+
+    // the missing centroids of the last panel are zeros
+    m_panels.assign(m_nbPanel * dim * PanelWidth, 0.0);
+    m_norms.assign(m_nbPanel * PanelWidth, 0.0);
+    m_maxNorm = 0.0;
+    for(size_t cid=0; cid<nbCentroid; cid++)
+    {
+        if(!bFinite[cid])
+        {
+            m_norms[cid] = std::numeric_limits<double>::infinity();
+            continue;
+        }
+        const Coord* c     = centroids + cid * dim;
+        double*      panel = &m_panels[(cid / PanelWidth) * dim * PanelWidth];
+        const size_t j     = cid % PanelWidth;
+
+        double norm = 0.0;
+        for(size_t d=0; d<dim; d++)
+        {
+            const double v = (double)c[d] - m_center[d];
+            panel[d * PanelWidth + j] = v;
+            norm += v * v;
+        }
+        m_norms[cid] = norm;
+        m_maxNorm    = std::max(m_maxNorm, norm);
+    }
+
+    // the error of |x|^2 - 2 x.c + |c|^2 is below (2 dim + 4) eps (|x|^2 + |c|^2),
+    // for each of the two distances compared, and the exact distances
+    // (coordinates in Coord) are within 2 eps of theirs
+    m_errorScale = 8.0 * (double)(dim + 2) * std::numeric_limits<Coord>::epsilon();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t BatchAssigner::exactClosest(const Coord*  point,
+                                   const size_t  current,
+                                   DistanceType& minDist)const
+{
+    size_t closest = m_nbCentroid;
+    minDist = std::numeric_limits<DistanceType>::max();
+    if(current < m_nbCentroid && std::isfinite(m_norms[current]))
+    {
+        closest = current;
+        minDist = coordSquareDistance(point, &m_centroids[current * m_dim], m_dim);
+    }
+    for(size_t cid=0; cid<m_nbCentroid; cid++)
+    {
+        if(cid == current || !std::isfinite(m_norms[cid])) continue;
+
+        const DistanceType dist = coordSquareDistance(point, &m_centroids[cid * m_dim], m_dim);
+        if(dist < minDist || closest == m_nbCentroid)
+        {
+            minDist = dist;
+            closest = cid;
+        }
+    }
+    return closest < m_nbCentroid ? closest : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void BatchAssigner::assignTile(const Coord* const*  points,
+                               const size_t         nbPoints,
+                               size_t*              closest,
+                               DistanceType*        minDist,
+                               std::vector<double>& buffer)const
+{
+    const size_t nbRows = ((nbPoints + MicroRows - 1) / MicroRows) * MicroRows;
+    double* x     = &buffer[0];
+    double* xnorm = x + TileSize * m_dim;
+    double* dots  = xnorm + TileSize;
+
+    // packs the tile, centered, the missing rows are zeros
+    for(size_t i=0; i<nbPoints; i++)
+    {
+        double norm = 0.0;
+        for(size_t d=0; d<m_dim; d++)
+        {
+            const double v = (double)points[i][d] - m_center[d];
+            x[i * m_dim + d] = v;
+            norm += v * v;
+        }
+        xnorm[i] = norm;
+    }
+    std::fill(x + nbPoints * m_dim, x + nbRows * m_dim, 0.0);
+
+    // the closest and the second closest centroids
+    size_t best[TileSize];
+    double bestDist[TileSize];
+    double secondDist[TileSize];
+    for(size_t i=0; i<nbPoints; i++)
+    {
+        best[i]       = 0;
+        bestDist[i]   = std::numeric_limits<double>::max();
+        secondDist[i] = std::numeric_limits<double>::max();
+    }
+
+    for(size_t p=0; p<m_nbPanel; p++)
+    {
+        computePanelDots(x, nbRows, m_dim, &m_panels[p * m_dim * PanelWidth], dots);
+
+        const size_t nbInPanel = std::min(PanelWidth, m_nbCentroid - p * PanelWidth);
+        const double* cnorm    = &m_norms[p * PanelWidth];
+        for(size_t i=0; i<nbPoints; i++)
+        {
+            double dist[PanelWidth];
+            for(size_t j=0; j<PanelWidth; j++)
+            {
+                dist[j] = xnorm[i] - 2.0 * dots[i * PanelWidth + j] + cnorm[j];
+            }
+            for(size_t j=0; j<nbInPanel; j++)
+            {
+                if(dist[j] < bestDist[i])
+                {
+                    secondDist[i] = bestDist[i];
+                    bestDist[i]   = dist[j];
+                    best[i]       = p * PanelWidth + j;
+                }
+                else if(dist[j] < secondDist[i])
+                {
+                    secondDist[i] = dist[j];
+                }
+            }
+        }
+    }
+
+    for(size_t i=0; i<nbPoints; i++)
+    {
+        // the closest centroid is certain when the second one is farther
+        // than the rounding error: it is then closer than the current one
+        const double margin = m_errorScale * (xnorm[i] + m_maxNorm);
+        DistanceType dist   = 0;
+        if(secondDist[i] - bestDist[i] > margin)
+        {
+            closest[i] = best[i];
+            if(minDist) dist = coordSquareDistance(points[i], &m_centroids[best[i] * m_dim], m_dim);
+        }
+        else
+        {
+            // a near tie: the exact distances, the current centroid wins
+            closest[i] = exactClosest(points[i], closest[i], dist);
+        }
+        if(minDist) minDist[i] = dist;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void BatchAssigner::assign(const Coord* const* points,
+                           const size_t        nbPoints,
+                           size_t*             closest,
+                           DistanceType*       minDist)const
+{
+    if(m_nbCentroid == 0) return;
+
+    std::vector<double> buffer(TileSize * m_dim + TileSize + TileSize * PanelWidth);
+    for(size_t begin=0; begin<nbPoints; begin+=TileSize)
+    {
+        const size_t nb = std::min(TileSize, nbPoints - begin);
+        assignTile(points + begin, nb, closest + begin, minDist ? minDist + begin : 0, buffer);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void BatchAssigner::assign(const Coord*  points,
+                           const size_t  nbPoints,
+                           size_t*       closest,
+                           DistanceType* minDist)const
+{
+    if(m_nbCentroid == 0) return;
+
+    std::vector<double> buffer(TileSize * m_dim + TileSize + TileSize * PanelWidth);
+    const Coord* rows[TileSize];
+    for(size_t begin=0; begin<nbPoints; begin+=TileSize)
+    {
+        const size_t nb = std::min(TileSize, nbPoints - begin);
+        for(size_t i=0; i<nb; i++)
+        {
+            rows[i] = points + (begin + i) * m_dim;
+        }
+        assignTile(rows, nb, closest + begin, minDist ? minDist + begin : 0, buffer);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
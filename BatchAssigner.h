@@ -0,0 +1,104 @@
+#ifndef _BatchAssigner_h_
+#define _BatchAssigner_h_
+
+#include <vector>
+#include "Point.h"
+
+// Below this number of centroids, the point by point kernels are faster
+static const size_t BatchAssignMinCentroids = 16;
+
+//
+// Assigns points to their closest centroid by tiles of points. For a tile,
+// the distances to all the centroids are computed at once, as a matrix
+// product, from:
+//
+//      |x - c|^2 = |x|^2 - 2 x.c + |c|^2
+//
+// The centroids are packed once (setCentroids) in panels of a few centroids,
+// stored dimension by dimension. The dot products of a tile of points and a
+// panel are computed by a register blocked kernel, and the dimension is cut
+// in blocks that fit in the cache.
+//
+// The points and the centroids are centered on the mean of the centroids:
+// far from the origin, the expansion would lose the distances in the
+// cancellation of |x|^2 and 2 x.c. The rounding error of the expansion is
+// bounded: when the second closest centroid is not farther than this bound,
+// the exact distances to all the centroids decide, as squareDistance does.
+// The assignment is then the one of the point by point scan, and the
+// returned distances are exact.
+//
+class BatchAssigner
+{
+///////////////////////////////////////////////////////////////////////////////
+    public:
+///////////////////////////////////////////////////////////////////////////////
+
+                        BatchAssigner       ( )                               ;
+
+    ///
+    /// \brief setCentroids Packs the centroids.
+    /// \param centroids  row-major block of nbCentroid x dim coordinates
+    /// \param nbCentroid number of centroids
+    /// \param dim        dimension
+    ///
+    void                setCentroids        (const Coord* centroids,
+                                             const size_t nbCentroid,
+                                             const size_t dim)                ;
+
+    size_t              nbCentroid          ( )                         const
+    { return m_nbCentroid; }
+
+    size_t              dim                 ( )                         const
+    { return m_dim; }
+
+    ///
+    /// \brief assign Finds the closest centroid of each point.
+    ///               Can be called concurrently.
+    /// \param points   the coordinates of each point
+    /// \param nbPoints number of points
+    /// \param closest  in:  the current centroid of each point, that wins
+    ///                      the ties (or >= nbCentroid: none)
+    ///                 out: the closest centroid of each point
+    /// \param minDist  the square distance to the closest centroid (or 0)
+    ///
+    void                assign              (const Coord* const* points,
+                                             const size_t        nbPoints,
+                                             size_t*             closest,
+                                             DistanceType*       minDist) const ;
+
+    ///
+    /// \brief assign Same, for a row-major block of nbPoints x dim points.
+    ///
+    void                assign              (const Coord*        points,
+                                             const size_t        nbPoints,
+                                             size_t*             closest,
+                                             DistanceType*       minDist) const ;
+
+///////////////////////////////////////////////////////////////////////////////
+    private:
+///////////////////////////////////////////////////////////////////////////////
+
+    // assigns a tile of at most TileSize points
+    void                assignTile          (const Coord* const* points,
+                                             const size_t        nbPoints,
+                                             size_t*             closest,
+                                             DistanceType*       minDist,
+                                             std::vector<double>& buffer) const ;
+
+    // the closest centroid by the exact distances (current wins the ties)
+    size_t              exactClosest        (const Coord*        point,
+                                             const size_t        current,
+                                             DistanceType&       minDist) const ;
+
+    size_t                  m_nbCentroid                                      ;
+    size_t                  m_dim                                             ;
+    size_t                  m_nbPanel                                         ;
+    std::vector<double>     m_panels                                          ;
+    std::vector<double>     m_norms                                           ;
+    std::vector<Coord>      m_centroids                                       ;
+    std::vector<double>     m_center                                          ;
+    double                  m_maxNorm                                         ;
+    double                  m_errorScale                                      ;
+};
+
+#endif
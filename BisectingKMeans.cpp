@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <algorithm>
+#include <memory>
+
+#include "Parallel.h"
+#include "Random.h"
+#include "BisectingKMeans.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// a new node, from the cluster cid of a cluster set
+static ClusterTreeNode createNode(const ClusterSet& cs,
+                                  const ClusterId   cid,
+                                  const size_t      parent,
+                                  const size_t      depth)
+{
+    const DataSet& ds = cs.dataSet();
+
+    ClusterTreeNode node;
+    node.m_parent = parent;
+    node.m_depth  = depth;
+    const PointIdSet& points = cs.pointsInCluster(cid);
+    node.m_points.assign(points.begin(), points.end());
+
+    const Coord* c = cs.getCentroid(cid).data();
+    node.m_centroid.assign(c, c + ds.dim());
+    node.m_sse = computeEnergy(ds, points, cs.getCentroid(cid));
+    return node;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// The 2-means of a node: its two sub-clusters (points, centroid and SSE),
+// the children of the node if it is split. The cluster set of the 2-means
+// is released as soon as they are computed.
+//
+struct NodeSplit
+{
+    ClusterTreeNode         m_children[2];
+    bool                    m_bFailed;      // the 2-means failed (seeding)
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// The 2-means of some nodes of the tree, one node per chunk: a cluster set of
+// the points of the node, with 2 clusters.
+//
+class NodeSplitTask : public ParallelTask
+{
+public:
+    NodeSplitTask(const DataSet&            ds,
+                  const ClusterTree&        tree,
+                  std::vector<NodeSplit*>&  splits,
+                  const size_t              maxIter,
+                  const KMeansMethod        method,
+                  const KMeansTolerance&    tol,
+                  const size_t              seed)
+        :   m_ds(ds)
+        ,   m_tree(tree)
+        ,   m_splits(splits)
+        ,   m_maxIter(maxIter)
+        ,   m_method(method)
+        ,   m_tol(tol)
+        ,   m_seed(seed)
+    {
+    }
+
+    virtual void run(const size_t chunkIdx)
+    {
+        const size_t           idx  = m_nodes[chunkIdx];
+        const ClusterTreeNode& node = m_tree[idx];
+
+        // the seed of a node depends on its index only
+        ThreadRandomSeed seed(m_seed ^ (idx * 0x9E3779B9UL));
+
+        std::unique_ptr<ClusterSet> pcs(createSubCluster(m_ds, node.m_points, 2));
+        ClusterSet& cs = *pcs;
+        const bool printIter     = false;
+        const bool printSynopsis = false;
+        const double sse = computeKMeans(cs, m_maxIter, printIter, m_method, KMeansPlusPlus, m_tol, printSynopsis);
+
+        NodeSplit* split = new NodeSplit;
+        split->m_bFailed = sse < 0;
+        for(ClusterId cid=0; cid<2; cid++)
+        {
+            split->m_children[cid] = createNode(cs, cid, idx, node.m_depth + 1);
+        }
+        m_splits[idx] = split;
+    }
+
+    const DataSet&                      m_ds;
+    const ClusterTree&                  m_tree;
+    std::vector<NodeSplit*>&            m_splits;
+    const size_t                        m_maxIter;
+    const KMeansMethod                  m_method;
+    const KMeansTolerance               m_tol;
+    const size_t                        m_seed;
+
+    // the nodes to split
+    std::vector<size_t>                 m_nodes;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t computeBisectingKMeans(const DataSet&          ds,
+                              const size_t            nbLeaves,
+                              const size_t            maxIter,
+                              const KMeansMethod      method,
+                              const KMeansTolerance&  tol,
+                              ClusterTree&            tree,
+                              const bool              bVerbose)
+{
+    tree.resize(0);
+    if(ds.size() == 0)
+    {
+        return 0;
+    }
+
+    // the root: all the points
+    {
+        ClusterSet all(ds, 1);
+        for(size_t i=0; i<ds.size(); i++)
+        {
+            all.addPointToCluster(all.point(i), 0);
+        }
+        all.compute_centroids( );
+        tree.push_back(createNode(all, 0, NoClusterNode, 0));
+    }
+
+    // the 2-means of each leaf (0: not computed yet), and the nodes that
+    // cannot be split (identical points)
+    std::vector<NodeSplit*> splits(1, (NodeSplit*)0);
+    std::vector<bool>       bFinal(1, false);
+
+    const size_t seed = ((size_t)randomInteger() << 16) ^ (size_t)randomInteger();
+    NodeSplitTask task(ds, tree, splits, maxIter, method, tol, seed);
+
+    size_t nbLeaf = 1;
+    while(nbLeaf < nbLeaves)
+    {
+        // the leaves that can be split, by decreasing SSE
+        std::vector<std::pair<double, size_t> > candidates;
+        for(size_t i=0; i<tree.size(); i++)
+        {
+            if(tree[i].isLeaf() && !bFinal[i] && tree[i].m_points.size() >= 2)
+            {
+                candidates.push_back(std::make_pair(-tree[i].m_sse, i));
+            }
+        }
+        if(candidates.empty())
+        {
+            break;
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        // the splits of the leaves that may be split next, in parallel
+        const size_t nbNext = std::min(candidates.size(), nbLeaves - nbLeaf);
+        task.m_nodes.resize(0);
+        for(size_t i=0; i<nbNext; i++)
+        {
+            if(!splits[candidates[i].second]) task.m_nodes.push_back(candidates[i].second);
+        }
+        parallelFor(task, task.m_nodes.size());
+
+        // the leaf of highest SSE, with two non empty sub-clusters
+        size_t chosen  = NoClusterNode;
+        bool   bFailed = false;
+        for(size_t i=0; i<candidates.size() && chosen==NoClusterNode && !bFailed; i++)
+        {
+            const size_t idx = candidates[i].second;
+            if(!splits[idx])
+            {
+                // the next round computes it
+                break;
+            }
+            if(splits[idx]->m_bFailed)
+            {
+                fprintf(stdout, "Error: bisect: the 2-means of node %ld failed\n", idx);
+                bFailed = true;
+                continue;
+            }
+            if(splits[idx]->m_children[0].m_points.empty() || splits[idx]->m_children[1].m_points.empty())
+            {
+                bFinal[idx] = true;
+                delete splits[idx];
+                splits[idx] = 0;
+                continue;
+            }
+            chosen = idx;
+        }
+        if(bFailed)
+        {
+            tree.resize(0);
+            nbLeaf = 0;
+            break;
+        }
+        if(chosen == NoClusterNode)
+        {
+            continue;
+        }
+
+        for(ClusterId cid=0; cid<2; cid++)
+        {
+            tree[chosen].m_children[cid] = tree.size();
+            tree.push_back(ClusterTreeNode());
+            std::swap(tree.back(), splits[chosen]->m_children[cid]);
+            splits.push_back(0);
+            bFinal.push_back(false);
+        }
+        delete splits[chosen];
+        splits[chosen] = 0;
+        nbLeaf++;
+
+        if(bVerbose)
+        {
+            fprintf(stdout, "* Bisect: node %ld (%ld points, sse %g) -> %ld (%ld points), %ld (%ld points)\n",
+                    chosen, tree[chosen].m_points.size(), tree[chosen].m_sse,
+                    tree[chosen].m_children[0], tree[tree[chosen].m_children[0]].m_points.size(),
+                    tree[chosen].m_children[1], tree[tree[chosen].m_children[1]].m_points.size());
+        }
+    }
+    for(size_t i=0; i<splits.size(); i++)
+    {
+        delete splits[i];
+    }
+    return nbLeaf;
+}
+
+////////////////////////////////////////////////////////////////////////////////
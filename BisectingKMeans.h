@@ -0,0 +1,71 @@
+#ifndef _BisectingKMeans_h_
+#define _BisectingKMeans_h_
+
+#include <vector>
+#include "ClusterSet.h"
+#include "ClusterFunctions.h"
+#include "KMeansBounds.h"
+
+// the index of no node (the parent of the root, the children of a leaf)
+const size_t NoClusterNode = (size_t)-1;
+
+//
+// A node of a cluster tree: a cluster, and its two sub-clusters if it was
+// split. The nodes are stored in a vector, the root first.
+//
+struct ClusterTreeNode
+{
+    ClusterTreeNode( )
+        :   m_parent(NoClusterNode)
+        ,   m_depth(0)
+        ,   m_sse(0)
+    {
+        m_children[0] = NoClusterNode;
+        m_children[1] = NoClusterNode;
+    }
+
+    bool isLeaf( )const
+    { return m_children[0] == NoClusterNode; }
+
+    size_t                  m_parent;       // index of the parent node
+    size_t                  m_children[2];  // index of the sub-clusters
+    size_t                  m_depth;        // 0 for the root
+    PointIdVector           m_points;       // the points of the cluster
+    std::vector<Coord>      m_centroid;
+    double                  m_sse;          // sum of the square distances to the centroid
+};
+
+typedef std::vector<ClusterTreeNode> ClusterTree;
+
+///
+/// \brief computeBisectingKMeans Bisecting K-Means: starting from a single
+///                               cluster, the leaf of highest SSE is split
+///                               in two by a 2-means (k-means++ seeding), on
+///                               a cluster set of its points, until there
+///                               are nbLeaves leaves.
+///                               The splits of the leaves that may be split
+///                               next are computed in parallel: they do not
+///                               depend on each other, and each node has its
+///                               own seed (from rand(), see -seed). The tree
+///                               does not depend on the number of threads.
+///                               A pending split keeps the sub-clusters only
+///                               (points, centroid, SSE), not its cluster set.
+/// \param ds       the data set
+/// \param nbLeaves number of leaves (clusters) of the tree
+/// \param maxIter  max number of iterations of each 2-means
+/// \param method   the assignment step of the 2-means
+/// \param tol      the stop rules of the 2-means
+/// \param tree     the cluster tree
+/// \param bVerbose prints the splits
+/// \return the number of leaves: less than nbLeaves if no leaf can be split
+///         (clusters of identical points). 0 (empty tree) if a 2-means fails.
+///
+size_t computeBisectingKMeans(const DataSet&          ds,
+                              const size_t            nbLeaves,
+                              const size_t            maxIter,
+                              const KMeansMethod      method,
+                              const KMeansTolerance&  tol,
+                              ClusterTree&            tree,
+                              const bool              bVerbose);
+
+#endif
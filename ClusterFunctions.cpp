@@ -2,27 +2,71 @@
 #include <fstream>
 #include <boost/foreach.hpp>
 #include <cmath>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <assert.h>
 
+#include "BatchAssigner.h"
+#include "Distance.h"
 #include "GrahamScan.h"
 #include "DataSet.h"
+#include "FixedPoint.h"
+#include "KdTree.h"
+#include "KMeansBounds.h"
+#include "Parallel.h"
 #include "Point.h"
 
 #include "ClusterFunctions.h"
 
+// Compute Centroids, for a given dimension kernel
+template<class Dim>
+static void computeCentroids_(const DataSet&    db,
+                              const PointIdSet& pts,
+                              Point&            centroid)
+{
+    const size_t  dim     = db.dim();
+    const double* weights = db.weights();
+    std::vector<CoordSum> sum(dim, 0.0);
+    double total = 0.0;
+    for(PointIdSet::iterator it=pts.begin(); it!=pts.end(); it++)
+    {
+        if(weights)
+        {
+            // the weighted mean
+            const double w = weights[it->value()];
+            const Coord* p = db.coords(it->value());
+            for(size_t i=0; i<dim; i++) sum[i] += w * p[i];
+            total += w;
+        }
+        else
+        {
+            Dim::accumulate(&sum[0], db.coords(it->value()), dim);
+            total += 1.0;
+        }
+    }
+    Coord* c = centroid.data();
+    for(size_t i=0; i<dim; i++)
+    {
+        c[i] = sum[i] / total;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 // Compute Centroids
 void computeCentroids(const DataSet&    db,
                       const PointIdSet& pts,
                       Point&            centroid)
 {
-    centroid.clear( );
-    size_t iNb = 0;
-    for(PointIdSet::iterator it=pts.begin(); it!=pts.end(); it++)
+    assert(centroid.dim() == db.dim());
+    switch(db.dim())
     {
-        const Point& pt = db[it->value()];
-        centroid += pt;
-        iNb++;
+        case 2:  computeCentroids_< FixedDim<2> >(db, pts, centroid); break;
+        case 3:  computeCentroids_< FixedDim<3> >(db, pts, centroid); break;
+        case 4:  computeCentroids_< FixedDim<4> >(db, pts, centroid); break;
+        default: computeCentroids_< FixedDim<0> >(db, pts, centroid); break;
     }
-    centroid /= (double)iNb;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -67,10 +111,20 @@ ClusterSet* createSubCluster(const DataSet&     ds,
             pointIdVector.push_back( atoi( line.c_str() ) );
         }
     }
-    newClusters = new ClusterSet(ds, nbCluster, &pointIdVector);
+    newClusters = createSubCluster(ds, pointIdVector, nbCluster);
     return newClusters;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// creates a sub-cluster, from a list of points of the data set
+ClusterSet* createSubCluster(const DataSet&       ds,
+                             const PointIdVector& pointIdVector,
+                             const size_t         nbCluster)
+{
+    PointIdVector pointList(pointIdVector);
+    return new ClusterSet(ds, nbCluster, &pointList);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 
@@ -142,7 +196,21 @@ DistanceType computeClusterRadius(const ClusterSet& cs,
 {
     DistanceType maxDist(0);
 
-    const Point& centroid = cs.getCentroid(cid);
+    const Point&        centroid = cs.getCentroid(cid);
+    const DataSet&      ds       = cs.dataSet();
+    const DistanceType* norms    = ds.squareNorms();
+    if(norms)
+    {
+        // |x - c|^2 = |x|^2 - 2 x.c + |c|^2, the |c|^2 is computed once
+        const DistanceType centroidNorm = coordDot(centroid.data(), centroid.data(), ds.dim());
+        BOOST_FOREACH(const PointIdSet::value_type pid, cs.pointsInCluster(cid))
+        {
+            const DistanceType dist2 = norms[pid.value()] + centroidNorm 
+                                     - 2.0 * coordDot(ds.coords(pid.value()), centroid.data(), ds.dim());
+            maxDist = std::max(maxDist, dist2);
+        }
+        return sqrt(maxDist);
+    }
     // For earch PointId in this set
     BOOST_FOREACH(const PointIdSet::value_type pid, cs.pointsInCluster(cid))
     {
@@ -192,7 +260,7 @@ void computeClusterRange(const DataSet&      ds,
 
 void computeClusterBondary(const ClusterSet&    cs,
                            const ClusterId      cid,
-                           std::vector<Point*>& curve,
+                           std::vector<Point>&  curve,
                            const std::string    curveFileName,
                            bool                 bVerbose)
 {
@@ -202,14 +270,27 @@ void computeClusterBondary(const ClusterSet&    cs,
     }
     const PointIdSet& pts = cs.pointsInCluster(cid);                            
 
+    // the views on the cluster points, and the pointers used by the hull.
+    std::vector<Point>  clusterPoints;
     std::vector<Point*> cluster;
+    std::vector<Point*> hull;
 
+    clusterPoints.reserve(pts.size());
     for(PointIdSet::iterator it=pts.begin(); it!=pts.end(); it++)           
     {
-        const Point& pt = cs.point(*it); 
-        cluster.push_back((Point*)(&pt));
+        clusterPoints.push_back(cs.point(*it));
+    }
+    for(size_t i=0; i<clusterPoints.size(); i++)
+    {
+        cluster.push_back(&clusterPoints[i]);
+    }
+    computeConvexHull(cluster, hull, bVerbose);
+
+    curve.resize(0);
+    for(size_t i=0; i<hull.size(); i++)
+    {
+        curve.push_back(*hull[i]);
     }
-    computeConvexHull(cluster, curve, bVerbose);
 
     if(bVerbose)
     {
@@ -225,10 +306,10 @@ void computeClusterBondary(const ClusterSet&    cs,
             {
                 for(size_t i=0; i<curve.size(); i++)
                 {
-                    fprintf(f, "%s\n", curve[i]->toString(bPrintBracket).c_str());
+                    fprintf(f, "%s\n", curve[i].toString(bPrintBracket).c_str());
                 }
                 // adds the first point to make the curve closed
-                fprintf(f, "%s\n", curve[0]->toString(bPrintBracket).c_str());
+                fprintf(f, "%s\n", curve[0].toString(bPrintBracket).c_str());
             }
             fclose(f);
         }
@@ -272,8 +353,8 @@ void xcomputeClusterBondary(const ClusterSet&    cs,
             const Point& pt = cs.point(*it);
             size_t iGridPos = round( ((pt[0] - minCoord[0] ) / deltax) );
             
-            min_y[iGridPos] = std::min( min_y[iGridPos], pt[1] );
-            max_y[iGridPos] = std::max( max_y[iGridPos], pt[1] );
+            min_y[iGridPos] = std::min( min_y[iGridPos], (double)pt[1] );
+            max_y[iGridPos] = std::max( max_y[iGridPos], (double)pt[1] );
         }
         
         Point::CoordVector coord(2);
@@ -358,6 +439,87 @@ double computeAverageSilouette(const ClusterSet& cs,
     return s;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//
+// The simplified silhouette, by chunks of points: the distances to the
+// centroids replace the mean distances to the points of the clusters.
+//
+class CentroidSilhouetteTask : public ParallelTask
+{
+public:
+    CentroidSilhouetteTask(const ClusterSet& cs, const size_t nbChunks)
+        :   m_cs(cs)
+        ,   m_dim(cs.dataSet().dim())
+        ,   m_nbChunks(nbChunks)
+        ,   m_centroids(cs.nbCluster() * m_dim)
+        ,   m_chunkSums(nbChunks, 0.0)
+    {
+        for(ClusterId cid=0; cid<cs.nbCluster(); cid++)
+        {
+            const Coord* c = cs.getCentroid(cid).data();
+            std::copy(c, c + m_dim, &m_centroids[cid * m_dim]);
+        }
+    }
+
+    virtual void run(const size_t chunkIdx)
+    {
+        size_t begin = 0;
+        size_t end   = 0;
+        chunkRange(m_cs.nbPoints(), m_nbChunks, chunkIdx, begin, end);
+
+        const size_t nbCluster = m_cs.nbCluster();
+        double sum = 0.0;
+        for(size_t idx=begin; idx<end; idx++)
+        {
+            const Point     p   = m_cs.point(idx);
+            const ClusterId own = m_cs.clusterContainingPoint(p.getId());
+
+            // own centroid, and the closest other one (empty clusters: NaN)
+            const double a = sqrt(coordSquareDistance(p.data(), &m_centroids[own * m_dim], m_dim));
+            double       b = std::numeric_limits<double>::max();
+            for(size_t cid=0; cid<nbCluster; cid++)
+            {
+                if(cid == own) continue;
+                const double dist = coordSquareDistance(p.data(), &m_centroids[cid * m_dim], m_dim);
+                if(dist < b) b = dist;
+            }
+            b = sqrt(b);
+
+            const double m = std::max(a, b);
+            if(m > 0)
+            {
+                sum += m_cs.dataSet().weight(p.getId().value()) * (b - a) / m;
+            }
+        }
+        m_chunkSums[chunkIdx] = sum;
+    }
+
+    const ClusterSet&       m_cs;
+    const size_t            m_dim;
+    const size_t            m_nbChunks;
+    std::vector<Coord>      m_centroids;
+    std::vector<double>     m_chunkSums;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+double computeCentroidSilhouette(const ClusterSet& cs)
+{
+    if(cs.nbCluster() < 2 || cs.nbPoints() == 0)
+    {
+        return 0.0;
+    }
+    CentroidSilhouetteTask task(cs, getNbThreads());
+    parallelFor(task, task.m_nbChunks);
+
+    double sum = 0.0;
+    for(size_t i=0; i<task.m_nbChunks; i++) sum += task.m_chunkSums[i];
+
+    double total = 0.0;
+    for(ClusterId cid=0; cid<cs.nbCluster(); cid++) total += cs.clusterWeight(cid);
+    return sum / total;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 DistanceType computeAverageDistance(const ClusterSet& cs,
@@ -370,15 +532,25 @@ DistanceType computeAverageDistance(const ClusterSet& cs,
     DistanceType   dist = 0.0;
     size_t iNb  = 0;
     
-    const PointIdSet&  pointsInSet = cs.pointsInCluster(to_cid);
-    const Point&       p0          = cs.point(pid);
+    const PointIdSet&   pointsInSet = cs.pointsInCluster(to_cid);
+    const Point&        p0          = cs.point(pid);
+    const DataSet&      ds          = cs.dataSet();
+    const DistanceType* norms       = ds.squareNorms();
     for(PointIdSet::iterator it = pointsInSet.begin(); it != pointsInSet.end(); it++)
     {
         const Point& pt = cs.point(*it);
         bool add = sameCluster
             ?   pt.getId() != p0.getId()
             :   true;
-        if(add)
+        if(add && norms)
+        {
+            // from the cached norms: |x - y|^2 = |x|^2 - 2 x.y + |y|^2
+            const DistanceType dist2 = norms[pid.value()] + norms[it->value()] 
+                                     - 2.0 * coordDot(p0.data(), pt.data(), ds.dim());
+            dist += sqrt(std::max(DistanceType(0), dist2));
+            iNb  += 1;
+        }
+        else if(add)
         {
             dist += p0.distanceTo(pt);
             iNb  += 1;
@@ -395,16 +567,25 @@ double computeEnergy(const DataSet&    ds,
                      const PointIdSet& clusterSet,
                      const Point&      centroid)
 {
-    DistanceType dist = 0.0;
-    size_t iNb = 0;
+    const size_t dim = ds.dim();
+    double energy = 0.0;
     for(PointIdSet::iterator it = clusterSet.begin(); it != clusterSet.end(); it++)
     {
-        const Point& pt = ds[it->value()];
-        dist += pointDiffNorm(centroid, pt);
-        iNb  += 1;
+        energy += ds.weight(it->value()) * coordSquareDistance(ds.coords(it->value()), centroid.data(), dim);
     }
-    dist /= (double)iNb;
-    return dist;
+    return energy;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double computeInertia(const ClusterSet& cs)
+{
+    double inertia = 0.0;
+    for(ClusterId cid=0; cid<cs.nbCluster(); cid++)
+    {
+        inertia += computeEnergy(cs.dataSet(), cs.pointsInCluster(cid), cs.getCentroid(cid));
+    }
+    return inertia;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -430,28 +611,303 @@ void printClusterSynopsis(const ClusterSet& cs)
 }
 
 ///////////////////////////////////////////////////////////////////////////////
+//
+// One Lloyd iteration on chunks of the points: each point is assigned to its
+// closest centroid (its current centroid wins the ties). The chunks run
+// concurrently; the moves are applied after, by the caller (the cluster set
+// updates its sums with the moved points only).
+//
+// The inertia of the pass (sum of the square distances of the points to
+// their closest centroid) comes from the distances of the assignment. The
+// bounds of the accelerated methods are not exact distances: the inertia is
+// then computed only on request (m_bInertia).
+//
+// The closest centroid is computed by one of:
+//  - the fixed dimension kernels, point by point,
+//  - the batch assigner (many clusters),
+//  - the distance bounds of an accelerated method (see KMeansBounds),
+//  - the kd-tree filtering, by subtrees (see KdTree).
+//
+template<class Dim>
+class KMeansAssignTask : public ParallelTask
+{
+public:
+    KMeansAssignTask(const ClusterSet& cs, const size_t nbChunks)
+        :   m_nbChunks(nbChunks)
+        ,   m_nbCluster(cs.nbCluster())
+        ,   m_dim(cs.dataSet().dim())
+        ,   m_nbDataSetPoints(cs.dataSet().size())
+        ,   m_centroids(0)
+        ,   m_assigner(0)
+        ,   m_bounds(0)
+        ,   m_kdTree(0)
+        ,   m_bInertia(false)
+        ,   m_chunkInertia(nbChunks, 0.0)
+        ,   m_weights(cs.dataSet().weights())
+    {
+        // the points do not move in the data set: gathered once
+        const DataSet& ds = cs.dataSet();
+        const size_t   nb = cs.nbPoints();
+        m_pids.resize(nb);
+        m_points.resize(nb);
+        m_current.resize(nb);
+        for(size_t idx=0; idx<nb; idx++)
+        {
+            const PointId pid = cs.point(idx).getId();
+            m_pids[idx]    = pid.value();
+            m_points[idx]  = ds.coords(pid.value());
+            m_current[idx] = cs.clusterContainingPoint(pid);
+        }
+        m_closest = m_current;
+    }
+
+    // before a pass: each point in its current cluster
+    void reset( )
+    {
+        m_closest = m_current;
+        m_chunkInertia.assign(m_nbChunks, 0.0);
+        if(m_assigner && m_minDist.empty())
+        {
+            m_minDist.resize(m_points.size());
+        }
+    }
+
+    // the inertia of the last pass
+    double inertia( )const
+    {
+        double total = 0.0;
+        for(size_t i=0; i<m_nbChunks; i++) total += m_chunkInertia[i];
+        return total;
+    }
+
+    virtual void run(const size_t chunkIdx)
+    {
+        size_t begin = 0;
+        size_t end   = 0;
+        if(m_kdTree)
+        {
+            // the chunks are subtrees, the inertia comes with the filtering
+            chunkRange(m_kdTree->nbFrontier(), m_nbChunks, chunkIdx, begin, end);
+            m_chunkInertia[chunkIdx] = m_kdTree->filter(begin, end, m_centroids, m_nbCluster, 
+                                                        &m_current[0], &m_closest[0]);
+            return;
+        }
+        chunkRange(m_points.size(), m_nbChunks, chunkIdx, begin, end);
+        if(begin == end) return;
+
+        double inertia = 0.0;
+        if(m_bounds)
+        {
+            m_bounds->assign(&m_points[0], begin, end, &m_closest[0]);
+            if(m_bInertia)
+            {
+                inertia = closestInertia(begin, end);
+            }
+        }
+        else if(m_assigner)
+        {
+            // the distances of the assigner are exact
+            m_assigner->assign(&m_points[begin], end - begin, &m_closest[begin], &m_minDist[begin]);
+            for(size_t idx=begin; idx<end; idx++)
+            {
+                inertia += weight(idx) * m_minDist[idx];
+            }
+        }
+        else
+        {
+            inertia = assign(begin, end);
+        }
+        m_chunkInertia[chunkIdx] = inertia;
+    }
+
+    // the square distances of the points [begin, end) to their closest centroid
+    double closestInertia(const size_t begin, const size_t end)const
+    {
+        double inertia = 0.0;
+        for(size_t idx=begin; idx<end; idx++)
+        {
+            inertia += weight(idx) * Dim::squareDistance(m_points[idx], m_centroids + m_closest[idx] * m_dim, m_dim);
+        }
+        return inertia;
+    }
 
-void computeKMeans(ClusterSet& cs, const size_t maxIter, const bool bPrintIteration)
+    // the weight of a point of the cluster set
+    double weight(const size_t idx)const
+    { return m_weights ? m_weights[m_pids[idx]] : 1.0; }
+
+    // true if the points are the ones of the data set, in its order
+    bool isDataSetOrder( )const
+    {
+        if(m_pids.size() != m_nbDataSetPoints) return false;
+        for(size_t idx=0; idx<m_pids.size(); idx++)
+        {
+            if(m_pids[idx] != idx) return false;
+        }
+        return true;
+    }
+
+    // the kd-tree of the points of the cluster set
+    KdTree* createKdTree(const DataSet& ds)const
+    {
+        std::vector<double> weights(ds.weights() ? m_pids.size() : 0);
+        for(size_t idx=0; idx<weights.size(); idx++)
+        {
+            weights[idx] = weight(idx);
+        }
+        return new KdTree(m_points, m_dim, weights.empty() ? 0 : &weights[0]);
+    }
+
+    // the point by point assignment, returns the inertia
+    double assign(const size_t begin, const size_t end)
+    {
+        double inertia = 0.0;
+        for(size_t idx=begin; idx<end; idx++)
+        {
+            const Coord* p    = m_points[idx];
+            const size_t from = m_current[idx];
+
+            // distance point to its centroid
+            DistanceType minDistance = Dim::squareDistance(p, m_centroids + from * m_dim, m_dim);
+            size_t       to          = from;
+
+            // foreach centroid, find the closest centroid
+            for(size_t cid=0; cid<m_nbCluster; cid++)
+            {
+                if(cid == from) continue;
+
+                const DistanceType dist = Dim::squareDistance(p, m_centroids + cid * m_dim, m_dim);
+                if(dist < minDistance)
+                {
+                    minDistance = dist;
+                    to          = cid;
+                }
+            }
+            m_closest[idx] = to;
+            inertia       += weight(idx) * minDistance;
+        }
+        return inertia;
+    }
+
+    const size_t                        m_nbChunks;
+    const size_t                        m_nbCluster;
+    const size_t                        m_dim;
+    const size_t                        m_nbDataSetPoints;
+
+    // the centroids, and the assignment method
+    const Coord*                        m_centroids;
+    const BatchAssigner*                m_assigner;
+    KMeansBounds*                       m_bounds;
+    const KdTree*                       m_kdTree;
+
+    // the inertia of each chunk (always, but with bounds if m_bInertia)
+    bool                                m_bInertia;
+    std::vector<double>                 m_chunkInertia;
+    std::vector<DistanceType>           m_minDist;
+
+    // the weight of each point of the data set (0: all 1)
+    const double*                       m_weights;
+
+    // the points of the cluster set
+    std::vector<size_t>                 m_pids;
+    std::vector<const Coord*>           m_points;
+
+    // the cluster of each point, before and after the pass
+    std::vector<size_t>                 m_current;
+    std::vector<size_t>                 m_closest;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// The stop rule met by an iteration, or 0 to go on
+static const char* kmeansStopRule(const KMeansTolerance& tol,
+                                  const size_t           nbMove,
+                                  const size_t           nbPoints,
+                                  const double           maxShift,
+                                  const double           inertia,
+                                  const double           prevInertia,
+                                  const size_t           iter)
+{
+    if(nbMove == 0)
+    {
+        return "no point moving";
+    }
+    if(tol.m_movedFraction > 0 && nbMove <= tol.m_movedFraction * nbPoints)
+    {
+        return "moved points";
+    }
+    if(tol.m_centroidShift > 0 && maxShift <= tol.m_centroidShift)
+    {
+        return "centroid shift";
+    }
+    if(tol.m_inertiaChange > 0 && iter > 0 && prevInertia - inertia <= tol.m_inertiaChange * prevInertia)
+    {
+        return "inertia change";
+    }
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// K-Means loop.
+template<class Dim>
+static double computeKMeans_(ClusterSet&             cs, 
+                             const size_t            maxIter, 
+                             const bool              bPrintIteration,
+                             const KMeansMethod      method,
+                             const InitMethod        init,
+                             const KMeansTolerance&  tol,
+                             const bool              bPrintSynopsis)
 {
-    bool bPrintSynodsis  = true;
-   
     const size_t nbCluster = cs.nbCluster( );
+    const size_t dim       = cs.dataSet().dim();
     
     //
     // Initial partition of points
     //
-    //    initial_partition_points(ForgyMethod);
-    cs.initial_partition_points(RandomPartition);
+    if(!cs.initial_partition_points(init))
+    {
+        return -1.0;
+    }
     
-    if(bPrintSynodsis)
+    if(bPrintSynopsis)
     {
         std::cout << "*********************************************************" << std::endl;
         std::cout << "* K-Means begin"                                           << std::endl;
+        std::cout << "* Method: " << kmeansMethodName(method)                    << std::endl;
         std::cout << "*"                                                         << std::endl;
         printClusterSynopsis(cs);
     }
+    cs.compute_centroids( );
+
+    // the points are split in chunks, one per thread
+    KMeansAssignTask<Dim>  task(cs, getNbThreads());
+    BatchAssigner          assigner;
+    std::vector<Coord>     centroids(nbCluster * dim);
+
+    // the distance bounds of an accelerated method
+    std::unique_ptr<KMeansBounds> bounds(createKMeansBounds(method, cs.nbPoints(), nbCluster, dim));
+    task.m_bounds = bounds.get();
+
+    // the kd-tree filtering: the tree of the data set if any, and if the
+    // points are the ones of the data set, in its order
+    std::unique_ptr<KdTree> kdTree;
+    if(method == KMeansFilter && cs.nbPoints() > 0)
+    {
+        task.m_kdTree = cs.dataSet().kdTree();
+        if(!task.m_kdTree || !task.isDataSetOrder())
+        {
+            kdTree.reset(task.createKdTree(cs.dataSet()));
+            task.m_kdTree = kdTree.get();
+        }
+    }
+
+    // many clusters: the dot product form (confirmed by exact distances)
+    const bool bBatch = !task.m_bounds && !task.m_kdTree && nbCluster >= BatchAssignMinCentroids;
+
+    // the inertia of each pass: free, but with the bounds
+    task.m_bInertia = bPrintIteration || tol.m_inertiaChange > 0;
     
-    size_t iter = 0;
+    size_t      iter        = 0;
+    double      prevInertia = 0;
+    const char* stopRule    = "max iterations";
     bool some_point_is_moving = true;
     
     // the K-Mean Loop
@@ -460,7 +916,6 @@ void computeKMeans(ClusterSet& cs, const size_t maxIter, const bool bPrintIterat
         some_point_is_moving = false;
         size_t nbMove  = 0;
         
-        cs.compute_centroids( );
         if(bPrintIteration)
         {
             fprintf(stdout, "\n");
@@ -472,62 +927,57 @@ void computeKMeans(ClusterSet& cs, const size_t maxIter, const bool bPrintIterat
             }
         }
                    
-        // for each point
-        for(size_t pid=0; pid<cs.nbPoints(); pid++)
+        // contiguous copy of the centroids
+        for(size_t cid=0; cid<nbCluster; cid++)
         {
-            const Point&   p             = cs.point(pid);
-            const Point&   p_centroid    = cs.getCentroidOfPoint(p.getId());
-            bool           moveThisPoint = false;
-            
-            
-            // distance point pid to its centroid
-            const DistanceType distPointToCentroid = p_centroid.distanceTo(p);
-            
-            // fprintf(stdout, "pid: %ld %s distance to centroid %g\n", pid, p.toString().c_str(), distPointToCentroid);
-            
-            // foreach centroid, find the closest centroid
-            DistanceType minDistance = distPointToCentroid;
-            
-            ClusterId to_cluster = 0;
-    
-            //std::cout << "****** " << pid << " " << p.getId() << "\n";
-            
-            for(size_t cid=0; cid<nbCluster; cid++)
-            {
-                const Point& centroid = cs.getCentroid(cid);
-                
-                //std::cout << " centroidID: " << centroid.getId() << " pCentroid: " << p_centroid.getId() << std::endl;
-                if(centroid.getId() == p_centroid.getId()) continue;
-                
-                // distance from point to a centroid
-                const DistanceType distPointToOtherCentroid = p.distanceTo(centroid);
-                
-                //std::cout << "pid: " << pid << ", cid: " << cid  << ", distToCent: " << distPointToCentroid << " " << distPointToOtherCentroid <<  " : "  << (distPointToOtherCentroid<distPointToCentroid) << "\n";
-                if(distPointToOtherCentroid < distPointToCentroid)
-                {
-                    minDistance = distPointToOtherCentroid;
-                    to_cluster = cid;
-                    moveThisPoint = true;
-                }
-            }
-            // move towards a closer centroid
-            if(moveThisPoint>0)
+            const Coord* c = cs.getCentroid(cid).data();
+            std::copy(c, c + dim, &centroids[cid * dim]);
+        }
+        task.m_centroids = &centroids[0];
+        if(task.m_bounds)
+        {
+            task.m_bounds->setCentroids(&centroids[0]);
+        }
+        if(bBatch)
+        {
+            assigner.setCentroids(&centroids[0], nbCluster, dim);
+            task.m_assigner = &assigner;
+        }
+
+        // find the closest centroid of each point, in parallel
+        task.reset( );
+        parallelFor(task, task.m_nbChunks);
+
+        // move each point to its closest centroid
+        for(size_t idx=0; idx<cs.nbPoints(); idx++)
+        {
+            const size_t to_cluster = task.m_closest[idx];
+            if(to_cluster != task.m_current[idx])
             {
-                // remove point from its current cluster
+                const Point p = cs.point(idx);
                 cs.removePointFromCluster(p);
-                if(bPrintIteration)
-                {
-                    // std::cout << " Moving " << nbMove << " points\n";
-                }
                 cs.addPointToCluster(p, to_cluster);
-                some_point_is_moving = true;
+                task.m_current[idx] = to_cluster;
                 nbMove++;
-                // std::cout << "\t\tmove to cluster:" << to_cluster << std::endl;
             }
         }
+        some_point_is_moving = (nbMove > 0);
+
+        // the new centroids: O(k.dim), the sums follow the moves
+        cs.compute_centroids( );
+
+        // the largest centroid move (the empty clusters are not numbers)
+        double maxShift = 0;
+        for(size_t cid=0; cid<nbCluster; cid++)
+        {
+            const double shift = sqrt(coordSquareDistance(&centroids[cid * dim], cs.getCentroid(cid).data(), dim));
+            if(shift > maxShift) maxShift = shift;
+        }
+        const double inertia = task.inertia( );
+
         if(bPrintIteration)
         {
-            fprintf(stdout, "     > Moving points %ld", nbMove);
+            fprintf(stdout, "     > Moving points %ld, inertia: %g, max shift: %g", nbMove, inertia, maxShift);
         }
         
         if(0 && bPrintIteration)
@@ -543,20 +993,60 @@ void computeKMeans(ClusterSet& cs, const size_t maxIter, const bool bPrintIterat
                 std::cout << std::endl;
             }
         }
+        const char* rule = kmeansStopRule(tol, nbMove, cs.nbPoints(), maxShift, inertia, prevInertia, iter);
+        prevInertia = inertia;
         iter++;
-        
+
+        if(rule)
+        {
+            stopRule = rule;
+            break;
+        }
         if(iter > maxIter) break;
     } // end while (some_point_is_moving)
-    
-    if(bPrintSynodsis)
+
+    const double inertia = computeInertia(cs);
+    if(bPrintSynopsis)
     {
         std::cout << std::endl;
         std::cout << std::endl;
-        std::cout << "K-Means: end: nb_iter: " << iter << std::endl;
+        std::cout << "K-Means: end: nb_iter: " << iter << ", stop: " << stopRule << ", inertia: " << inertia << std::endl;
         printClusterSynopsis(cs);
         std::cout << "*********************************************************" << std::endl;
     }
+    return inertia;
+}
 
+///////////////////////////////////////////////////////////////////////////////
+
+static double computeKMeans_(ClusterSet&             cs, 
+                             const size_t            maxIter, 
+                             const bool              bPrintIteration,
+                             const KMeansMethod      method,
+                             const InitMethod        init,
+                             const KMeansTolerance&  tol,
+                             const bool              bPrintSynopsis)
+{
+    switch(cs.dataSet().dim())
+    {
+        case 2:  return computeKMeans_< FixedDim<2> >(cs, maxIter, bPrintIteration, method, init, tol, bPrintSynopsis);
+        case 3:  return computeKMeans_< FixedDim<3> >(cs, maxIter, bPrintIteration, method, init, tol, bPrintSynopsis);
+        case 4:  return computeKMeans_< FixedDim<4> >(cs, maxIter, bPrintIteration, method, init, tol, bPrintSynopsis);
+        default: return computeKMeans_< FixedDim<0> >(cs, maxIter, bPrintIteration, method, init, tol, bPrintSynopsis);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+double computeKMeans(ClusterSet&            cs, 
+                     const size_t           maxIter, 
+                     const bool             bPrintIteration, 
+                     const KMeansMethod     method,
+                     const InitMethod       init,
+                     const KMeansTolerance& tol,
+                     const bool             bPrintSynopsis)
+{
+    return computeKMeans_(cs, maxIter, bPrintIteration, method, init, tol, bPrintSynopsis);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
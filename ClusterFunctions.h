@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "ClusterSet.h"
+#include "KMeansBounds.h"
 
 ///
 /// \brief createSubCluster Creates a sub-clusterset, from a given clusterID.
@@ -33,6 +34,19 @@ ClusterSet* createSubCluster(const DataSet&     ds,
                              const std::string  pointIdFile,
                              const size_t       nbCluster);
 
+///
+/// \brief createSubCluster Creates a new cluster object, on a list of points
+///                         of the DataSet
+/// \param ds DataSet to use
+/// \param pointIdVector the index of the points in the data set to consider
+/// \param nbCluster number of clusters
+/// \return a new ClusterSet object. The client is reponsible for deleting
+///               the new created object.
+///
+ClusterSet* createSubCluster(const DataSet&       ds,
+                             const PointIdVector& pointIdVector,
+                             const size_t         nbCluster);
+
 ///
 /// \brief clustersCreatePlots
 /// \param c
@@ -71,7 +85,8 @@ void computeClusterRange(const DataSet&      ds,
 
 
 ///
-/// \brief computeCentroids Computes the centroid of a set of points
+/// \brief computeCentroids Computes the centroid of a set of points (the
+///                         weighted mean, see DataSet::weights)
 /// \param db the data base object containing the points
 /// \param pts The set containing the index of the points in the data base
 /// \param centroid the computed centroid.
@@ -83,12 +98,13 @@ void computeCentroids(const DataSet&    db,
 /// \brief computeClusterBondary Computes the bondary of a given cluster.
 /// \param cs   ClusterSet the the cluster dta
 /// \param cid  a given cluster id
-/// \param curve  the returned curve, that constitue the bondary.
+/// \param curve  the returned curve, that constitue the bondary (views on
+///               the data set points).
 /// \param curveFileName the name of a file to dump the curve. If given.
 ///
 void computeClusterBondary(const ClusterSet&    cs,
                            const ClusterId      cid,
-                           std::vector<Point*>& curve,
+                           std::vector<Point>&  curve,
                            const std::string    curveFileName,
                            const bool           bVerbose);
 
@@ -133,23 +149,72 @@ double computeSilhouette(const ClusterSet& cs,
 double computeAverageSilouette(const ClusterSet& cs,
                                const ClusterId cid);
 
+///
+/// \brief computeCentroidSilhouette The simplified silhouette of a cluster
+///                                  set, in [-1, 1]: for each point, a is the
+///                                  distance to its centroid, b the distance
+///                                  to the closest other centroid, and
+///                                  s = (b - a) / max(a, b). O(n.k), instead of
+///                                  O(n^2) for the silhouette.
+/// \return the (weighted) mean of s over the points (0 for less than 2
+///         clusters)
+///
+double computeCentroidSilhouette(const ClusterSet& cs);
+
 ///
 /// \brief computeEnergy Computes the total energy of a cluster of points
 /// \param ds Data Set containing all the pointsr
 /// \param clusterSet the set of point index (in the dataset), respresenting a cluster
 /// \param centroid The cluster centroid
-/// \return The total SSE energy of this cluster
+/// \return The total SSE energy of this cluster (sum of the square distances
+///         of the points to the centroid, times their weight)
 ///
 double computeEnergy(const DataSet&    ds,
                      const PointIdSet& clusterSet,
                      const Point&      centroid);
 
 ///
-/// \brief computeKMeans
-/// \param c
+/// \brief computeInertia The inertia of a cluster set: the sum of the
+///                       energies of its clusters.
+///
+double computeInertia(const ClusterSet& cs);
+
+///
+/// \brief KMeansTolerance The K-Means stops before maxIter, when an
+///                        iteration meets one of these rules (0: not used).
+///                        It always stops when no point moves.
 ///
-void computeKMeans(ClusterSet& c, const size_t nbIter, const bool printIter);
+struct KMeansTolerance
+{
+    KMeansTolerance( )
+        :   m_centroidShift(0)
+        ,   m_inertiaChange(0)
+        ,   m_movedFraction(0)
+    { }
 
+    double      m_centroidShift;    // the largest centroid move
+    double      m_inertiaChange;    // the inertia decrease, relative
+    double      m_movedFraction;    // the moved points, fraction of all
+};
+
+///
+/// \brief computeKMeans
+/// \param c
+/// \param method the assignment step: Lloyd, or the bounds of an
+///               accelerated method (same assignments, fewer distances)
+/// \param init   the initial partition of the points
+/// \param tol    the stop rules, before nbIter
+/// \param printSynopsis prints the clusters, before and after
+/// \return the inertia of the clusters, negative if the initial partition
+///         fails (fewer points than clusters)
+///
+double computeKMeans(ClusterSet&            c, 
+                     const size_t           nbIter, 
+                     const bool             printIter,
+                     const KMeansMethod     method = KMeansLloyd,
+                     const InitMethod       init   = RandomPartition,
+                     const KMeansTolerance& tol    = KMeansTolerance(),
+                     const bool             printSynopsis = true);
 
 void printClusterSynopsis(const ClusterSet& cs);
 
@@ -6,14 +6,20 @@
 #include <boost/foreach.hpp>
 #include <boost/tokenizer.hpp>
 #include <cmath>
+#include <algorithm>
+#include <limits>
 
 #include "Util.h"
 #include "Point.h"
 #include "Util.h"
 #include "ClusterFunctions.h"
 #include "Random.h"
+#include "KMeansInit.h"
 #include "ClusterSet.h"
 
+// k-means||: number of oversampling rounds
+static const size_t KMeansParallelRounds = 5;
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // Dump a Set of points
@@ -98,6 +104,16 @@ ClusterSet::ClusterSet(const ClusterSet&   c,
 
 ////////////////////////////////////////////////////////////////////////////////
 
+ClusterSet::~ClusterSet( )
+{
+    for(size_t i=0; i<m_centroidVector.size(); i++)
+    {
+        delete m_centroidVector[i];
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 bool ClusterSet::init(PointIdVector* pointIdVector)
 {
     bool bOk = true;
@@ -127,7 +143,7 @@ bool ClusterSet::init(PointIdVector* pointIdVector)
             m_pointIdVector.resize(0);
             for(size_t i=0; i<iNbPoint; i++)
             {
-                m_pointIdVector.push_back(m_ds[i].getId());
+                m_pointIdVector.push_back(PointId(i));
             }
         }
         //take the dimension as the size of the 1st point
@@ -142,6 +158,8 @@ bool ClusterSet::init(PointIdVector* pointIdVector)
             PointIdSet set_of_points;
             m_clustersToPoints.push_back(set_of_points);
          }
+        m_clusterSums.assign(nbCluster() * dim, 0.0);
+        m_clusterWeights.assign(nbCluster(), 0.0);
     }
     return bOk;
 }
@@ -198,7 +216,10 @@ void ClusterSet::addPointToCluster(const Point&     pt,
                                    const ClusterId  cid)
 {
     m_pointsToCluster[pt.getId().value()] = cid;
-    m_clustersToPoints[cid].insert(pt.getId().value());
+    if(m_clustersToPoints[cid].insert(pt.getId().value()).second)
+    {
+        accumulatePoint(pt.getId(), cid, 1.0);
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -213,7 +234,10 @@ void ClusterSet::addPointToCluster(const PointIdSet& pidset,
     for(PointIdSet::iterator it=pidset.begin(); it!=pidset.end(); it++)
     {
         m_pointsToCluster[it->value()] = cid;
-        m_clustersToPoints[cid].insert(it->value());
+        if(m_clustersToPoints[cid].insert(it->value()).second)
+        {
+            accumulatePoint(*it, cid, 1.0);
+        }
     }
 }
 
@@ -222,7 +246,38 @@ void ClusterSet::addPointToCluster(const PointIdSet& pidset,
 void ClusterSet::removePointFromCluster(const Point& pt)
 {
     ClusterId cid = clusterContainingPoint(pt.getId());
-    m_clustersToPoints[cid].erase(pt.getId());
+    if(m_clustersToPoints[cid].erase(pt.getId()) == 0)
+    {
+        return;
+    }
+    if(m_clustersToPoints[cid].empty())
+    {
+        // no rounding residue in the sums of an empty cluster
+        const size_t dim = m_ds.dim();
+        std::fill(m_clusterSums.begin() + cid * dim, m_clusterSums.begin() + (cid + 1) * dim, 0.0);
+        m_clusterWeights[cid] = 0.0;
+    }
+    else
+    {
+        accumulatePoint(pt.getId(), cid, -1.0);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ClusterSet::accumulatePoint(const PointId&  pid,
+                                 const ClusterId cid,
+                                 const double    sign)
+{
+    const size_t dim = m_ds.dim();
+    const Coord* p   = m_ds.coords(pid.value());
+    const double w   = sign * m_ds.weight(pid.value());
+    CoordSum*    sum = &m_clusterSums[cid * dim];
+    for(size_t d=0; d<dim; d++)
+    {
+        sum[d] += w * p[d];
+    }
+    m_clusterWeights[cid] += w;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -254,15 +309,33 @@ size_t ClusterSet::clusterSize(const ClusterId cid)const
     return m_clustersToPoints[cid].size();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// sum of the weights of the points in a given cluster.
+double ClusterSet::clusterWeight(const ClusterId cid)const
+{
+    return m_ds.weights() ? m_clusterWeights[cid] : (double)clusterSize(cid);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //
-// Compute Centroids FOR EACH CLUSTER
+// Compute Centroids FOR EACH CLUSTER, from the sums kept by the point moves
 void ClusterSet::compute_centroids( )
 {
-    // For ech centroid
+    const size_t dim = m_ds.dim();
     for(ClusterId cid=0; cid<nbCluster(); cid++)
     {
-        computeCentroids(m_ds, pointsInCluster(cid), getCentroid(cid));
+        const CoordSum* sum = &m_clusterSums[cid * dim];
+        Coord*          c   = getCentroid(cid).data();
+        if(clusterSize(cid) == 0)
+        {
+            std::fill(c, c + dim, std::numeric_limits<Coord>::quiet_NaN());
+            continue;
+        }
+        const double nb = clusterWeight(cid);
+        for(size_t d=0; d<dim; d++)
+        {
+            c[d] = sum[d] / nb;
+        }
     }
 }
     
@@ -270,18 +343,12 @@ void ClusterSet::compute_centroids( )
 
 Point ClusterSet::getClusterCenter(const ClusterId cid)const
 {
-    Point center(0, m_ds[0].dim());
+    Point center(0, m_ds.dim());
 
     const PointIdSet& pointIdSet = pointsInCluster(cid);
     if(pointIdSet.size() != 0)
     {
-        // For earch PointId in this set
-        BOOST_FOREACH(const PointIdSet::value_type& pid, pointIdSet)
-        {
-            const Point& p = point(pid);
-            center += p;
-        }
-        center /= (double)clusterSize(cid);
+        computeCentroids(m_ds, pointIdSet, center);
     }
     return center;
 }
@@ -308,7 +375,7 @@ Random Partition:
     * Preferable for algorithms such as the k-harmonic means and fuzzy k-means.
 */
 
-void ClusterSet::initial_partition_points(InitMethod method)
+bool ClusterSet::initial_partition_points(InitMethod method)
 {
     if(method == RandomPartition)
     {
@@ -323,10 +390,83 @@ void ClusterSet::initial_partition_points(InitMethod method)
             // fprintf(stdout, "[%ld] point %s to cluster %d\n", idx, point(idx).toString().c_str(), cid);
         }
     }
+    else if(method == KMeansPlusPlus || method == KMeansParallel)
+    {
+        const size_t nb  = nbPoints( );
+        const size_t dim = m_ds.dim( );
+        fprintf(stdout, "initialPartition: %s: nbCluster: %ld, nbPts: %ld\n", 
+                (method == KMeansPlusPlus) ? "k-means++" : "k-means||", m_nb_cluster, nb);
+        if(nb < m_nb_cluster)
+        {
+            fprintf(stdout, "Error: cannot seed %ld clusters with %ld points\n", m_nb_cluster, nb);
+            return false;
+        }
+
+        std::vector<const Coord*> points(nb);
+        std::vector<double>       weights(m_ds.weights() ? nb : 0);
+        for(size_t idx=0; idx<nb; idx++)
+        {
+            points[idx] = m_ds.coords(m_pointIdVector[idx].value());
+            if(m_ds.weights()) weights[idx] = m_ds.weight(m_pointIdVector[idx].value());
+        }
+
+        // the centroids are points far from each other
+        std::vector<size_t> seeds;
+        const double* w = weights.empty() ? 0 : &weights[0];
+        if(method == KMeansPlusPlus)
+        {
+            kmeansPlusPlusSeeds(points, dim, m_nb_cluster, seeds, w);
+        }
+        else
+        {
+            kmeansParallelSeeds(points, dim, m_nb_cluster, KMeansParallelRounds, seeds, w);
+        }
+        for(ClusterId cid=0; cid<m_nb_cluster; cid++)
+        {
+            getCentroid(cid) = point(seeds[cid]);
+        }
+
+        // each point goes to its closest centroid
+        std::vector<size_t> closest;
+        assignToClosestSeed(points, dim, seeds, closest);
+        for(size_t idx=0; idx<nb; idx++)
+        {
+            addPointToCluster(point(idx), closest[idx]);
+        }
+    }
+    else if(method == CurrentCentroids)
+    {
+        // each point goes to the closest of the given centroids
+        const size_t nb  = nbPoints( );
+        const size_t dim = m_ds.dim( );
+
+        std::vector<const Coord*> points(nb);
+        for(size_t idx=0; idx<nb; idx++)
+        {
+            points[idx] = m_ds.coords(m_pointIdVector[idx].value());
+        }
+        std::vector<Coord> centroids(m_nb_cluster * dim);
+        for(ClusterId cid=0; cid<m_nb_cluster; cid++)
+        {
+            const Coord* c = getCentroid(cid).data();
+            std::copy(c, c + dim, &centroids[cid * dim]);
+        }
+        std::vector<size_t> closest;
+        assignToClosestCentroid(points, dim, centroids, closest);
+        for(size_t idx=0; idx<nb; idx++)
+        {
+            addPointToCluster(point(idx), closest[idx]);
+        }
+    }
     else
     {
         // select the centroid, by randomly piking on the data set population
         const size_t nb = nbPoints( );
+        if(nb < nbCluster())
+        {
+            fprintf(stdout, "Error: cannot seed %ld clusters with %ld points\n", nbCluster(), nb);
+            return false;
+        }
         std::set<size_t> points;
         
         for(ClusterId cid=0; cid<nbCluster(); cid++)
@@ -364,6 +504,7 @@ void ClusterSet::initial_partition_points(InitMethod method)
             addPointToCluster(p, closestCentroid);
         }
     }
+    return true;
 }
 
     
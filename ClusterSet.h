@@ -22,6 +22,9 @@ enum InitMethod
 {
         ForgyMethod
     ,   RandomPartition
+    ,   KMeansPlusPlus      // D^2 sampling of the centroids
+    ,   KMeansParallel      // k-means||: oversampled D^2 rounds, in parallel
+    ,   CurrentCentroids    // the centroids already set (finite): warm start
 };
     
 // vector lf centroids centroids
@@ -53,6 +56,8 @@ class ClusterSet
                                   size_t              nbCluster,
                                   PointIdVector*      pointIdVector=0)         ;
 
+                ~ClusterSet       ( )                                          ;
+
     ////////////////////////////////////////////////////////////////////////////
     // Access functions
     
@@ -61,6 +66,7 @@ class ClusterSet
    
     /// \brief addPointToCluster Adds a pointId to a given cluster. the Point
     ///                          will not be removed from its original cluster.
+    ///                          The coordinate sums of the cluster are updated.
     /// \param point   Point object to be removed
     /// \param cluster  ClusterId of the cluster to be inserted.
     void                       addPointToCluster      (const Point&    pt,
@@ -72,7 +78,8 @@ class ClusterSet
     
     /// \brief removePointFromCluster remove a given point of its own cluster.
     ///                               it is assumed that the point is located in
-    ///                               a single cluster.
+    ///                               a single cluster. The coordinate sums of
+    ///                               the cluster are updated.
     /// \param pt Point to be removed.
     void                       removePointFromCluster  (const Point& pt)   ;
 
@@ -103,6 +110,9 @@ class ClusterSet
     /// \return size_t
     size_t                     clusterSize            (const ClusterId cid)const ;
     
+    // the sum of the weights of the points of a cluster (see DataSet::weights)
+    double                     clusterWeight          (const ClusterId cid)const ;
+    
     /// \brief nbPoints otal number of points in the current data base
     /// \return size
     ///
@@ -126,12 +136,12 @@ class ClusterSet
     ///               if the list of points on the sub-data set is smaller
     ///               than the total number of points
     ///                point(i).getId() != ds.point(i).getId()
-    /// \return Point object
+    /// \return Point object (a view on the data set)
     ///
-    const Point&               point              (const size_t idx)       const
+    Point                      point              (const size_t idx)       const
     { return m_ds[m_pointIdVector[idx].value()]; }
 
-    const Point&               point                  (const PointId& pid) const
+    Point                      point                  (const PointId& pid) const
     { return m_ds[pid.value()]; }
 
     // the centroid point associated to point 'pt'
@@ -160,11 +170,13 @@ class ClusterSet
     // initialize all centroids to a zero position
     void                zero_centroids              ( )                       ;
     
-    // Zero centroids
+    // the centroids, from the (weighted) coordinate sums of the clusters:
+    // O(k.dim) (the centroid of an empty cluster is not a number)
     void                compute_centroids           ( )                       ;
     
-    // Initial partition points among available clusters
-    void                initial_partition_points    (InitMethod method)        ;
+    // Initial partition points among available clusters: false if the
+    // points cannot seed the clusters (fewer points than clusters)
+    bool                initial_partition_points    (InitMethod method)        ;
     
 ///////////////////////////////////////////////////////////////////////////////
     private:
@@ -172,6 +184,16 @@ class ClusterSet
 
     bool                init                   (PointIdVector* pointIdVector) ;
 
+    // not copyable (the centroids are owned)
+                        ClusterSet             (const ClusterSet&)            ;
+    ClusterSet&         operator=              (const ClusterSet&)            ;
+
+    // adds (sign 1) or removes (sign -1) a point to the sums of a cluster,
+    // with its weight
+    void                accumulatePoint        (const PointId&  pid,
+                                                const ClusterId cid,
+                                                const double    sign)         ;
+
     // the point space - store are a reference
     const DataSet&              m_ds                                          ;
 
@@ -188,6 +210,11 @@ class ClusterSet
     PointsToClusters            m_pointsToCluster                             ;
 
     CentroidVector              m_centroidVector                              ;
+
+    // the weighted coordinate sums of each cluster (nbCluster x dim), and
+    // the weight of each cluster, kept up to date on each point move
+    std::vector<CoordSum>       m_clusterSums                                 ;
+    std::vector<double>         m_clusterWeights                              ;
 };
 
 void initRandomPoints(DataSet& dataSet, const size_t iNbPoints);
@@ -0,0 +1,241 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+
+#include "Distance.h"
+#include "KMeansInit.h"
+#include "Parallel.h"
+#include "Random.h"
+#include "Coreset.h"
+
+// k-means||: number of rounds of the initial solution
+static const size_t CoresetSeedRounds = 5;
+
+////////////////////////////////////////////////////////////////////////////////
+// a uniform value in [0, 1), with 53 random bits
+static double uniformValue( )
+{
+    const uint64_t r = ((uint64_t)randomInteger() << 31) ^ (uint64_t)randomInteger();
+    return (r >> 9) * (1.0 / 9007199254740992.0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// The square distance of each point to its seed, and the (weighted) cost and
+// weight of the seed clusters, by chunks.
+//
+class SeedClusterCostTask : public ParallelTask
+{
+public:
+    SeedClusterCostTask(const DataSet&             ds,
+                        const std::vector<Coord>&  seeds,
+                        const std::vector<size_t>& closest)
+        :   m_ds(ds)
+        ,   m_seeds(seeds)
+        ,   m_closest(closest)
+        ,   m_nbSeed(seeds.size() / ds.dim())
+        ,   m_nbChunks(getNbThreads())
+        ,   m_dist(ds.size())
+        ,   m_chunkCost(m_nbChunks * m_nbSeed, 0.0)
+        ,   m_chunkWeight(m_nbChunks * m_nbSeed, 0.0)
+    {
+    }
+
+    virtual void run(const size_t chunkIdx)
+    {
+        size_t begin = 0;
+        size_t end   = 0;
+        chunkRange(m_ds.size(), m_nbChunks, chunkIdx, begin, end);
+
+        const size_t dim    = m_ds.dim();
+        double*      cost   = &m_chunkCost  [chunkIdx * m_nbSeed];
+        double*      weight = &m_chunkWeight[chunkIdx * m_nbSeed];
+        for(size_t i=begin; i<end; i++)
+        {
+            const size_t s = m_closest[i];
+            const double w = m_ds.weight(i);
+            m_dist[i]  = coordSquareDistance(m_ds.coords(i), &m_seeds[s * dim], dim);
+            cost[s]   += w * m_dist[i];
+            weight[s] += w;
+        }
+    }
+
+    // the cost and the weight of each seed cluster
+    void reduce(std::vector<double>& cost, std::vector<double>& weight)const
+    {
+        cost.assign(m_nbSeed, 0.0);
+        weight.assign(m_nbSeed, 0.0);
+        for(size_t c=0; c<m_nbChunks; c++)
+        {
+            for(size_t s=0; s<m_nbSeed; s++)
+            {
+                cost[s]   += m_chunkCost  [c * m_nbSeed + s];
+                weight[s] += m_chunkWeight[c * m_nbSeed + s];
+            }
+        }
+    }
+
+    const DataSet&                      m_ds;
+    const std::vector<Coord>&           m_seeds;
+    const std::vector<size_t>&          m_closest;
+    const size_t                        m_nbSeed;
+    const size_t                        m_nbChunks;
+    std::vector<double>                 m_dist;
+    std::vector<double>                 m_chunkCost;
+    std::vector<double>                 m_chunkWeight;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// The sensitivity bound of each point (in place of its square distance), by
+// chunks:
+//      s = w x (alpha d^2 / c + 2 alpha cost_b / (W_b c) + 4 W / W_b)
+// with c the mean cost of the points, and b the seed cluster of the point.
+//
+class SensitivityTask : public ParallelTask
+{
+public:
+    SensitivityTask(SeedClusterCostTask&       costs,
+                    const std::vector<double>& clusterCost,
+                    const std::vector<double>& clusterWeight,
+                    const double               alpha,
+                    const double               meanCost,
+                    const double               totalWeight)
+        :   m_costs(costs)
+        ,   m_clusterCost(clusterCost)
+        ,   m_clusterWeight(clusterWeight)
+        ,   m_alpha(alpha)
+        ,   m_meanCost(meanCost)
+        ,   m_totalWeight(totalWeight)
+    {
+    }
+
+    virtual void run(const size_t chunkIdx)
+    {
+        size_t begin = 0;
+        size_t end   = 0;
+        chunkRange(m_costs.m_ds.size(), m_costs.m_nbChunks, chunkIdx, begin, end);
+
+        for(size_t i=begin; i<end; i++)
+        {
+            const size_t b = m_costs.m_closest[i];
+            double       s = 4.0 * m_totalWeight / m_clusterWeight[b];
+            if(m_meanCost > 0)
+            {
+                s += m_alpha * m_costs.m_dist[i] / m_meanCost
+                   + 2.0 * m_alpha * m_clusterCost[b] / (m_clusterWeight[b] * m_meanCost);
+            }
+            m_costs.m_dist[i] = m_costs.m_ds.weight(i) * s;
+        }
+    }
+
+    SeedClusterCostTask&                m_costs;
+    const std::vector<double>&          m_clusterCost;
+    const std::vector<double>&          m_clusterWeight;
+    const double                        m_alpha;
+    const double                        m_meanCost;
+    const double                        m_totalWeight;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t buildCoreset(const DataSet&          ds,
+                    const size_t            nbCluster,
+                    const size_t            coresetSize,
+                    DataSet&                coreset,
+                    std::vector<size_t>*    origins)
+{
+    const size_t nb  = ds.size();
+    const size_t dim = ds.dim();
+    if(origins) origins->resize(0);
+    if(coreset.size() != 0)
+    {
+        fprintf(stdout, "Error: coreset built in a non empty data set\n");
+        return 0;
+    }
+    if(nb == 0 || nbCluster == 0 || coresetSize == 0)
+    {
+        return 0;
+    }
+
+    // the cheap solution, and the seed of each point
+    std::vector<const Coord*> points(nb);
+    for(size_t i=0; i<nb; i++)
+    {
+        points[i] = ds.coords(i);
+    }
+    std::vector<size_t> seedIdx;
+    kmeansParallelSeeds(points, dim, std::min(nbCluster, nb), CoresetSeedRounds, seedIdx, ds.weights());
+
+    std::vector<Coord> seeds(seedIdx.size() * dim);
+    for(size_t s=0; s<seedIdx.size(); s++)
+    {
+        std::copy(points[seedIdx[s]], points[seedIdx[s]] + dim, &seeds[s * dim]);
+    }
+    std::vector<size_t> closest;
+    assignToClosestCentroid(points, dim, seeds, closest);
+
+    // the cost of the solution, by seed cluster
+    SeedClusterCostTask costs(ds, seeds, closest);
+    parallelFor(costs, costs.m_nbChunks);
+
+    std::vector<double> clusterCost;
+    std::vector<double> clusterWeight;
+    costs.reduce(clusterCost, clusterWeight);
+
+    double totalCost   = 0.0;
+    double totalWeight = 0.0;
+    for(size_t s=0; s<clusterCost.size(); s++)
+    {
+        totalCost   += clusterCost[s];
+        totalWeight += clusterWeight[s];
+    }
+
+    // the sensitivity of each point (the seeding is an O(log k) approximation)
+    const double alpha = 16.0 * (log((double)nbCluster) / log(2.0) + 2.0);
+    SensitivityTask sensitivity(costs, clusterCost, clusterWeight, alpha,
+                                totalCost / totalWeight, totalWeight);
+    parallelFor(sensitivity, costs.m_nbChunks);
+
+    const std::vector<double>& s = costs.m_dist;
+    double total = 0.0;
+    for(size_t i=0; i<nb; i++)
+    {
+        total += s[i];
+    }
+
+    // the samples, in the order of the points: sorted uniform values on the
+    // cumulated sensitivities
+    std::vector<double> samples(coresetSize);
+    for(size_t k=0; k<coresetSize; k++)
+    {
+        samples[k] = uniformValue() * total;
+    }
+    std::sort(samples.begin(), samples.end());
+
+    std::vector<double> weights;
+    coreset.reserve(coresetSize, dim);
+    double cumul = 0.0;
+    size_t k     = 0;
+    for(size_t i=0; i<nb && k<coresetSize; i++)
+    {
+        cumul += s[i];
+        size_t count = 0;
+        while(k < coresetSize && (samples[k] < cumul || i+1 == nb))
+        {
+            count++;
+            k++;
+        }
+        if(count == 0) continue;
+
+        // w / (coresetSize x probability), for each sample of the point
+        coreset.addPoint(Point::CoordVector(ds.coords(i), ds.coords(i) + dim));
+        weights.push_back(count * ds.weight(i) * total / (coresetSize * s[i]));
+        if(origins) origins->push_back(i);
+    }
+    coreset.setWeights(weights);
+    return coreset.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,33 @@
+#ifndef _Coreset_h_
+#define _Coreset_h_
+
+#include "DataSet.h"
+
+///
+/// \brief buildCoreset Sensitivity sampling of a k-means coreset: a small
+///                     weighted data set whose k-means cost approximates the
+///                     one of the data set, for any k centroids.
+///                     A cheap solution (k-means|| seeds, see KMeansInit)
+///                     bounds the sensitivity of each point: its share of
+///                     the cost, plus the mean cost and the inverse weight
+///                     of its seed cluster. coresetSize points are sampled
+///                     with a probability proportional to the sensitivity,
+///                     each weighted by w / (coresetSize x probability), so
+///                     that the cost of the coreset is an unbiased estimate.
+///                     The data set weights are taken into account.
+///                     The random values come from randomInteger().
+/// \param ds           the data set
+/// \param nbCluster    k
+/// \param coresetSize  number of samples (the same point may be sampled
+///                     more than once: its samples are merged)
+/// \param coreset      an empty data set: the weighted coreset points
+/// \param origins      if not 0, the index in ds of each coreset point
+/// \return the number of coreset points
+///
+size_t buildCoreset(const DataSet&          ds,
+                    const size_t            nbCluster,
+                    const size_t            coresetSize,
+                    DataSet&                coreset,
+                    std::vector<size_t>*    origins = 0);
+
+#endif
@@ -1,19 +1,280 @@
-#include <boost/foreach.hpp>
-#include <boost/tokenizer.hpp>
-
-#include <fstream>
+#include <algorithm>
+#include <limits>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Distance.h"
+#include "Parallel.h"
+#include "DataSetFile.h"
+#include "KdTree.h"
 #include "DataSet.h"
 
 
+////////////////////////////////////////////////////////////////////////////////
+// maps a whole file in memory (read only). An empty file is not mapped.
+static bool mapFile(const std::string fname, void*& addr, size_t& size)
+{
+    addr = 0;
+    size = 0;
+    const int fd = open(fname.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        fprintf(stdout, "Error: cannot open file '%s'\n", fname.c_str());
+        return false;
+    }
+    bool bOk = true;
+    struct stat st;
+    if(fstat(fd, &st) != 0)
+    {
+        bOk = false;
+    }
+    else if(st.st_size > 0)
+    {
+        size = st.st_size;
+        addr = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(addr == MAP_FAILED)
+        {
+            addr = 0;
+            bOk  = false;
+        }
+    }
+    close(fd);
+    if(!bOk)
+    {
+        fprintf(stdout, "Error: cannot map file '%s'\n", fname.c_str());
+    }
+    return bOk;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// CSV parsing
+//
+// The file is mapped, and split in chunks aligned on the lines. A first pass
+// counts the rows of each chunk, which gives the position of its points in
+// the coordinate block. The second pass parses the chunks, directly into the
+// block. Both passes run in parallel.
+
+// minimum size of a chunk of the csv file
+static const size_t CsvMinChunkSize = 1 << 20;
+
+// maximum number of malformed rows reported
+static const size_t CsvMaxReportedErrors = 10;
+
+// the separator characters
+class CsvSeparator
+{
+public:
+    CsvSeparator(const char* separator)
+    {
+        memset(m_isSeparator, 0, sizeof(m_isSeparator));
+        for(const char* c=separator; *c; c++)
+        {
+            m_isSeparator[(unsigned char)*c] = true;
+        }
+    }
+    bool isSeparator(const char c)const
+    { return m_isSeparator[(unsigned char)c]; }
+
+    static bool isSpace(const char c)
+    { return c == ' ' || c == '\t' || c == '\r'; }
+
+private:
+    bool m_isSeparator[256];
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// the next token of the line: [begin, end) without the surrounding blanks.
+// Returns false if there are no more tokens.
+static bool nextToken(const CsvSeparator& sep,
+                      const char*&        pos,
+                      const char*         lineEnd,
+                      const char*&        begin,
+                      const char*&        end)
+{
+    for(;;)
+    {
+        while(pos < lineEnd && (sep.isSeparator(*pos) || CsvSeparator::isSpace(*pos))) pos++;
+        if(pos == lineEnd) return false;
+
+        begin = pos;
+        while(pos < lineEnd && !sep.isSeparator(*pos)) pos++;
+        end = pos;
+        while(end > begin && CsvSeparator::isSpace(end[-1])) end--;
+        if(end > begin) return true;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// true if c may continue a number for strtod (digits, exponent, hexadecimal,
+// inf, nan(...))
+static bool isNumberChar(const char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           c == '.' || c == '+' || c == '-' || c == '(' || c == ')';
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// converts the token [begin, end) of the text ending at textEnd to a value,
+// without its quotes if any. The whole token must be used.
+static bool parseValue(const char* begin, const char* end, const char* textEnd, Coord& value)
+{
+    if(end - begin >= 2 && *begin == '"' && end[-1] == '"')
+    {
+        begin++;
+        end--;
+    }
+    if(end == begin) return false;
+
+    // strtod needs a terminated string: the token is parsed in place if the
+    // character after it stops strtod, otherwise from a copy (end of file)
+    char* last = 0;
+    if(end < textEnd && !isNumberChar(*end))
+    {
+        value = strtod(begin, &last);
+        return last == end;
+    }
+    const std::string token(begin, end);
+    value = strtod(token.c_str(), &last);
+    return last == token.c_str() + token.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// the end of the line starting at 'pos' (position of the '\n', or 'end')
+static const char* lineEnd(const char* pos, const char* end)
+{
+    const char* nl = (const char*)memchr(pos, '\n', end - pos);
+    return nl ? nl : end;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// a chunk of the file, and the result of its parsing
+struct CsvChunk
+{
+    CsvChunk( )
+        :   m_begin(0), m_end(0), m_nbLines(0), m_nbRows(0)
+        ,   m_firstLine(0), m_firstRow(0), m_nbPoints(0)
+    { }
+    const char*         m_begin;
+    const char*         m_end;
+    size_t              m_nbLines;      // lines in the chunk
+    size_t              m_nbRows;       // non empty lines in the chunk
+    size_t              m_firstLine;    // line number of the first line
+    size_t              m_firstRow;     // block position of the first row
+    size_t              m_nbPoints;     // rows parsed successfully
+    std::vector<size_t> m_badLines;     // line number of the malformed rows
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// first pass: count the lines and rows of each chunk
+class CsvCountTask : public ParallelTask
+{
+public:
+    CsvCountTask(std::vector<CsvChunk>& chunks, const CsvSeparator& sep)
+        :   m_chunks(chunks), m_sep(sep)
+    { }
+
+    virtual void run(const size_t chunkIdx)
+    {
+        CsvChunk& chunk = m_chunks[chunkIdx];
+        const char* begin = 0;
+        const char* end   = 0;
+        for(const char* pos=chunk.m_begin; pos<chunk.m_end; )
+        {
+            const char* eol = lineEnd(pos, chunk.m_end);
+            chunk.m_nbLines++;
+            if(nextToken(m_sep, pos, eol, begin, end))
+            {
+                chunk.m_nbRows++;
+            }
+            pos = eol + 1;
+        }
+    }
+    std::vector<CsvChunk>&  m_chunks;
+    const CsvSeparator&     m_sep;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// second pass: parse the rows of each chunk, in the coordinate block
+class CsvParseTask : public ParallelTask
+{
+public:
+    CsvParseTask(std::vector<CsvChunk>& chunks, 
+                 const CsvSeparator&    sep, 
+                 const char*            textEnd,
+                 Coord*                 block,
+                 const size_t           dim)
+        :   m_chunks(chunks), m_sep(sep), m_textEnd(textEnd), m_block(block), m_dim(dim)
+    { }
+
+    virtual void run(const size_t chunkIdx)
+    {
+        CsvChunk& chunk = m_chunks[chunkIdx];
+        Coord*    row   = m_block + chunk.m_firstRow * m_dim;
+        size_t    line  = chunk.m_firstLine;
+
+        const char* begin = 0;
+        const char* end   = 0;
+        for(const char* pos=chunk.m_begin; pos<chunk.m_end; line++)
+        {
+            const char* eol = lineEnd(pos, chunk.m_end);
+            size_t nbValues = 0;
+            bool   bOk      = true;
+            while(bOk && nextToken(m_sep, pos, eol, begin, end))
+            {
+                bOk = (nbValues < m_dim) && parseValue(begin, end, m_textEnd, row[nbValues]);
+                nbValues++;
+            }
+            if(nbValues > 0)
+            {
+                if(bOk && nbValues == m_dim)
+                {
+                    row += m_dim;
+                    chunk.m_nbPoints++;
+                }
+                else
+                {
+                    chunk.m_badLines.push_back(line);
+                }
+            }
+            pos = eol + 1;
+        }
+    }
+    std::vector<CsvChunk>&  m_chunks;
+    const CsvSeparator&     m_sep;
+    const char*             m_textEnd;
+    Coord*                  m_block;
+    const size_t            m_dim;
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 
 DataSet::DataSet( )
+    :   m_nb_dimension(0)
+    ,   m_nb_points(0)
+    ,   m_capacity(0)
+    ,   m_coordBlock(0)
+    ,   m_mappedAddr(0)
+    ,   m_mappedSize(0)
+    ,   m_kdTree(0)
 {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 DataSet::DataSet(const std::vector<Point*>& v)
+    :   m_nb_dimension(0)
+    ,   m_nb_points(0)
+    ,   m_capacity(0)
+    ,   m_coordBlock(0)
+    ,   m_mappedAddr(0)
+    ,   m_mappedSize(0)
+    ,   m_kdTree(0)
 {
     addPointList(v);
 }
@@ -22,54 +283,149 @@ DataSet::DataSet(const std::vector<Point*>& v)
 
 DataSet::~DataSet( )
 {
-    for(size_t i=0; i< m_pointVector.size(); i++)
+    releaseKdTree( );
+    releaseBlock( );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void DataSet::releaseBlock( )
+{
+    if(m_mappedAddr)
+    {
+        munmap(m_mappedAddr, m_mappedSize);
+        m_mappedAddr = 0;
+        m_mappedSize = 0;
+    }
+    else
     {
-        delete  m_pointVector[i];
+        free(m_coordBlock);
     }
+    m_coordBlock = 0;
+    m_capacity   = 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-size_t DataSet::size( )const
+void DataSet::releaseKdTree( )
 {
-    return  m_pointVector.size();
+    delete m_kdTree;
+    m_kdTree = 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-size_t DataSet::dim( )const
+void DataSet::computeKdTree( )
 {
-    return (size()>0 ? operator[](0).dim() : 0);
+    releaseKdTree( );
+
+    std::vector<const Coord*> points(m_nb_points);
+    for(size_t i=0; i<m_nb_points; i++)
+    {
+        points[i] = coords(i);
+    }
+    m_kdTree = new KdTree(points, m_nb_dimension, weights());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-const Point& DataSet::operator[](const size_t i)const
+void DataSet::reserve(const size_t nbPoints, const size_t dim)
 {
-    return *m_pointVector[i];
+    if(m_nb_points == 0 && dim != m_nb_dimension)
+    {
+        releaseBlock( );
+        m_nb_dimension = dim;
+    }
+    if(nbPoints > m_capacity)
+    {
+        grow(nbPoints);
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-const Point& DataSet::operator[](const PointId& id)const
+void DataSet::grow(const size_t nbPoints)
 {
-    return *m_pointVector[id.value()];
+    size_t capacity = std::max(m_capacity, (size_t)1024);
+    while(capacity < nbPoints)
+    {
+        capacity *= 2;
+    }
+    const size_t nbBytes = std::max(capacity * m_nb_dimension * sizeof(Coord),
+                                    CoordBlockAlignment);
+    void* block = 0;
+    if(posix_memalign(&block, CoordBlockAlignment, nbBytes) != 0)
+    {
+        fprintf(stdout, "Error: cannot allocate %ld points of dim %ld\n",
+                capacity, m_nb_dimension);
+        throw std::bad_alloc();
+    }
+    if(m_coordBlock)
+    {
+        memcpy(block, m_coordBlock, m_nb_points * m_nb_dimension * sizeof(Coord));
+        releaseBlock( );
+    }
+    m_coordBlock = (Coord*)block;
+    m_capacity   = capacity;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 void DataSet::addPoint(Point* point)
 {
-    m_pointVector.push_back(point);
+    append(point->data(), point->dim());
+    delete point;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool DataSet::addPoint(const Point::CoordVector& coords)
+{
+    return append(coords.empty() ? 0 : &coords[0], coords.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool DataSet::append(const Coord* coords, const size_t dim)
+{
+    if(m_nb_points == 0 && m_capacity == 0)
+    {
+        m_nb_dimension = dim;
+    }
+    if(dim != m_nb_dimension)
+    {
+        fprintf(stdout, "Error: point %ld has dim %ld (data set dim: %ld). Ignored.\n",
+                m_nb_points, dim, m_nb_dimension);
+        return false;
+    }
+    if(m_nb_points == m_capacity)
+    {
+        grow(m_nb_points + 1);
+    }
+    std::copy(coords, coords + dim, m_coordBlock + m_nb_points * m_nb_dimension);
+    m_nb_points++;
+    m_minCoord.clear();
+    m_maxCoord.clear();
+    m_squareNorms.clear();
+    releaseKdTree( );
+    if(!m_weights.empty())
+    {
+        m_weights.push_back(1.0);
+    }
+    return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 void DataSet::addPointList(const std::vector<Point*>& vector)
 {
+    if(!vector.empty())
+    {
+        reserve(m_nb_points + vector.size(), vector[0]->dim());
+    }
     for(size_t i=0; i<vector.size(); i++)
     {
-        m_pointVector.push_back(vector[i]);
+        addPoint(vector[i]);
     }
 }
 
@@ -96,31 +452,469 @@ void DataSet::write(const std::string fname)const
 
 bool DataSet::read(const std::string fname, const char* separator)
 {
-    std::fstream file;
-    file.open(fname.c_str(), std::ios::in);
-    if(file.is_open())
+    if(isBinaryFile(fname))
+    {
+        return readBinary(fname);
+    }
+    void*  addr = 0;
+    size_t size = 0;
+    if(!mapFile(fname, addr, size))
+    {
+        return false;
+    }
+    const char*        text    = (const char*)addr;
+    const char*        textEnd = text + size;
+    const CsvSeparator sep(separator);
+
+    // the dimension is the number of values on the first row
+    size_t      dim   = 0;
+    const char* begin = 0;
+    const char* end   = 0;
+    for(const char* pos=text; pos<textEnd && dim==0; )
+    {
+        const char* eol = lineEnd(pos, textEnd);
+        while(nextToken(sep, pos, eol, begin, end)) dim++;
+        pos = eol + 1;
+    }
+    if(dim == 0)
+    {
+        if(addr) munmap(addr, size);
+        return true;
+    }
+    if(m_nb_points != 0 && dim != m_nb_dimension)
+    {
+        fprintf(stdout, "Error: '%s' has dim %ld (data set dim: %ld)\n",
+                fname.c_str(), dim, m_nb_dimension);
+        munmap(addr, size);
+        return false;
+    }
+
+    // split the file in chunks, starting at the beginning of a line
+    const size_t nbChunks = std::max((size_t)1, 
+                                     std::min(size / CsvMinChunkSize, 8 * getNbThreads()));
+    std::vector<CsvChunk> chunks(nbChunks);
+    for(size_t i=0; i<nbChunks; i++)
+    {
+        size_t chunkBegin = 0;
+        size_t chunkEnd   = 0;
+        chunkRange(size, nbChunks, i, chunkBegin, chunkEnd);
+
+        chunks[i].m_begin = (i == 0) ? text : chunks[i-1].m_end;
+        chunks[i].m_end   = std::max(chunks[i].m_begin, text + chunkEnd);
+        if(chunks[i].m_end < textEnd && chunks[i].m_end > text && chunks[i].m_end[-1] != '\n')
+        {
+            chunks[i].m_end = std::min(lineEnd(chunks[i].m_end, textEnd) + 1, textEnd);
+        }
+    }
+
+    CsvCountTask countTask(chunks, sep);
+    parallelFor(countTask, nbChunks);
+
+    size_t nbRows = 0;
+    size_t nbLines = 1;
+    for(size_t i=0; i<nbChunks; i++)
     {
-        typedef boost::tokenizer< boost::char_separator<char> > Tokenizer;
-        boost::char_separator<char> sep(separator);
-        
-        std::string line;
-        PointId id;
-        while(std::getline(file, line))
+        chunks[i].m_firstRow  = nbRows;
+        chunks[i].m_firstLine = nbLines;
+        nbRows  += chunks[i].m_nbRows;
+        nbLines += chunks[i].m_nbLines;
+    }
+
+    reserve(m_nb_points + nbRows, dim);
+    Coord* block = m_coordBlock + m_nb_points * m_nb_dimension;
+
+    CsvParseTask parseTask(chunks, sep, textEnd, block, dim);
+    parallelFor(parseTask, nbChunks);
+
+    // close the gaps left by the malformed rows, and report them.
+    size_t nbPoints = 0;
+    size_t nbErrors = 0;
+    for(size_t i=0; i<nbChunks; i++)
+    {
+        const CsvChunk& chunk = chunks[i];
+        if(nbPoints != chunk.m_firstRow && chunk.m_nbPoints)
         {
-            Tokenizer info(line, sep);   // tokenize the line of data
-            std::vector<double> values;
-            
-            for(Tokenizer::iterator it = info.begin(); it != info.end(); ++it)
+            memmove(block + nbPoints * dim, 
+                    block + chunk.m_firstRow * dim, 
+                    chunk.m_nbPoints * dim * sizeof(Coord));
+        }
+        nbPoints += chunk.m_nbPoints;
+
+        for(size_t j=0; j<chunk.m_badLines.size(); j++, nbErrors++)
+        {
+            if(nbErrors < CsvMaxReportedErrors)
             {
-                // convert data into double value, and store
-                values.push_back(strtod(it->c_str(), 0));
+                fprintf(stdout, "Error: '%s' line %ld: malformed row\n", 
+                        fname.c_str(), chunk.m_badLines[j]);
             }
-            addPoint(new Point(id, values));
-            ++id;
         }
     }
+    if(nbErrors > 0)
+    {
+        fprintf(stdout, "Error: '%s': %ld malformed rows ignored\n", fname.c_str(), nbErrors);
+    }
+    m_nb_points += nbPoints;
+    m_minCoord.clear();
+    m_maxCoord.clear();
+    m_squareNorms.clear();
+    releaseKdTree( );
+    if(!m_weights.empty())
+    {
+        m_weights.resize(m_nb_points, 1.0);
+    }
+
+    munmap(addr, size);
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void DataSet::range(std::vector<Coord>& minCoord, std::vector<Coord>& maxCoord)const
+{
+    if(m_minCoord.size() == m_nb_dimension && m_nb_dimension > 0)
+    {
+        minCoord = m_minCoord;
+        maxCoord = m_maxCoord;
+        return;
+    }
+    minCoord.assign(m_nb_dimension, 0);
+    maxCoord.assign(m_nb_dimension, 0);
+    if(m_nb_points > 0)
+    {
+        minCoord.assign(coords(0), coords(0) + m_nb_dimension);
+        maxCoord.assign(coords(0), coords(0) + m_nb_dimension);
+    }
+    for(size_t i=1; i<m_nb_points; i++)
+    {
+        const Coord* c = coords(i);
+        for(size_t d=0; d<m_nb_dimension; d++)
+        {
+            minCoord[d] = std::min(minCoord[d], c[d]);
+            maxCoord[d] = std::max(maxCoord[d], c[d]);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// |x|^2 of the points of a chunk
+class SquareNormTask : public ParallelTask
+{
+public:
+    SquareNormTask(const DataSet& ds, std::vector<DistanceType>& norms, const size_t nbChunks)
+        :   m_ds(ds)
+        ,   m_norms(norms)
+        ,   m_nbChunks(nbChunks)
+    {
+    }
+
+    virtual void run(const size_t chunkIdx)
+    {
+        size_t begin = 0;
+        size_t end   = 0;
+        chunkRange(m_ds.size(), m_nbChunks, chunkIdx, begin, end);
+        for(size_t i=begin; i<end; i++)
+        {
+            m_norms[i] = coordDot(m_ds.coords(i), m_ds.coords(i), m_ds.dim());
+        }
+    }
+
+    const DataSet&             m_ds;
+    std::vector<DistanceType>& m_norms;
+    const size_t               m_nbChunks;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+void DataSet::computeSquareNorms( )
+{
+    m_squareNorms.resize(m_nb_points);
+
+    SquareNormTask task(*this, m_squareNorms, getNbThreads());
+    parallelFor(task, task.m_nbChunks);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool DataSet::setWeights(const std::vector<double>& weights)
+{
+    if(weights.size() != m_nb_points)
+    {
+        fprintf(stdout, "Error: %ld weights for %ld points\n", weights.size(), m_nb_points);
+        return false;
+    }
+    for(size_t i=0; i<weights.size(); i++)
+    {
+        if(!(weights[i] > 0) || weights[i] == std::numeric_limits<double>::infinity())
+        {
+            fprintf(stdout, "Error: point %ld has an invalid weight %g\n", i, weights[i]);
+            return false;
+        }
+    }
+    m_weights = weights;
+    releaseKdTree( );
     return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+bool DataSet::readWeights(const std::string fname)
+{
+    FILE* p = fopen(fname.c_str(), "rt");
+    if(!p)
+    {
+        fprintf(stdout, "Error: cannot open file '%s'\n", fname.c_str());
+        return false;
+    }
+    std::vector<double> weights;
+    weights.reserve(m_nb_points);
+    double value = 0;
+    while(fscanf(p, "%lf", &value) == 1)
+    {
+        weights.push_back(value);
+    }
+    const bool bEnd = feof(p) != 0;
+    fclose(p);
+    if(!bEnd)
+    {
+        fprintf(stdout, "Error: '%s' line %ld: malformed weight\n", fname.c_str(), weights.size() + 1);
+        return false;
+    }
+    return setWeights(weights);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double DataSet::totalWeight( )const
+{
+    if(m_weights.empty())
+    {
+        return (double)m_nb_points;
+    }
+    double total = 0.0;
+    for(size_t i=0; i<m_nb_points; i++)
+    {
+        total += m_weights[i];
+    }
+    return total;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// orders the points by their coordinates, then by their index
+class CoordLess
+{
+public:
+    CoordLess(const DataSet& ds)
+        :   m_ds(ds)
+    {
+    }
+
+    bool operator()(const size_t a, const size_t b)const
+    {
+        const Coord* ca = m_ds.coords(a);
+        const Coord* cb = m_ds.coords(b);
+        for(size_t d=0; d<m_ds.dim(); d++)
+        {
+            if(ca[d] != cb[d]) return ca[d] < cb[d];
+        }
+        return a < b;
+    }
+
+    const DataSet& m_ds;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t DataSet::aggregateDuplicates(DataSet& unique)const
+{
+    const size_t dim = m_nb_dimension;
+    if(unique.size() != 0)
+    {
+        fprintf(stdout, "Error: duplicates aggregated in a non empty data set\n");
+        return 0;
+    }
+
+    // the copies of a point are consecutive, the first one first
+    std::vector<size_t> order(m_nb_points);
+    for(size_t i=0; i<m_nb_points; i++)
+    {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), CoordLess(*this));
+
+    // the first copy of each distinct point, and the weight of its copies
+    std::vector<std::pair<size_t, double> > distinct;
+    for(size_t k=0; k<order.size(); k++)
+    {
+        const size_t i = order[k];
+        if(k > 0 && std::equal(coords(i), coords(i) + dim, coords(order[k-1])))
+        {
+            distinct.back().second += weight(i);
+        }
+        else
+        {
+            distinct.push_back(std::make_pair(i, weight(i)));
+        }
+    }
+    std::sort(distinct.begin(), distinct.end());
+
+    std::vector<double> weights(distinct.size());
+    unique.reserve(distinct.size(), dim);
+    for(size_t k=0; k<distinct.size(); k++)
+    {
+        unique.append(coords(distinct[k].first), dim);
+        weights[k] = distinct[k].second;
+    }
+    unique.setWeights(weights);
+    return distinct.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool DataSet::isBinaryFile(const std::string fname)
+{
+    bool bOk = false;
+    FILE* p = fopen(fname.c_str(), "rb");
+    if(p)
+    {
+        char magic[sizeof(DataSetFileMagic)];
+        bOk = (fread(magic, sizeof(magic), 1, p) == 1) &&
+              (memcmp(magic, DataSetFileMagic, sizeof(magic)) == 0);
+        fclose(p);
+    }
+    return bOk;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool DataSet::writeBinary(const std::string fname)const
+{
+    if(!m_weights.empty())
+    {
+        fprintf(stdout, "Error: cannot write the weights of '%s' in binary format\n", fname.c_str());
+        return false;
+    }
+    FILE* p = fopen(fname.c_str(), "wb");
+    if(!p)
+    {
+        fprintf(stdout, "Error: cannot open file '%s'\n", fname.c_str());
+        return false;
+    }
+    std::vector<Coord> minCoord;
+    std::vector<Coord> maxCoord;
+    range(minCoord, maxCoord);
+
+    const size_t rangeSize = 2 * m_nb_dimension * sizeof(double);
+    const size_t dataEnd   = sizeof(DataSetFileHeader) + rangeSize;
+
+    DataSetFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DataSetFileMagic, sizeof(header.magic));
+    header.version    = DataSetFileVersion;
+    header.dtype      = coordFileType();
+    header.nbPoints   = m_nb_points;
+    header.dim        = m_nb_dimension;
+    header.dataOffset = (dataEnd + CoordBlockAlignment - 1) / CoordBlockAlignment * CoordBlockAlignment;
+
+    std::vector<double> rangeValues(minCoord.begin(), minCoord.end());
+    rangeValues.insert(rangeValues.end(), maxCoord.begin(), maxCoord.end());
+    std::vector<char> padding(header.dataOffset - dataEnd, 0);
+
+    const size_t nbValues = m_nb_points * m_nb_dimension;
+    bool bOk = (fwrite(&header, sizeof(header), 1, p) == 1);
+    if(bOk && rangeSize)
+    {
+        bOk = (fwrite(&rangeValues[0], rangeSize, 1, p) == 1);
+    }
+    if(bOk && !padding.empty())
+    {
+        bOk = (fwrite(&padding[0], padding.size(), 1, p) == 1);
+    }
+    if(bOk && nbValues)
+    {
+        bOk = (fwrite(m_coordBlock, sizeof(Coord), nbValues, p) == nbValues);
+    }
+    if(fclose(p) != 0)
+    {
+        bOk = false;
+    }
+    if(!bOk)
+    {
+        fprintf(stdout, "Error: cannot write file '%s'\n", fname.c_str());
+    }
+    return bOk;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool DataSet::readBinary(const std::string fname)
+{
+    void*  addr = 0;
+    size_t size = 0;
+    if(!mapFile(fname, addr, size))
+    {
+        return false;
+    }
+    if(size < sizeof(DataSetFileHeader))
+    {
+        fprintf(stdout, "Error: '%s' is not a valid binary data set file\n", fname.c_str());
+        if(addr) munmap(addr, size);
+        return false;
+    }
+
+    const char*              base   = (const char*)addr;
+    const DataSetFileHeader& header = *(const DataSetFileHeader*)base;
+
+    if(!isValidHeader(header, size))
+    {
+        fprintf(stdout, "Error: '%s' is not a valid binary data set file\n", fname.c_str());
+        munmap(addr, size);
+        return false;
+    }
+    if(m_nb_points != 0 && header.dim != m_nb_dimension)
+    {
+        fprintf(stdout, "Error: '%s' has dim %ld (data set dim: %ld)\n",
+                fname.c_str(), (size_t)header.dim, m_nb_dimension);
+        munmap(addr, size);
+        return false;
+    }
+    const double* rangeValues = (const double*)(base + sizeof(header));
+    const char*   block       = base + header.dataOffset;
+
+    if(m_nb_points == 0 && header.dtype == coordFileType())
+    {
+        // zero copy: the mapping is the coordinate block
+        releaseBlock( );
+        m_mappedAddr   = addr;
+        m_mappedSize   = size;
+        m_coordBlock   = (Coord*)block;
+        m_nb_points    = header.nbPoints;
+        m_capacity     = header.nbPoints;
+        m_nb_dimension = header.dim;
+        m_minCoord.assign(rangeValues, rangeValues + header.dim);
+        m_maxCoord.assign(rangeValues + header.dim, rangeValues + 2 * header.dim);
+        m_squareNorms.clear();
+        m_weights.clear();
+        releaseKdTree( );
+    }
+    else
+    {
+        // copy the points, converting the coordinates type
+        reserve(m_nb_points + header.nbPoints, header.dim);
+        Point::CoordVector values(header.dim);
+        for(size_t i=0; i<header.nbPoints; i++)
+        {
+            for(size_t d=0; d<header.dim; d++)
+            {
+                const size_t k = i * header.dim + d;
+                values[d] = (header.dtype == DataSetFileFloat32)
+                                ?   ((const float*) block)[k]
+                                :   ((const double*)block)[k];
+            }
+            addPoint(values);
+        }
+        munmap(addr, size);
+    }
+    return true;
+}
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -5,8 +5,19 @@
 #include <vector>
 #include "Point.h"
 
+class KdTree;
+
+//
+// This class stores all the points available in the model.
 //
-// This class stores all the points available in the model
+// The coordinates are kept in a single aligned, row-major block of
+// size() x dim() values. The point i is stored at coords(i), and its PointId
+// is its index in the data set. Points returned by operator[] are views
+// into that block.
+//
+// The block can also be a read-only memory mapping of a binary data set file
+// (see writeBinary/readBinary). Adding points to a mapped data set copies
+// the block first.
 //
 class DataSet
 {
@@ -20,35 +31,167 @@ class DataSet
                        ~DataSet             ( )                               ;
     
     // total number of points
-    size_t              size                ( )                         const ;
+    size_t              size                ( )                         const
+    { return m_nb_points; }
 
-    // dimention of first point
-    size_t              dim                 ( )                         const ;
+    // dimention of the points
+    size_t              dim                 ( )                         const
+    { return m_nb_dimension; }
 
-    // the ith point in the data set
-    const Point&        operator[]          (const size_t i)            const ;
+    // the ith point in the data set (a view on the coordinate block)
+    Point               operator[]          (const size_t i)            const
+    { return Point(PointId(i), coords(i), m_nb_dimension); }
+    
+    // the ith point in the data set (a view on the coordinate block)
+    Point               operator[]          (const PointId& id)         const
+    { return operator[](id.value()); }
     
-    // the ith point in the data set
-    const Point&        operator[]          (const PointId& id)         const ;
+    // the coordinates of the ith point: dim() consecutive values
+    const Coord*        coords              (const size_t i)            const
+    { return m_coordBlock + i * m_nb_dimension; }
+    
+    // the coordinate block: size() x dim() values, row-major
+    const Coord*        coordBlock          ( )                         const
+    { return m_coordBlock; }
+    
+    ///
+    /// \brief reserve Pre-allocates the coordinate block.
+    /// \param nbPoints expected number of points
+    /// \param dim      points dimension. Ignored if the data set is not empty.
+    ///
+    void                reserve             (const size_t nbPoints,
+                                             const size_t dim)                ;
     
     /// \brief addPoint Adds new point for the dataset. The dataset will take
-    ///                 ownership of the externally allocated pointer.
+    ///                 ownership of the externally allocated pointer: its
+    ///                 coordinates are copied in the block, and the object
+    ///                 deleted.
     /// \param point   Point* object.
     ///
     void                addPoint            (Point* point)                    ;
 
+    ///
+    /// \brief addPoint Adds new point for the dataset, from its coordinates.
+    ///                 All the points must have the same dimension.
+    /// \param coords the point coordinates
+    /// \return false if the dimension does not match the data set.
+    ///
+    bool                addPoint            (const Point::CoordVector& coords);
+
     /// \brief addPointList adds a set of points to the data set. The pointer
-    ///                     objects will be copied internally, and deleted at
-    ///                     the dataset destructor
+    ///                     objects will be copied internally, and deleted.
     /// \param vec Vector of points
     ///
     void                addPointList        (const std::vector<Point*>& vec)  ;
 
+    ///
+    /// \brief range Computes the [min,max] range of each dimension.
+    ///              Binary data sets take it from the file header.
+    /// \param minCoord min value of each dimension
+    /// \param maxCoord max value of each dimension
+    ///
+    void                range               (std::vector<Coord>& minCoord,
+                                             std::vector<Coord>& maxCoord) const;
+
+    ///
+    /// \brief computeSquareNorms Computes and caches |x|^2 for each point, so
+    ///                           that the distances can be computed from dot
+    ///                           products: |x-y|^2 = |x|^2 - 2 x.y + |y|^2.
+    ///                           The cache is cleared when points are added.
+    ///
+    void                computeSquareNorms  ( )                               ;
+
+    // the cached |x|^2 of each point (see computeSquareNorms), or 0
+    const DistanceType* squareNorms         ( )                         const
+    { return (m_squareNorms.size() == m_nb_points && m_nb_points > 0) ? &m_squareNorms[0] : 0; }
+
+    ///
+    /// \brief setWeights Sets the weight of each point: a point of weight w
+    ///                   counts as w points at its position (centroids,
+    ///                   inertia, k-means++ seeding, DBSCAN minPts). The
+    ///                   points added later have a weight of 1.
+    /// \param weights one weight (finite, > 0) per point
+    /// \return false if the size or a value is not valid.
+    ///
+    bool                setWeights          (const std::vector<double>& weights);
+
+    ///
+    /// \brief readWeights Reads the weights from a text file, one per line,
+    ///                    in the order of the points (see setWeights).
+    /// \param fname filename
+    /// \return true/false.
+    ///
+    bool                readWeights         (const std::string fname)         ;
+
+    // the weight of each point, or 0 if all the points have a weight of 1
+    const double*       weights             ( )                         const
+    { return (m_weights.size() == m_nb_points && m_nb_points > 0) ? &m_weights[0] : 0; }
+
+    // the weight of the ith point
+    double              weight              (const size_t i)            const
+    { return m_weights.empty() ? 1.0 : m_weights[i]; }
+
+    // the sum of the weights
+    double              totalWeight         ( )                         const ;
+
+    ///
+    /// \brief aggregateDuplicates Fills an empty data set with the distinct
+    ///                            points, in the order of their first copy,
+    ///                            each weighted by the sum of the weights of
+    ///                            its copies. The centroids and the inertia
+    ///                            of a clustering are the same on both.
+    /// \param unique the distinct points
+    /// \return the number of distinct points
+    ///
+    size_t              aggregateDuplicates (DataSet& unique)           const ;
+
+    ///
+    /// \brief computeKdTree Builds and caches the kd-tree of the points (see
+    ///                      KdTree.h), for the filtering K-Means. The cache
+    ///                      is cleared when points or weights are set.
+    ///
+    void                computeKdTree       ( )                               ;
+
+    // the cached kd-tree of the points (see computeKdTree), or 0
+    const KdTree*       kdTree              ( )                         const
+    { return m_kdTree; }
+
+    // true if the coordinate block is a mapping of a binary data set file
+    bool                isMapped            ( )                         const
+    { return m_mappedAddr != 0; }
+
     void                write               (const std::string fname)   const ;
 
+    ///
+    /// \brief writeBinary Writes the data set in the binary format: a header
+    ///                    with the number of points, the dimension, the
+    ///                    coordinate type and the range of each dimension,
+    ///                    followed by the row-major coordinate block. The
+    ///                    values are written in the machine byte order.
+    ///                    The format has no weights: a weighted data set
+    ///                    is not written.
+    /// \param fname filename
+    /// \return true/false.
+    ///
+    bool                writeBinary         (const std::string fname)   const ;
+
+    ///
+    /// \brief readBinary Loads a binary data set file. The file is mapped in
+    ///                   memory and used as the coordinate block, without
+    ///                   copy, if the data set is empty and the file type
+    ///                   matches Coord. Otherwise, the points are copied.
+    /// \param fname filename
+    /// \return true/false.
+    ///
+    bool                readBinary          (const std::string fname)         ;
+
+    // true if the file starts with the binary data set signature
+    static bool         isBinaryFile        (const std::string fname)         ;
+
     ///
     /// \brief read the data set from a file. The file is expected to be csv,
-    ///             with a point per line.
+    ///             with a point per line, or a binary data set file
+    ///             (see readBinary).
     /// \param fname filename
     /// \param separator the line separator
     /// \return true/false.
@@ -60,11 +203,47 @@ class DataSet
     private:
 ///////////////////////////////////////////////////////////////////////////////
     
+    // not copyable
+                        DataSet             (const DataSet&)                  ;
+    DataSet&            operator=           (const DataSet&)                  ;
+    
     // Init collection of points
     void                init_points         ( )                               ;
     
+    // grows the coordinate block, to hold at least nbPoints.
+    void                grow                (const size_t nbPoints)           ;
+    
+    // copies the coordinates of a point at the end of the block
+    bool                append              (const Coord* coords,
+                                             const size_t dim)                ;
+    
+    // frees (or unmaps) the coordinate block
+    void                releaseBlock        ( )                               ;
+
+    // clears the kd-tree cache
+    void                releaseKdTree       ( )                               ;
+    
     size_t              m_nb_dimension                                        ;
-    std::vector<Point*> m_pointVector                                         ;
+    size_t              m_nb_points                                           ;
+    size_t              m_capacity                                            ;
+    Coord*              m_coordBlock                                          ;
+    
+    // the file mapping, when the block is loaded from a binary file
+    void*               m_mappedAddr                                          ;
+    size_t              m_mappedSize                                          ;
+    
+    // the range stored in the binary file header (empty if unknown)
+    std::vector<Coord>  m_minCoord                                            ;
+    std::vector<Coord>  m_maxCoord                                            ;
+    
+    // the |x|^2 cache (empty if not computed)
+    std::vector<DistanceType> m_squareNorms                                   ;
+
+    // the weight of each point (empty if all the weights are 1)
+    std::vector<double> m_weights                                             ;
+
+    // the kd-tree cache (0 if not computed)
+    KdTree*             m_kdTree                                              ;
 };
 
 #endif
@@ -0,0 +1,76 @@
+#ifndef _DataSetFile_h_
+#define _DataSetFile_h_
+
+#include <stdint.h>
+#include <string.h>
+#include "Point.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Binary data set file:
+//      DataSetFileHeader
+//      double min[dim]
+//      double max[dim]
+//      (padding)
+//      Coord  block[nbPoints*dim]  (at offset 'dataOffset', 64 bytes aligned)
+//
+// The values are stored in the machine byte order.
+
+// alignment (in bytes) of the coordinate block
+static const size_t   CoordBlockAlignment = 64;
+
+static const char     DataSetFileMagic[8] = { 'C','L','U','S','T','D','S','\0' };
+static const uint32_t DataSetFileVersion  = 1;
+
+// coordinate type stored in the file
+enum DataSetFileType
+{
+        DataSetFileFloat64  = 0
+    ,   DataSetFileFloat32  = 1
+};
+
+struct DataSetFileHeader
+{
+    char        magic[8]                                                      ;
+    uint32_t    version                                                       ;
+    uint32_t    dtype                                                         ;
+    uint64_t    nbPoints                                                      ;
+    uint64_t    dim                                                           ;
+    uint64_t    dataOffset                                                    ;
+};
+
+// the file type of the current Coord
+inline uint32_t coordFileType( )
+{
+    return (sizeof(Coord) == sizeof(float)) ? DataSetFileFloat32 : DataSetFileFloat64;
+}
+
+// size in bytes of a coordinate stored in the file
+inline size_t fileValueSize(const DataSetFileHeader& header)
+{
+    return (header.dtype == DataSetFileFloat32) ? sizeof(float) : sizeof(double);
+}
+
+// true if the header is consistent with a file of 'fileSize' bytes. The
+// sizes are compared by divisions: a crafted header cannot overflow them.
+inline bool isValidHeader(const DataSetFileHeader& header, const size_t fileSize)
+{
+    if(fileSize < sizeof(header)
+       || memcmp(header.magic, DataSetFileMagic, sizeof(header.magic)) != 0
+       || header.version != DataSetFileVersion
+       || (header.dtype != DataSetFileFloat32 && header.dtype != DataSetFileFloat64)
+       || header.dataOffset % CoordBlockAlignment != 0
+       || header.dataOffset > fileSize
+       || header.dim > (fileSize - sizeof(header)) / (2 * sizeof(double))
+       || header.dataOffset < sizeof(header) + 2 * header.dim * sizeof(double))
+    {
+        return false;
+    }
+    // an empty data set may have no dimension
+    if(header.dim == 0)
+    {
+        return header.nbPoints == 0;
+    }
+    return header.nbPoints <= (fileSize - header.dataOffset) / (header.dim * fileValueSize(header));
+}
+
+#endif
@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "DataSetFile.h"
+#include "DataSetStream.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+DataSetStream::DataSetStream(const size_t blockSize)
+    :   m_fd(-1)
+    ,   m_blockSize(blockSize > 0 ? blockSize : 1)
+    ,   m_nb_points(0)
+    ,   m_nb_dimension(0)
+    ,   m_dataOffset(0)
+    ,   m_isFloat32(false)
+    ,   m_bFailed(false)
+    ,   m_blockBegin(0)
+    ,   m_blockNbPoints(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+DataSetStream::~DataSetStream( )
+{
+    close();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool DataSetStream::open(const std::string fname)
+{
+    close();
+
+    m_fd = ::open(fname.c_str(), O_RDONLY);
+    if(m_fd < 0)
+    {
+        fprintf(stdout, "Error: cannot open file '%s'\n", fname.c_str());
+        return false;
+    }
+    DataSetFileHeader header;
+    struct stat st;
+    const bool bOk = fstat(m_fd, &st) == 0
+                  && pread(m_fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header)
+                  && isValidHeader(header, st.st_size);
+    if(!bOk)
+    {
+        fprintf(stdout, "Error: '%s' is not a valid binary data set file\n", fname.c_str());
+        close();
+        return false;
+    }
+    std::vector<double> rangeValues(2 * header.dim);
+    const size_t rangeSize = rangeValues.size() * sizeof(double);
+    if(rangeSize && pread(m_fd, &rangeValues[0], rangeSize, sizeof(header)) != (ssize_t)rangeSize)
+    {
+        fprintf(stdout, "Error: cannot read file '%s'\n", fname.c_str());
+        close();
+        return false;
+    }
+    m_minCoord.assign(rangeValues.begin(), rangeValues.begin() + header.dim);
+    m_maxCoord.assign(rangeValues.begin() + header.dim, rangeValues.end());
+
+    m_fname         = fname;
+    m_nb_points     = header.nbPoints;
+    m_nb_dimension  = header.dim;
+    m_dataOffset    = header.dataOffset;
+    m_isFloat32     = (header.dtype == DataSetFileFloat32);
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    rewind();
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void DataSetStream::close( )
+{
+    if(m_fd >= 0)
+    {
+        ::close(m_fd);
+    }
+    m_fd            = -1;
+    m_bFailed       = false;
+    m_nb_points     = 0;
+    m_nb_dimension  = 0;
+    m_blockBegin    = 0;
+    m_blockNbPoints = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void DataSetStream::rewind( )
+{
+    m_blockBegin    = 0;
+    m_blockNbPoints = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t DataSetStream::nextBlock( )
+{
+    m_blockBegin   += m_blockNbPoints;
+    m_blockNbPoints = 0;
+    if(m_fd < 0 || m_bFailed || m_blockBegin >= m_nb_points)
+    {
+        return 0;
+    }
+    const size_t nbPoints  = std::min(m_blockSize, m_nb_points - m_blockBegin);
+    const size_t nbValues  = nbPoints * m_nb_dimension;
+    const size_t valueSize = m_isFloat32 ? sizeof(float) : sizeof(double);
+    const size_t nbBytes   = nbValues * valueSize;
+    const off_t  offset    = m_dataOffset + m_blockBegin * m_nb_dimension * valueSize;
+
+    m_block.resize(std::max(m_block.size(), nbValues));
+
+    // read directly in the block, when the file type is Coord
+    char* dest = (valueSize == sizeof(Coord)) ? (char*)&m_block[0] : 0;
+    if(!dest)
+    {
+        m_buffer.resize(nbBytes);
+        dest = &m_buffer[0];
+    }
+    size_t nbRead = 0;
+    while(nbRead < nbBytes)
+    {
+        const ssize_t n = pread(m_fd, dest + nbRead, nbBytes - nbRead, offset + nbRead);
+        if(n <= 0)
+        {
+            fprintf(stdout, "Error: cannot read file '%s'\n", m_fname.c_str());
+            m_bFailed = true;
+            return 0;
+        }
+        nbRead += n;
+    }
+    if(dest != (char*)&m_block[0])
+    {
+        for(size_t i=0; i<nbValues; i++)
+        {
+            m_block[i] = m_isFloat32 ? ((const float*) dest)[i]
+                                     : ((const double*)dest)[i];
+        }
+    }
+    m_blockNbPoints = nbPoints;
+    return nbPoints;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool DataSetStream::readPoint(const size_t pid, Coord* coords)const
+{
+    if(m_fd < 0 || pid >= m_nb_points)
+    {
+        return false;
+    }
+    const size_t valueSize = m_isFloat32 ? sizeof(float) : sizeof(double);
+    const size_t nbBytes   = m_nb_dimension * valueSize;
+    const off_t  offset    = m_dataOffset + pid * nbBytes;
+
+    std::vector<char> buffer(nbBytes);
+    if(pread(m_fd, &buffer[0], nbBytes, offset) != (ssize_t)nbBytes)
+    {
+        fprintf(stdout, "Error: cannot read file '%s'\n", m_fname.c_str());
+        return false;
+    }
+    for(size_t i=0; i<m_nb_dimension; i++)
+    {
+        coords[i] = m_isFloat32 ? ((const float*) &buffer[0])[i]
+                                : ((const double*)&buffer[0])[i];
+    }
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,117 @@
+#ifndef _DataSetStream_h_
+#define _DataSetStream_h_
+
+#include <string>
+#include <vector>
+#include "Point.h"
+
+//
+// Reads a binary data set file (see DataSet::writeBinary) by blocks of
+// points, without loading the whole file in memory. Can be used to process
+// data sets larger than the memory, one pass at a time.
+//
+class DataSetStream
+{
+///////////////////////////////////////////////////////////////////////////////
+    public:
+///////////////////////////////////////////////////////////////////////////////
+
+    ///
+    /// \brief DataSetStream
+    /// \param blockSize the number of points of each block.
+    ///
+                        DataSetStream       (const size_t blockSize=65536)    ;
+
+                       ~DataSetStream       ( )                               ;
+
+    ///
+    /// \brief open Opens a binary data set file, and rewinds the stream.
+    /// \param fname filename
+    /// \return true/false
+    ///
+    bool                open                (const std::string fname)         ;
+
+    void                close               ( )                               ;
+
+    // total number of points in the file
+    size_t              size                ( )                         const
+    { return m_nb_points; }
+
+    // dimension of the points
+    size_t              dim                 ( )                         const
+    { return m_nb_dimension; }
+
+    // the [min,max] range of each dimension (from the file header)
+    void                range               (std::vector<Coord>& minCoord,
+                                             std::vector<Coord>& maxCoord) const
+    { minCoord = m_minCoord; maxCoord = m_maxCoord; }
+
+    // max number of points in a block
+    size_t              blockSize           ( )                         const
+    { return m_blockSize; }
+
+    // restarts the stream at the first point
+    void                rewind              ( )                               ;
+
+    ///
+    /// \brief nextBlock Reads the next block of points.
+    /// \return the number of points of the block, zero at the end of the
+    ///         stream, or on error (see failed()).
+    ///
+    size_t              nextBlock           ( )                               ;
+
+    // true if a read of nextBlock failed: the pass stopped before the end
+    // of the stream. Reset by open() and close() only.
+    bool                failed              ( )                         const
+    { return m_bFailed; }
+
+    // the coordinates of the current block, row-major.
+    const Coord*        block               ( )                         const
+    { return m_block.empty() ? 0 : &m_block[0]; }
+
+    // index (PointId) of the first point of the current block
+    size_t              blockBegin          ( )                         const
+    { return m_blockBegin; }
+
+    // number of points in the current block
+    size_t              blockNbPoints       ( )                         const
+    { return m_blockNbPoints; }
+
+    ///
+    /// \brief readPoint Reads one point, anywhere in the file. Does not
+    ///                  change the current block.
+    /// \param pid    the point index
+    /// \param coords the dim() coordinates of the point
+    /// \return true/false
+    ///
+    bool                readPoint           (const size_t pid,
+                                             Coord*       coords)       const ;
+
+///////////////////////////////////////////////////////////////////////////////
+    private:
+///////////////////////////////////////////////////////////////////////////////
+
+    // not copyable
+                        DataSetStream       (const DataSetStream&)            ;
+    DataSetStream&      operator=           (const DataSetStream&)            ;
+
+    int                 m_fd                                                  ;
+    std::string         m_fname                                               ;
+    size_t              m_blockSize                                           ;
+    size_t              m_nb_points                                           ;
+    size_t              m_nb_dimension                                        ;
+    size_t              m_dataOffset                                          ;
+    bool                m_isFloat32                                           ;
+    bool                m_bFailed                                             ;
+    std::vector<Coord>  m_minCoord                                            ;
+    std::vector<Coord>  m_maxCoord                                            ;
+
+    size_t              m_blockBegin                                          ;
+    size_t              m_blockNbPoints                                       ;
+    std::vector<Coord>  m_block                                               ;
+
+    // file values, when the file type is not Coord
+    std::vector<char>   m_buffer                                              ;
+};
+
+#endif
@@ -66,12 +66,14 @@ void createRandomDataSet(std::vector<Point*>& pointList,
     }
     Point::CoordVector coord(pointDim);
     std::vector<double> centroid;
+    std::vector<double> values;
     std::vector<double> dev;
 
     size_t pid = 0;
     for(size_t ipos=0; ipos<iNbNoisePoints; ipos++)
     {
-       coord = getRandomVector(pointDim, min_val, max_val);
+       values = getRandomVector(pointDim, min_val, max_val);
+       coord.assign(values.begin(), values.end());
        pointList.push_back( new Point(pid++, coord));
     }
 
@@ -79,7 +81,8 @@ void createRandomDataSet(std::vector<Point*>& pointList,
     {
         for(size_t ipos=0; ipos<iNbPoint; ipos++)
         {
-           coord = getRandomVector(pointDim, min_val, max_val);
+           values = getRandomVector(pointDim, min_val, max_val);
+           coord.assign(values.begin(), values.end());
            pointList.push_back(new Point(pid++, coord));
         }
     }
@@ -0,0 +1,445 @@
+#include <stdio.h>
+#include <cmath>
+
+#include "Distance.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define CLUSTER_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+typedef DistanceType (*DistanceKernel)(const Coord* a, const Coord* b, const size_t dim);
+
+struct DistanceKernels
+{
+    const char*     m_name;
+    DistanceKernel  m_squareDistance;
+    DistanceKernel  m_l1Distance;
+    DistanceKernel  m_dot;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// Portable kernels
+
+static DistanceType scalarSquareDistance(const Coord* a, const Coord* b, const size_t dim)
+{
+    DistanceType total(0);
+    for(size_t i=0; i<dim; i++)
+    {
+        const DistanceType diff(a[i] - b[i]);
+        total += diff * diff;
+    }
+    return total;
+}
+
+static DistanceType scalarL1Distance(const Coord* a, const Coord* b, const size_t dim)
+{
+    DistanceType total(0);
+    for(size_t i=0; i<dim; i++)
+    {
+        total += fabs(DistanceType(a[i] - b[i]));
+    }
+    return total;
+}
+
+static DistanceType scalarDot(const Coord* a, const Coord* b, const size_t dim)
+{
+    DistanceType total(0);
+    for(size_t i=0; i<dim; i++)
+    {
+        total += DistanceType(a[i]) * b[i];
+    }
+    return total;
+}
+
+#ifdef CLUSTER_X86_KERNELS
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// x86 kernels. The coordinates are converted to double and the sums are done
+// in double, as in the scalar kernels, so only the order of the additions
+// changes. SSE2 is part of x86-64; the AVX2 and AVX-512 kernels are compiled
+// for their instruction set with the target attribute, and only called when
+// the CPU supports it.
+//
+
+// SSE2: 2 coordinates per register
+static inline __m128d sse2Load(const double* p)
+{ return _mm_loadu_pd(p); }
+
+static inline __m128d sse2Load(const float* p)
+{ return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64((const __m128i*)p))); }
+
+static inline double sse2Sum(const __m128d v)
+{
+    double lanes[2];
+    _mm_storeu_pd(lanes, v);
+    return lanes[0] + lanes[1];
+}
+
+static DistanceType sse2SquareDistance(const Coord* a, const Coord* b, const size_t dim)
+{
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for(; i+4<=dim; i+=4)
+    {
+        const __m128d d0 = _mm_sub_pd(sse2Load(a+i),   sse2Load(b+i));
+        const __m128d d1 = _mm_sub_pd(sse2Load(a+i+2), sse2Load(b+i+2));
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(d0, d0));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(d1, d1));
+    }
+    DistanceType total = sse2Sum(_mm_add_pd(acc0, acc1));
+    for(; i<dim; i++)
+    {
+        const DistanceType diff(DistanceType(a[i]) - b[i]);
+        total += diff * diff;
+    }
+    return total;
+}
+
+static DistanceType sse2L1Distance(const Coord* a, const Coord* b, const size_t dim)
+{
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for(; i+4<=dim; i+=4)
+    {
+        const __m128d d0 = _mm_sub_pd(sse2Load(a+i),   sse2Load(b+i));
+        const __m128d d1 = _mm_sub_pd(sse2Load(a+i+2), sse2Load(b+i+2));
+        acc0 = _mm_add_pd(acc0, _mm_andnot_pd(signMask, d0));
+        acc1 = _mm_add_pd(acc1, _mm_andnot_pd(signMask, d1));
+    }
+    DistanceType total = sse2Sum(_mm_add_pd(acc0, acc1));
+    for(; i<dim; i++)
+    {
+        total += fabs(DistanceType(a[i]) - b[i]);
+    }
+    return total;
+}
+
+static DistanceType sse2Dot(const Coord* a, const Coord* b, const size_t dim)
+{
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    size_t i = 0;
+    for(; i+4<=dim; i+=4)
+    {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(sse2Load(a+i),   sse2Load(b+i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(sse2Load(a+i+2), sse2Load(b+i+2)));
+    }
+    DistanceType total = sse2Sum(_mm_add_pd(acc0, acc1));
+    for(; i<dim; i++)
+    {
+        total += DistanceType(a[i]) * b[i];
+    }
+    return total;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// AVX2: 4 coordinates per register
+
+#define AVX2_TARGET __attribute__((target("avx2,fma")))
+
+AVX2_TARGET
+static inline __m256d avx2Load(const double* p)
+{ return _mm256_loadu_pd(p); }
+
+AVX2_TARGET
+static inline __m256d avx2Load(const float* p)
+{ return _mm256_cvtps_pd(_mm_loadu_ps(p)); }
+
+AVX2_TARGET
+static inline double avx2Sum(const __m256d v)
+{
+    double lanes[4];
+    _mm256_storeu_pd(lanes, v);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+AVX2_TARGET
+static DistanceType avx2SquareDistance(const Coord* a, const Coord* b, const size_t dim)
+{
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for(; i+8<=dim; i+=8)
+    {
+        const __m256d d0 = _mm256_sub_pd(avx2Load(a+i),   avx2Load(b+i));
+        const __m256d d1 = _mm256_sub_pd(avx2Load(a+i+4), avx2Load(b+i+4));
+        acc0 = _mm256_fmadd_pd(d0, d0, acc0);
+        acc1 = _mm256_fmadd_pd(d1, d1, acc1);
+    }
+    if(i+4<=dim)
+    {
+        const __m256d d0 = _mm256_sub_pd(avx2Load(a+i), avx2Load(b+i));
+        acc0 = _mm256_fmadd_pd(d0, d0, acc0);
+        i += 4;
+    }
+    DistanceType total = avx2Sum(_mm256_add_pd(acc0, acc1));
+    for(; i<dim; i++)
+    {
+        const DistanceType diff(DistanceType(a[i]) - b[i]);
+        total += diff * diff;
+    }
+    return total;
+}
+
+AVX2_TARGET
+static DistanceType avx2L1Distance(const Coord* a, const Coord* b, const size_t dim)
+{
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for(; i+8<=dim; i+=8)
+    {
+        const __m256d d0 = _mm256_sub_pd(avx2Load(a+i),   avx2Load(b+i));
+        const __m256d d1 = _mm256_sub_pd(avx2Load(a+i+4), avx2Load(b+i+4));
+        acc0 = _mm256_add_pd(acc0, _mm256_andnot_pd(signMask, d0));
+        acc1 = _mm256_add_pd(acc1, _mm256_andnot_pd(signMask, d1));
+    }
+    if(i+4<=dim)
+    {
+        const __m256d d0 = _mm256_sub_pd(avx2Load(a+i), avx2Load(b+i));
+        acc0 = _mm256_add_pd(acc0, _mm256_andnot_pd(signMask, d0));
+        i += 4;
+    }
+    DistanceType total = avx2Sum(_mm256_add_pd(acc0, acc1));
+    for(; i<dim; i++)
+    {
+        total += fabs(DistanceType(a[i]) - b[i]);
+    }
+    return total;
+}
+
+AVX2_TARGET
+static DistanceType avx2Dot(const Coord* a, const Coord* b, const size_t dim)
+{
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for(; i+8<=dim; i+=8)
+    {
+        acc0 = _mm256_fmadd_pd(avx2Load(a+i),   avx2Load(b+i),   acc0);
+        acc1 = _mm256_fmadd_pd(avx2Load(a+i+4), avx2Load(b+i+4), acc1);
+    }
+    if(i+4<=dim)
+    {
+        acc0 = _mm256_fmadd_pd(avx2Load(a+i), avx2Load(b+i), acc0);
+        i += 4;
+    }
+    DistanceType total = avx2Sum(_mm256_add_pd(acc0, acc1));
+    for(; i<dim; i++)
+    {
+        total += DistanceType(a[i]) * b[i];
+    }
+    return total;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// AVX-512: 8 coordinates per register
+
+#define AVX512_TARGET __attribute__((target("avx512f")))
+
+AVX512_TARGET
+static inline __m512d avx512Load(const double* p)
+{ return _mm512_loadu_pd(p); }
+
+// the maskz conversion: _mm512_cvtps_pd reads an undefined register
+// (-Wmaybe-uninitialized)
+AVX512_TARGET
+static inline __m512d avx512Load(const float* p)
+{ return _mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(p)); }
+
+// the lanes are stored: _mm512_reduce_add_pd reads an undefined register
+// too. The sum order is the one of the reduction.
+AVX512_TARGET
+static inline double avx512Sum(const __m512d v)
+{
+    double lanes[8];
+    _mm512_storeu_pd(lanes, v);
+    return ((lanes[0] + lanes[4]) + (lanes[2] + lanes[6])) + ((lanes[1] + lanes[5]) + (lanes[3] + lanes[7]));
+}
+
+AVX512_TARGET
+static DistanceType avx512SquareDistance(const Coord* a, const Coord* b, const size_t dim)
+{
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for(; i+16<=dim; i+=16)
+    {
+        const __m512d d0 = _mm512_sub_pd(avx512Load(a+i),   avx512Load(b+i));
+        const __m512d d1 = _mm512_sub_pd(avx512Load(a+i+8), avx512Load(b+i+8));
+        acc0 = _mm512_fmadd_pd(d0, d0, acc0);
+        acc1 = _mm512_fmadd_pd(d1, d1, acc1);
+    }
+    if(i+8<=dim)
+    {
+        const __m512d d0 = _mm512_sub_pd(avx512Load(a+i), avx512Load(b+i));
+        acc0 = _mm512_fmadd_pd(d0, d0, acc0);
+        i += 8;
+    }
+    DistanceType total = avx512Sum(_mm512_add_pd(acc0, acc1));
+    for(; i<dim; i++)
+    {
+        const DistanceType diff(DistanceType(a[i]) - b[i]);
+        total += diff * diff;
+    }
+    return total;
+}
+
+AVX512_TARGET
+static DistanceType avx512L1Distance(const Coord* a, const Coord* b, const size_t dim)
+{
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for(; i+16<=dim; i+=16)
+    {
+        const __m512d d0 = _mm512_sub_pd(avx512Load(a+i),   avx512Load(b+i));
+        const __m512d d1 = _mm512_sub_pd(avx512Load(a+i+8), avx512Load(b+i+8));
+        acc0 = _mm512_add_pd(acc0, _mm512_abs_pd(d0));
+        acc1 = _mm512_add_pd(acc1, _mm512_abs_pd(d1));
+    }
+    if(i+8<=dim)
+    {
+        const __m512d d0 = _mm512_sub_pd(avx512Load(a+i), avx512Load(b+i));
+        acc0 = _mm512_add_pd(acc0, _mm512_abs_pd(d0));
+        i += 8;
+    }
+    DistanceType total = avx512Sum(_mm512_add_pd(acc0, acc1));
+    for(; i<dim; i++)
+    {
+        total += fabs(DistanceType(a[i]) - b[i]);
+    }
+    return total;
+}
+
+AVX512_TARGET
+static DistanceType avx512Dot(const Coord* a, const Coord* b, const size_t dim)
+{
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for(; i+16<=dim; i+=16)
+    {
+        acc0 = _mm512_fmadd_pd(avx512Load(a+i),   avx512Load(b+i),   acc0);
+        acc1 = _mm512_fmadd_pd(avx512Load(a+i+8), avx512Load(b+i+8), acc1);
+    }
+    if(i+8<=dim)
+    {
+        acc0 = _mm512_fmadd_pd(avx512Load(a+i), avx512Load(b+i), acc0);
+        i += 8;
+    }
+    DistanceType total = avx512Sum(_mm512_add_pd(acc0, acc1));
+    for(; i<dim; i++)
+    {
+        total += DistanceType(a[i]) * b[i];
+    }
+    return total;
+}
+
+#endif // CLUSTER_X86_KERNELS
+
+////////////////////////////////////////////////////////////////////////////////
+// The kernels, from the best to the most portable one
+
+static const DistanceKernels s_kernelTable[] =
+{
+#ifdef CLUSTER_X86_KERNELS
+        { "avx512", avx512SquareDistance, avx512L1Distance, avx512Dot }
+    ,   { "avx2",   avx2SquareDistance,   avx2L1Distance,   avx2Dot   }
+    ,   { "sse2",   sse2SquareDistance,   sse2L1Distance,   sse2Dot   }
+    ,
+#endif
+        { "scalar", scalarSquareDistance, scalarL1Distance, scalarDot }
+};
+
+static const size_t s_nbKernels = sizeof(s_kernelTable) / sizeof(s_kernelTable[0]);
+
+static bool isKernelSupported(const DistanceKernels& kernels)
+{
+    const std::string name(kernels.m_name);
+#ifdef CLUSTER_X86_KERNELS
+    __builtin_cpu_init();
+    if(name == "avx512") return __builtin_cpu_supports("avx512f");
+    if(name == "avx2")   return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    if(name == "sse2")   return true;
+#endif
+    return name == "scalar";
+}
+
+// The kernels in use. The scalar kernels are set before any dynamic
+// initialization, so they are valid even before the selection below.
+static DistanceKernels s_kernels = { "scalar", scalarSquareDistance, scalarL1Distance, scalarDot };
+
+static bool selectBestKernels( )
+{
+    for(size_t i=0; i<s_nbKernels; i++)
+    {
+        if(isKernelSupported(s_kernelTable[i]))
+        {
+            s_kernels = s_kernelTable[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+static const bool s_bKernelsSelected = selectBestKernels();
+
+////////////////////////////////////////////////////////////////////////////////
+
+DistanceType coordSquareDistance(const Coord* a, const Coord* b, const size_t dim)
+{
+    return s_kernels.m_squareDistance(a, b, dim);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+DistanceType coordDistance(const Coord* a, const Coord* b, const size_t dim)
+{
+    return sqrt(s_kernels.m_squareDistance(a, b, dim));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+DistanceType coordL1Distance(const Coord* a, const Coord* b, const size_t dim)
+{
+    return s_kernels.m_l1Distance(a, b, dim);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+DistanceType coordDot(const Coord* a, const Coord* b, const size_t dim)
+{
+    return s_kernels.m_dot(a, b, dim);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+const char* distanceKernelName( )
+{
+    return s_kernels.m_name;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool setDistanceKernel(const std::string& name)
+{
+    for(size_t i=0; i<s_nbKernels; i++)
+    {
+        if(name == s_kernelTable[i].m_name && isKernelSupported(s_kernelTable[i]))
+        {
+            s_kernels = s_kernelTable[i];
+            return true;
+        }
+    }
+    fprintf(stdout, "Error: distance kernel '%s' not supported\n", name.c_str());
+    return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,46 @@
+#ifndef _Distance_h_
+#define _Distance_h_
+
+#include <string>
+#include "Point.h"
+
+//
+// Distance kernels on raw coordinates, for any dimension. The kernels are
+// vectorized (SSE2, AVX2 or AVX-512) when the CPU supports it: the best
+// implementation is selected once, at startup, from the CPU features.
+//
+
+///
+/// \brief coordSquareDistance (a[0]-b[0])^2 + (a[1]-b[1])^2 + ...
+///
+DistanceType coordSquareDistance(const Coord* a, const Coord* b, const size_t dim);
+
+///
+/// \brief coordDistance The euclidean (L2) distance.
+///
+DistanceType coordDistance(const Coord* a, const Coord* b, const size_t dim);
+
+///
+/// \brief coordL1Distance |a[0]-b[0]| + |a[1]-b[1]| + ...
+///
+DistanceType coordL1Distance(const Coord* a, const Coord* b, const size_t dim);
+
+///
+/// \brief coordDot The dot product a[0]*b[0] + a[1]*b[1] + ...
+///
+DistanceType coordDot(const Coord* a, const Coord* b, const size_t dim);
+
+///
+/// \brief distanceKernelName The name of the kernels in use: "scalar",
+///                           "sse2", "avx2" or "avx512".
+///
+const char* distanceKernelName( );
+
+///
+/// \brief setDistanceKernel Forces the kernels (see distanceKernelName).
+///                          Must be called before any computation.
+/// \return false if the kernels are unknown or not supported by the CPU.
+///
+bool setDistanceKernel(const std::string& name);
+
+#endif
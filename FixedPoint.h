@@ -0,0 +1,171 @@
+#ifndef _FixedPoint_h_
+#define _FixedPoint_h_
+
+#include <stdlib.h>
+#include <cmath>
+#include "Point.h"
+#include "Distance.h"
+
+//
+// Kernels on raw coordinates, with the dimension known at compile time.
+// The loops have a constant trip count, and are fully unrolled by the
+// compiler. FixedDim<0> is the runtime dimension fallback: the 'dim'
+// argument is only used by this one, and its distance is the vectorized
+// kernel (see Distance.h).
+//
+template<size_t D>
+struct FixedDim
+{
+    static size_t       dim             (const size_t)
+    { return D; }
+
+    // (a[0]-b[0])^2 + (a[1]-b[1])^2 + ...
+    static DistanceType squareDistance  (const Coord* a,
+                                         const Coord* b,
+                                         const size_t)
+    {
+        DistanceType total(0);
+        for(size_t i=0; i<D; i++)
+        {
+            const DistanceType diff(a[i] - b[i]);
+            total += diff * diff;
+        }
+        return total;
+    }
+
+    // sum[i] += c[i]
+    static void         accumulate      (CoordSum*    sum,
+                                         const Coord* c,
+                                         const size_t)
+    {
+        for(size_t i=0; i<D; i++)
+        {
+            sum[i] += c[i];
+        }
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<>
+struct FixedDim<0>
+{
+    static size_t       dim             (const size_t dim)
+    { return dim; }
+
+    static DistanceType squareDistance  (const Coord* a,
+                                         const Coord* b,
+                                         const size_t dim)
+    { return coordSquareDistance(a, b, dim); }
+
+    static void         accumulate      (CoordSum*    sum,
+                                         const Coord* c,
+                                         const size_t dim)
+    {
+        for(size_t i=0; i<dim; i++)
+        {
+            sum[i] += c[i];
+        }
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// \brief closestCentroid The closest centroid to a point.
+/// \param p          the point coordinates
+/// \param centroids  row-major block of nbCentroid x dim coordinates
+/// \param nbCentroid number of centroids
+/// \param dim        dimension (only used by FixedDim<0>)
+/// \param minDist    the square distance to the closest centroid
+/// \return the index of the closest centroid (the first one, on ties)
+///
+template<class Dim>
+inline size_t closestCentroid(const Coord*  p,
+                              const Coord*  centroids,
+                              const size_t  nbCentroid,
+                              const size_t  dim,
+                              DistanceType& minDist)
+{
+    size_t closest = 0;
+    minDist = Dim::squareDistance(p, centroids, dim);
+    for(size_t cid=1; cid<nbCentroid; cid++)
+    {
+        const DistanceType dist = Dim::squareDistance(p, centroids + cid * dim, dim);
+        if(dist < minDist)
+        {
+            minDist = dist;
+            closest = cid;
+        }
+    }
+    return closest;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// A point with D coordinates, stored by value.
+//
+template<size_t D>
+class FixedPoint
+{
+////////////////////////////////////////////////////////////////////////////////
+    public:
+////////////////////////////////////////////////////////////////////////////////
+
+    FixedPoint( )
+    { clear(); }
+
+    // copy the first D coordinates of c
+    explicit FixedPoint(const Coord* c)
+    {
+        for(size_t i=0; i<D; i++) m_coord[i] = c[i];
+    }
+
+    static size_t               dim             ( )
+    { return D; }
+
+    Coord                       operator[]      (const size_t i)          const
+    { return m_coord[i]; }
+
+    Coord&                      operator[]      (const size_t i)
+    { return m_coord[i]; }
+
+    const Coord*                data            ( )                       const
+    { return m_coord; }
+
+    Coord                       x               ( )                       const
+    { return m_coord[0]; }
+
+    Coord                       y               ( )                       const
+    { return m_coord[1]; }
+
+    void                        clear           ( )
+    {
+        for(size_t i=0; i<D; i++) m_coord[i] = 0;
+    }
+
+    FixedPoint&                 operator+=      (const FixedPoint& other)
+    {
+        for(size_t i=0; i<D; i++) m_coord[i] += other.m_coord[i];
+        return *this;
+    }
+
+    FixedPoint&                 operator/=      (const double v)
+    {
+        for(size_t i=0; i<D; i++) m_coord[i] /= v;
+        return *this;
+    }
+
+    DistanceType                squareDistanceTo(const FixedPoint& other) const
+    { return FixedDim<D>::squareDistance(m_coord, other.m_coord, D); }
+
+    DistanceType                distanceTo      (const FixedPoint& other) const
+    { return sqrt(squareDistanceTo(other)); }
+
+////////////////////////////////////////////////////////////////////////////////
+    private:
+////////////////////////////////////////////////////////////////////////////////
+
+    Coord                       m_coord[D]                                    ;
+};
+
+#endif
@@ -11,26 +11,32 @@
 
 #include "Sort.h"
 #include "Point.h"
+#include "FixedPoint.h"
 #include "GrahamScan.h"
 
+// the hull is computed on the (x,y) plane.
+typedef FixedPoint<2> Point2D;
+
 // A utility function to find next to top in a stack
-static Point* nextToTop(std::stack<Point*>& S)
+static size_t nextToTop(std::stack<size_t>& S)
 {
-    Point* p = S.top();
+    size_t p = S.top();
     S.pop();
-    Point* res = S.top();
+    size_t res = S.top();
     S.push(p);
     return res;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 // To find orientation of ordered triplet (p, q, r).
-PointOrientationType ComputePointOrientation(const Point* p, const Point* q, const Point* r)
+static PointOrientationType computeOrientation(const Point2D& p, 
+                                               const Point2D& q, 
+                                               const Point2D& r)
 {
     static const double eps = 1e-6;
     // int val = (q.y - p.y) * (r.x - q.x) - (q.x - p.x) * (r.y - q.y);
-    const Coord val = (q->y() - p->y()) * (r->x() - q->x()) -
-                      (q->x() - p->x()) * (r->y() - q->y());
+    const Coord val = (q.y() - p.y()) * (r.x() - q.x()) -
+                      (q.x() - p.x()) * (r.y() - q.y());
 
     return (fabs(val) <= eps)
                 ?   PointOrientationColinear
@@ -40,31 +46,37 @@ PointOrientationType ComputePointOrientation(const Point* p, const Point* q, con
 }
 
 ///////////////////////////////////////////////////////////////////////////////
+// To find orientation of ordered triplet (p, q, r).
+PointOrientationType ComputePointOrientation(const Point* p, const Point* q, const Point* r)
+{
+    return computeOrientation(Point2D(p->data()), 
+                              Point2D(q->data()), 
+                              Point2D(r->data()));
+}
 
+///////////////////////////////////////////////////////////////////////////////
+// Compares the index of two points, by its polar angle in respect to p0.
 template<class T>
 class ComparePoints : public SortCompare<T>
 {
 public:
 
-    ComparePoints(Point* p0)
-        : m_p0(p0)
+    ComparePoints(const std::vector<Point2D>& points, const Point2D& p0)
+        : m_points(points)
+        , m_p0(p0)
     {
     }
-    bool operator()(const T p1, const T p2)const
+    bool operator()(const T i1, const T i2)const
     {
-        //std::cout << p1 << " " << p2 << "\n";
-        assert(m_p0);
-        if(!p1) return false;
-        if(!p2) return false;
+        const Point2D& p1 = m_points[i1];
+        const Point2D& p2 = m_points[i2];
 
-        assert(p1);
-        assert(p2);
         bool ret = true;
-        const int o = ComputePointOrientation(m_p0, p1, p2);
+        const int o = computeOrientation(m_p0, p1, p2);
         switch(o)
         {
             case 0: // p, q, r : colinear
-                ret = (m_p0->squareDistanceTo(*p2) >= m_p0->squareDistanceTo(*p1))
+                ret = (m_p0.squareDistanceTo(p2) >= m_p0.squareDistanceTo(p1))
                         ?  false
                         :  true;
                 break;
@@ -80,7 +92,8 @@ public:
         }
         return !ret;
     }
-    Point* m_p0;
+    const std::vector<Point2D>& m_points;
+    const Point2D               m_p0;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -92,6 +105,8 @@ static bool isEqual(double d1, double d2, double eps=1e-6)
 
 ///////////////////////////////////////////////////////////////////////////////
 // Prints convex hull of a set of n points.
+// Only the first two coordinates are considered: the points are copied in a
+// contiguous array of 2D points, and the scan runs on their indexes.
 void computeConvexHull(const std::vector<Point*>& pointArray,
                        std::vector<Point*>&       curve,
                        const bool                 bVerbose)
@@ -101,27 +116,28 @@ void computeConvexHull(const std::vector<Point*>& pointArray,
         fprintf(stdout, "computeConvexHull: nbPts: %ld\n", pointArray.size());
     }
     curve.resize(0);
-    if(pointArray.size() < 3)
+    if(pointArray.size() < 3 || pointArray[0]->dim() < 2)
     {
         return;
     }
 
-    std::vector<Point*> points;
-    points.resize(pointArray.size());
-    for(size_t i=0; i<points.size(); i++)
+    const size_t n = pointArray.size();
+    std::vector<Point2D> points2D(n);
+    std::vector<size_t>  points(n);
+    for(size_t i=0; i<n; i++)
     {
-        points[i] = pointArray[i];
+        points2D[i] = Point2D(pointArray[i]->data());
+        points[i]   = i;
     }
-    const size_t n = points.size();
     // Find the bottommost point
     size_t min = 0;
-    Coord  ymin = points[min]->y();
-    Coord  xmin = points[min]->x();
+    Coord  ymin = points2D[min].y();
+    Coord  xmin = points2D[min].x();
 
     for(size_t i=1; i<n; i++)
     {
-        const Coord x = points[i]->x();
-        const Coord y = points[i]->y();
+        const Coord x = points2D[i].x();
+        const Coord y = points2D[i].y();
         // Pick the bottom-most or chose the left most point in case of tie
         if ((y<ymin) || (isEqual(y,ymin) && x<xmin))
         {
@@ -131,27 +147,22 @@ void computeConvexHull(const std::vector<Point*>& pointArray,
         }
     }
     // Place the bottom-most point at first position
-    //std::swap(points[0], points[min]);
     if(min != 0)
     {
-        Point* p    = points[0];
-        points[0]   = points[min];
-        points[min] = p;
+        points[0]   = min;
+        points[min] = 0;
     }
     if(0 && bVerbose)
     {
-        fprintf(stdout, "pivot point: %s, at pos:%ld\n", points[0]->toString().c_str(), min);
+        fprintf(stdout, "pivot point: %s, at pos:%ld\n", pointArray[points[0]]->toString().c_str(), min);
     }
     // Sort n-1 points with respect to the first point. A point p1 comes
     // before p2 in sorted ouput if p2 has larger polar angle (in
     // counterclockwise direction) than p1
-    // qsort(&points[1], n-1, sizeof(Point), compare);
-    ComparePoints<Point*> compareFunction(points[0]);
+    ComparePoints<size_t> compareFunction(points2D, points2D[points[0]]);
 
     // Note: for some unknown reason, the std::sort does not work on apple c++ compiler.
     //       the swap of pointers is not working properly!!!
-    // std::sort(points.begin()+1, points.end(), compareFunction);
-    // BubbleSort(points, 1, compareFunction);
     QuickSort(points, 1, points.size()-1, compareFunction);
 
     // print the point array
@@ -160,20 +171,13 @@ void computeConvexHull(const std::vector<Point*>& pointArray,
         fprintf(stdout, "** List of sorted points\n");
         for(size_t i=0; i<n; i++)
         {
-            if(points[i])
-            {
-                fprintf(stdout, "[%03ld]: %s \n", i, points[i]->toString().c_str());
-            }
-            else
-            {
-                fprintf(stdout, "[%ld] null\n", i);
-            }
+            fprintf(stdout, "[%03ld]: %s \n", i, pointArray[points[i]]->toString().c_str());
         }
         fprintf(stdout, "\n\n");
     }
 
     // Create an empty stack and push first three points to it.
-    std::stack<Point*> stack;
+    std::stack<size_t> stack;
     
     stack.push(points[0]);
     stack.push(points[1]);
@@ -185,7 +189,9 @@ void computeConvexHull(const std::vector<Point*>& pointArray,
         // Keep removing top while the angle formed by points next-to-top,
         // top, and points[i] makes a non-left turn
         while(stack.size()>1 &&
-              ComputePointOrientation(nextToTop(stack), stack.top(), points[i]) != PointOrientationConterClockWise)
+              computeOrientation(points2D[nextToTop(stack)], 
+                                 points2D[stack.top()], 
+                                 points2D[points[i]]) != PointOrientationConterClockWise)
         {
             stack.pop();
         }
@@ -195,7 +201,7 @@ void computeConvexHull(const std::vector<Point*>& pointArray,
     curve.resize(0);
     while (!stack.empty())
     {
-        curve.push_back(stack.top());
+        curve.push_back(pointArray[stack.top()]);
         stack.pop();
     }
 }
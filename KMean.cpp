@@ -1,9 +1,19 @@
 #include <cmath>
 #include <algorithm>
+#include <memory>
 #include "Sort.h"
+#include "BatchAssigner.h"
 #include "DataSetUtil.h"
+#include "FixedPoint.h"
 #include "ClusterSet.h"
+#include "BisectingKMeans.h"
 #include "ClusterFunctions.h"
+#include "Coreset.h"
+#include "KMeansInit.h"
+#include "KMedoids.h"
+#include "Parallel.h"
+#include "Random.h"
+#include "StreamKMeans.h"
 #include "KMean.h"
 
 template<class T>
@@ -164,6 +174,90 @@ void createDataSet(const std::string dataset_fname,
     ds.write(dataset_fname);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+//
+// Independent K-Means runs on the same data set, one per chunk. The runs are
+// concurrent (the parallel loops of a run are then on its thread), each with
+// its own random generator: the result of a run does not depend on the
+// others, nor on the number of threads.
+//
+class KMeansRestartTask : public ParallelTask
+{
+public:
+    KMeansRestartTask(const DataSet&          ds,
+                      const size_t            nbCluster,
+                      const size_t            maxIter,
+                      const KMeansMethod      method,
+                      const InitMethod        init,
+                      const KMeansTolerance&  tol,
+                      const size_t            nbRun)
+        :   m_ds(ds)
+        ,   m_nbCluster(nbCluster)
+        ,   m_maxIter(maxIter)
+        ,   m_method(method)
+        ,   m_init(init)
+        ,   m_tol(tol)
+        ,   m_seeds(nbRun)
+        ,   m_clusters(nbRun, (ClusterSet*)0)
+        ,   m_inertia(nbRun, -1.0)
+    {
+        // the seeds of the runs come from rand() (see -seed)
+        for(size_t i=0; i<nbRun; i++)
+        {
+            m_seeds[i] = ((size_t)randomInteger() << 16) ^ (size_t)randomInteger();
+        }
+    }
+
+    ~KMeansRestartTask( )
+    {
+        for(size_t i=0; i<m_clusters.size(); i++)
+        {
+            delete m_clusters[i];
+        }
+    }
+
+    virtual void run(const size_t runIdx)
+    {
+        ThreadRandomSeed seed(m_seeds[runIdx]);
+
+        const bool printIter     = false;
+        const bool printSynopsis = false;
+        ClusterSet* cs = new ClusterSet(m_ds, m_nbCluster);
+        m_clusters[runIdx] = cs;
+        m_inertia[runIdx] = computeKMeans(*cs, m_maxIter, printIter, m_method, m_init, m_tol, printSynopsis);
+    }
+
+    // the run of lowest inertia, the client is responsible for deleting it
+    ClusterSet* releaseBest( )
+    {
+        size_t best = m_clusters.size();
+        for(size_t i=0; i<m_clusters.size(); i++)
+        {
+            if(m_inertia[i] < 0) continue;
+            if(best == m_clusters.size() || m_inertia[i] < m_inertia[best]) best = i;
+        }
+        if(best == m_clusters.size())
+        {
+            return 0;
+        }
+        fprintf(stdout, "* K-Means best run: %ld\n", best);
+        ClusterSet* cs = m_clusters[best];
+        m_clusters[best] = 0;
+        return cs;
+    }
+
+    const DataSet&                      m_ds;
+    const size_t                        m_nbCluster;
+    const size_t                        m_maxIter;
+    const KMeansMethod                  m_method;
+    const InitMethod                    m_init;
+    const KMeansTolerance               m_tol;
+
+    std::vector<size_t>                 m_seeds;
+    std::vector<ClusterSet*>            m_clusters;
+    std::vector<double>                 m_inertia;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 ///
 /// \brief computeKMeans Computes the K-Mean for a given dataset
@@ -172,19 +266,47 @@ void createDataSet(const std::string dataset_fname,
 /// \param clusterName  cluster name, used to save data files
 /// \param createRegionPlot string: if given a region file will be created.
 ///
-void computeKMeans(const DataSet&       ds,
-                   const size_t         iNbCluster,
-                   const std::string    clusterName,
-                   const size_t         maxIter, 
-                   const bool           bVerbose)
+bool computeKMeans(const DataSet&          ds,
+                   const size_t            iNbCluster,
+                   const std::string       clusterName,
+                   const size_t            maxIter, 
+                   const bool              bVerbose,
+                   const KMeansMethod      method,
+                   const InitMethod        init,
+                   const KMeansTolerance&  tol,
+                   const size_t            nbInit)
 {
-    ClusterSet cs(ds, iNbCluster);
-    
-    bool printIter = bVerbose;
-    computeKMeans(cs, maxIter, printIter);
+    std::unique_ptr<ClusterSet> pcs;
+    if(nbInit <= 1)
+    {
+        bool printIter = bVerbose;
+        pcs.reset(new ClusterSet(ds, iNbCluster));
+        if(computeKMeans(*pcs, maxIter, printIter, method, init, tol) < 0)
+        {
+            return false;
+        }
+    }
+    else
+    {
+        // independent runs, in parallel: only the best one is written
+        KMeansRestartTask restarts(ds, iNbCluster, maxIter, method, init, tol, nbInit);
+        parallelFor(restarts, nbInit);
+        for(size_t i=0; i<nbInit; i++)
+        {
+            fprintf(stdout, "* K-Means run %ld: seed %ld, inertia %g\n", i, restarts.m_seeds[i], restarts.m_inertia[i]);
+        }
+        pcs.reset(restarts.releaseBest());
+        if(!pcs.get())
+        {
+            return false;
+        }
+        printClusterSynopsis(*pcs);
+    }
+    ClusterSet& cs = *pcs;
+
     for(ClusterId cid=0; cid<cs.nbCluster(); cid++)
     {
-        std::vector<Point*> curve;
+        std::vector<Point> curve;
 
         std::string curveName = clusterName + ".region." + toString(cid) + ".txt";
         computeClusterBondary(cs, cid, curve, curveName, bVerbose);
@@ -196,6 +318,7 @@ void computeKMeans(const DataSet&       ds,
         writeClusterPointIdFile(ds, cs.pointsInCluster(cid), cs.getCentroid(cid), fname, bVerbose);
     }
     clustersCreatePlots(cs, clusterName, iNbCluster);
+    return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -213,7 +336,7 @@ void computeKMeans(const DataSet&       ds,
                    const size_t         maxIter,
                    const bool           bVerbose)
 {
-    std::auto_ptr<ClusterSet> pcs(createSubCluster(ds, clusterPidFname, iNbCluster));
+    std::unique_ptr<ClusterSet> pcs(createSubCluster(ds, clusterPidFname, iNbCluster));
     ClusterSet& cs = *pcs;
 
     bool printIter = bVerbose;
@@ -221,7 +344,7 @@ void computeKMeans(const DataSet&       ds,
 
     for(ClusterId cid=0; cid<cs.nbCluster(); cid++)
     {
-        std::vector<Point*> curve;
+        std::vector<Point> curve;
 
         std::string curveName = clusterName + ".region." + toString(cid) + ".txt";
         computeClusterBondary(cs, cid, curve, curveName, bVerbose);
@@ -236,4 +359,616 @@ void computeKMeans(const DataSet&       ds,
     clustersCreatePlots(cs, clusterName, iNbCluster);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Prints the clusters, and writes the centroids to '<clusterName>.centroid.txt'
+static void writeCentroids(const std::vector<Point>&  centroids,
+                           const std::vector<size_t>& clusterSize,
+                           const size_t               nbPoints,
+                           const double               inertia,
+                           const std::string          clusterName)
+{
+    std::cout << "* Clusters: "  << std::endl;
+    std::cout << "nb_points:   " << nbPoints << std::endl;
+    std::cout << "nb_clusters: " << centroids.size() << std::endl;
+    std::cout << "inertia:     " << inertia << std::endl;
+    for(ClusterId cid=0; cid<centroids.size(); cid++)
+    {
+        fprintf(stdout, "cluster: %d, size: %4ld, centroid: %s\n",
+                cid, clusterSize[cid], centroids[cid].toString().c_str());
+    }
+
+    const std::string fname = clusterName + ".centroid.txt";
+    FILE* f = fopen(fname.c_str(), "wt");
+    if(f)
+    {
+        const bool printBrackets = false;
+        for(ClusterId cid=0; cid<centroids.size(); cid++)
+        {
+            fprintf(f, "%s %u\n", centroids[cid].toString(printBrackets).c_str(), cid);
+        }
+        fclose(f);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// \brief computeStreamKMeans Computes the K-Mean of a binary data set file,
+///                            read by blocks.
+///
+void computeStreamKMeans(const std::string       dsfname,
+                         const size_t            iNbCluster,
+                         const std::string       clusterName,
+                         const size_t            maxIter,
+                         const size_t            blockSize,
+                         const bool              bVerbose,
+                         const QuantizationType  quantize)
+{
+    DataSetStream stream(blockSize);
+    if(!stream.open(dsfname))
+    {
+        return;
+    }
+    fprintf(stdout, "* Data set stream '%s'\n", dsfname.c_str());
+    fprintf(stdout, "  Size     %ld\n", stream.size());
+    fprintf(stdout, "  Dim      %ld\n", stream.dim());
+    fprintf(stdout, "  Block    %ld\n", stream.blockSize());
 
+    std::vector<Point>  centroids;
+    std::vector<size_t> clusterSize;
+    const double inertia = (quantize == QuantizeNone)
+                            ?   computeStreamKMeans(stream, iNbCluster, maxIter, 
+                                                    centroids, clusterSize, bVerbose)
+                            :   computeQuantizedStreamKMeans(stream, quantize, iNbCluster, maxIter, 
+                                                             centroids, clusterSize, bVerbose);
+    if(centroids.empty())
+    {
+        fprintf(stdout, "Error: the K-Means of '%s' failed\n", dsfname.c_str());
+        return;
+    }
+    writeCentroids(centroids, clusterSize, stream.size(), inertia, clusterName);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// \brief computeMiniBatchKMeans Computes the mini-batch K-Mean of a data
+///                               set in memory.
+///
+void computeMiniBatchKMeans(const DataSet&    ds,
+                            const size_t      iNbCluster,
+                            const std::string clusterName,
+                            const size_t      batchSize,
+                            const size_t      nbStep,
+                            const size_t      seed,
+                            const bool        bVerbose)
+{
+    fprintf(stdout, "* Mini-batch: %ld points x %ld steps\n", batchSize, nbStep);
+
+    std::vector<Point>  centroids;
+    std::vector<size_t> clusterSize;
+    const double inertia = computeMiniBatchKMeans(ds, iNbCluster, batchSize, nbStep, seed,
+                                                  centroids, clusterSize, bVerbose);
+    writeCentroids(centroids, clusterSize, ds.size(), inertia, clusterName);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// \brief computeMiniBatchStreamKMeans Computes the mini-batch K-Mean of a
+///                                     binary data set file.
+///
+void computeMiniBatchStreamKMeans(const std::string dsfname,
+                                  const size_t      iNbCluster,
+                                  const std::string clusterName,
+                                  const size_t      batchSize,
+                                  const size_t      nbStep,
+                                  const size_t      seed,
+                                  const size_t      blockSize,
+                                  const bool        bVerbose)
+{
+    DataSetStream stream(blockSize);
+    if(!stream.open(dsfname))
+    {
+        return;
+    }
+    fprintf(stdout, "* Data set stream '%s'\n", dsfname.c_str());
+    fprintf(stdout, "  Size     %ld\n", stream.size());
+    fprintf(stdout, "  Dim      %ld\n", stream.dim());
+    fprintf(stdout, "  Block    %ld\n", stream.blockSize());
+    fprintf(stdout, "* Mini-batch: %ld points x %ld steps\n", batchSize, nbStep);
+
+    std::vector<Point>  centroids;
+    std::vector<size_t> clusterSize;
+    const double inertia = computeMiniBatchKMeans(stream, iNbCluster, batchSize, nbStep, seed,
+                                                  centroids, clusterSize, bVerbose);
+    if(centroids.empty())
+    {
+        fprintf(stdout, "Error: the mini-batch K-Means of '%s' failed\n", dsfname.c_str());
+        return;
+    }
+    writeCentroids(centroids, clusterSize, stream.size(), inertia, clusterName);
+}
+
+// k sweep: number of consecutive k of a chain (warm started from each other)
+static const size_t KSweepChainLength = 4;
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// The K-Means of a range of k, by chains of consecutive k. The chains are
+// concurrent, each with its own random generator. In a chain, the first k
+// is seeded by k-means++, and each next k starts from the centroids of the
+// previous one, plus one D^2 seed: fewer iterations than a cold start.
+//
+class KMeansSweepTask : public ParallelTask
+{
+public:
+    KMeansSweepTask(const DataSet&          ds,
+                    const size_t            kMin,
+                    const size_t            kMax,
+                    const size_t            maxIter,
+                    const KMeansMethod      method,
+                    const KMeansTolerance&  tol)
+        :   m_ds(ds)
+        ,   m_kMin(kMin)
+        ,   m_kMax(kMax)
+        ,   m_maxIter(maxIter)
+        ,   m_method(method)
+        ,   m_tol(tol)
+        ,   m_nbChain((kMax - kMin + KSweepChainLength) / KSweepChainLength)
+        ,   m_seeds(m_nbChain)
+        ,   m_points(ds.size())
+        ,   m_inertia(kMax - kMin + 1, -1.0)
+        ,   m_silhouette(kMax - kMin + 1, 0.0)
+    {
+        // the seeds of the chains come from rand() (see -seed)
+        for(size_t i=0; i<m_nbChain; i++)
+        {
+            m_seeds[i] = ((size_t)randomInteger() << 16) ^ (size_t)randomInteger();
+        }
+        for(size_t i=0; i<ds.size(); i++)
+        {
+            m_points[i] = ds.coords(i);
+        }
+    }
+
+    virtual void run(const size_t chainIdx)
+    {
+        ThreadRandomSeed seed(m_seeds[chainIdx]);
+
+        const size_t dim    = m_ds.dim();
+        const size_t kBegin = m_kMin + chainIdx * KSweepChainLength;
+        const size_t kEnd   = std::min(kBegin + KSweepChainLength, m_kMax + 1);
+
+        // the (finite) centroids of the previous k
+        std::vector<Coord> centroids;
+        for(size_t k=kBegin; k<kEnd; k++)
+        {
+            ClusterSet cs(m_ds, k);
+            InitMethod init = KMeansPlusPlus;
+            if(!centroids.empty())
+            {
+                const size_t nbPrev = centroids.size() / dim;
+                std::vector<size_t> seeds;
+                kmeansPlusPlusExtend(m_points, dim, centroids, k - nbPrev, seeds, m_ds.weights());
+                for(size_t cid=0; cid<nbPrev; cid++)
+                {
+                    std::copy(&centroids[cid * dim], &centroids[cid * dim] + dim, cs.getCentroid(cid).data());
+                }
+                for(size_t i=0; i<seeds.size(); i++)
+                {
+                    cs.getCentroid(nbPrev + i) = cs.point(seeds[i]);
+                }
+                init = CurrentCentroids;
+            }
+            const bool printIter     = false;
+            const bool printSynopsis = false;
+            m_inertia[k - m_kMin]    = computeKMeans(cs, m_maxIter, printIter, m_method, init, m_tol, printSynopsis);
+            if(m_inertia[k - m_kMin] < 0)
+            {
+                // the next k of the chain start from this one
+                return;
+            }
+            m_silhouette[k - m_kMin] = computeCentroidSilhouette(cs);
+
+            centroids.resize(0);
+            for(ClusterId cid=0; cid<k; cid++)
+            {
+                const Coord* c = cs.getCentroid(cid).data();
+                bool bFinite = true;
+                for(size_t d=0; d<dim; d++) bFinite = bFinite && std::isfinite(c[d]);
+                if(bFinite)
+                {
+                    centroids.insert(centroids.end(), c, c + dim);
+                }
+            }
+        }
+    }
+
+    // the k of the elbow of the inertia curve: the farthest point below the
+    // line from the first to the last k (both axes normalized)
+    size_t elbow( )const
+    {
+        const size_t nbK   = m_inertia.size();
+        const double first = m_inertia[0];
+        const double last  = m_inertia[nbK - 1];
+        size_t best     = 0;
+        double bestDist = 0;
+        for(size_t i=1; i+1<nbK && first>last; i++)
+        {
+            const double x    = i / (double)(nbK - 1);
+            const double y    = (m_inertia[i] - last) / (first - last);
+            const double dist = (1.0 - x) - y;
+            if(dist > bestDist)
+            {
+                bestDist = dist;
+                best     = i;
+            }
+        }
+        return m_kMin + best;
+    }
+
+    const DataSet&                      m_ds;
+    const size_t                        m_kMin;
+    const size_t                        m_kMax;
+    const size_t                        m_maxIter;
+    const KMeansMethod                  m_method;
+    const KMeansTolerance               m_tol;
+    const size_t                        m_nbChain;
+
+    std::vector<size_t>                 m_seeds;
+    std::vector<const Coord*>           m_points;
+    std::vector<double>                 m_inertia;
+    std::vector<double>                 m_silhouette;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// \brief computeKMeansSweep Computes the K-Mean of a range of k.
+///
+bool computeKMeansSweep(const DataSet&          ds,
+                        const size_t            kMin,
+                        const size_t            kMax,
+                        const std::string       clusterName,
+                        const size_t            maxIter,
+                        const KMeansMethod      method,
+                        const KMeansTolerance&  tol)
+{
+    if(kMin == 0 || kMin > kMax || kMax > ds.size())
+    {
+        fprintf(stdout, "Error: k sweep: invalid range [%ld, %ld] (%ld points)\n", kMin, kMax, ds.size());
+        return false;
+    }
+    fprintf(stdout, "* K sweep: k in [%ld, %ld], method %s\n", kMin, kMax, kmeansMethodName(method));
+
+    KMeansSweepTask sweep(ds, kMin, kMax, maxIter, method, tol);
+    parallelFor(sweep, sweep.m_nbChain);
+    for(size_t k=kMin; k<=kMax; k++)
+    {
+        if(sweep.m_inertia[k - kMin] < 0)
+        {
+            fprintf(stdout, "Error: k sweep: the K-Means of k = %ld failed\n", k);
+            return false;
+        }
+    }
+
+    size_t bestSilhouette = kMin;
+    for(size_t k=kMin; k<=kMax; k++)
+    {
+        if(sweep.m_silhouette[k - kMin] > sweep.m_silhouette[bestSilhouette - kMin]) bestSilhouette = k;
+    }
+    const size_t elbow = sweep.elbow();
+
+    // the summary table
+    const std::string fname = clusterName + ".ksweep.txt";
+    FILE* f = fopen(fname.c_str(), "wt");
+    if(!f)
+    {
+        fprintf(stdout, "Error: cannot write '%s'\n", fname.c_str());
+    }
+    else
+    {
+        fprintf(f, "# k inertia silhouette\n");
+    }
+    fprintf(stdout, "    k      inertia  silhouette\n");
+    for(size_t k=kMin; k<=kMax; k++)
+    {
+        const double inertia    = sweep.m_inertia[k - kMin];
+        const double silhouette = sweep.m_silhouette[k - kMin];
+        fprintf(stdout, "%5ld %12g %11.4f%s%s\n", k, inertia, silhouette,
+                (k == elbow)          ? "  <- elbow"           : "",
+                (k == bestSilhouette) ? "  <- best silhouette" : "");
+        if(f)
+        {
+            fprintf(f, "%ld %g %g\n", k, inertia, silhouette);
+        }
+    }
+    if(f)
+    {
+        fclose(f);
+    }
+    fprintf(stdout, "* Elbow: k = %ld, best silhouette: k = %ld\n", elbow, bestSilhouette);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Prints a node of the cluster tree, and its sub-clusters
+static void printTreeNode(const ClusterTree& tree, const size_t idx)
+{
+    const ClusterTreeNode& node = tree[idx];
+    const Point centroid(0, node.m_centroid);
+    fprintf(stdout, "%*snode %ld: size: %4ld, sse: %g, centroid: %s%s\n", 
+            (int)(2 * node.m_depth), "", idx, node.m_points.size(), node.m_sse, 
+            centroid.toString().c_str(), node.isLeaf() ? " (leaf)" : "");
+    if(!node.isLeaf())
+    {
+        printTreeNode(tree, node.m_children[0]);
+        printTreeNode(tree, node.m_children[1]);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// \brief computeBisectingKMeans Computes the bisecting K-Mean of a data set.
+///
+bool computeBisectingKMeans(const DataSet&          ds,
+                            const size_t            nbLeaves,
+                            const std::string       clusterName,
+                            const size_t            maxIter,
+                            const KMeansMethod      method,
+                            const KMeansTolerance&  tol,
+                            const bool              bVerbose)
+{
+    fprintf(stdout, "* Bisecting K-Means: %ld leaves, method %s\n", nbLeaves, kmeansMethodName(method));
+
+    ClusterTree tree;
+    const size_t nbLeaf = computeBisectingKMeans(ds, nbLeaves, maxIter, method, tol, tree, bVerbose);
+    if(tree.empty())
+    {
+        return false;
+    }
+    fprintf(stdout, "* Cluster tree: %ld nodes, %ld leaves\n", tree.size(), nbLeaf);
+    printTreeNode(tree, 0);
+
+    // the tree: one node per line
+    const std::string treeName = clusterName + ".tree.txt";
+    FILE* f = fopen(treeName.c_str(), "wt");
+    if(f)
+    {
+        fprintf(f, "# node parent child0 child1 depth size sse centroid\n");
+        for(size_t i=0; i<tree.size(); i++)
+        {
+            const ClusterTreeNode& node = tree[i];
+            const Point centroid(0, node.m_centroid);
+            fprintf(f, "%ld %ld %ld %ld %ld %ld %g %s\n", i, 
+                    (long)node.m_parent, (long)node.m_children[0], (long)node.m_children[1],
+                    node.m_depth, node.m_points.size(), node.m_sse, centroid.toString(false).c_str());
+        }
+        fclose(f);
+    }
+
+    // the leaf of each point
+    const std::string leafName = clusterName + ".leaves.txt";
+    f = fopen(leafName.c_str(), "wt");
+    if(f)
+    {
+        fprintf(f, "# pointId node\n");
+        for(size_t i=0; i<tree.size(); i++)
+        {
+            if(!tree[i].isLeaf()) continue;
+            for(size_t p=0; p<tree[i].m_points.size(); p++)
+            {
+                fprintf(f, "%ld %ld\n", tree[i].m_points[p].value(), i);
+            }
+        }
+        fclose(f);
+    }
+    return true;
+}
+
+// number of points assigned at once by a chunk of CentroidAssignTask
+static const size_t CentroidAssignBlock = 4096;
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Assigns each point of a data set to its closest centroid, by chunks, and
+// accumulates the size of each cluster and the (weighted) inertia only: the
+// points are not stored in clusters.
+//
+class CentroidAssignTask : public ParallelTask
+{
+public:
+    CentroidAssignTask(const DataSet&            ds,
+                       const std::vector<Coord>& centroids)
+        :   m_ds(ds)
+        ,   m_centroids(centroids)
+        ,   m_nbCluster(centroids.size() / ds.dim())
+        ,   m_nbChunks(getNbThreads())
+        ,   m_counts(m_nbChunks * m_nbCluster, 0)
+        ,   m_inertia(m_nbChunks, 0.0)
+    {
+        if(m_nbCluster >= BatchAssignMinCentroids)
+        {
+            m_assigner.setCentroids(&m_centroids[0], m_nbCluster, m_ds.dim());
+        }
+    }
+
+    virtual void run(const size_t chunkIdx)
+    {
+        size_t begin = 0;
+        size_t end   = 0;
+        chunkRange(m_ds.size(), m_nbChunks, chunkIdx, begin, end);
+
+        const size_t dim     = m_ds.dim();
+        size_t*      counts  = &m_counts[chunkIdx * m_nbCluster];
+        double       inertia = 0.0;
+
+        std::vector<size_t>       closest(CentroidAssignBlock);
+        std::vector<DistanceType> dist(CentroidAssignBlock);
+        for(size_t first=begin; first<end; first+=CentroidAssignBlock)
+        {
+            const size_t nb = std::min(CentroidAssignBlock, end - first);
+            if(m_nbCluster >= BatchAssignMinCentroids)
+            {
+                // no current centroid: the ties do not depend on the previous block
+                std::fill(closest.begin(), closest.begin() + nb, m_nbCluster);
+                m_assigner.assign(m_ds.coords(first), nb, &closest[0], &dist[0]);
+            }
+            else for(size_t i=0; i<nb; i++)
+            {
+                closest[i] = closestCentroid< FixedDim<0> >(m_ds.coords(first + i), &m_centroids[0],
+                                                            m_nbCluster, dim, dist[i]);
+            }
+            // the exact distances (the ones of the batch assignment are not)
+            for(size_t i=0; i<nb; i++)
+            {
+                const size_t cid = closest[i];
+                counts[cid]++;
+                inertia += m_ds.weight(first + i) * 
+                           coordSquareDistance(m_ds.coords(first + i), &m_centroids[cid * dim], dim);
+            }
+        }
+        m_inertia[chunkIdx] = inertia;
+    }
+
+    // the size of each cluster, returns the inertia
+    double reduce(std::vector<size_t>& counts)const
+    {
+        counts.assign(m_nbCluster, 0);
+        double inertia = 0.0;
+        for(size_t i=0; i<m_nbChunks; i++)
+        {
+            for(size_t cid=0; cid<m_nbCluster; cid++)
+            {
+                counts[cid] += m_counts[i * m_nbCluster + cid];
+            }
+            inertia += m_inertia[i];
+        }
+        return inertia;
+    }
+
+    const DataSet&              m_ds;
+    const std::vector<Coord>&   m_centroids;
+    const size_t                m_nbCluster;
+    const size_t                m_nbChunks;
+    BatchAssigner               m_assigner;
+    std::vector<size_t>         m_counts;
+    std::vector<double>         m_inertia;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// \brief computeCoresetKMeans Computes the K-Mean of a coreset of a data set.
+///
+bool computeCoresetKMeans(const DataSet&          ds,
+                          const size_t            iNbCluster,
+                          const size_t            coresetSize,
+                          const std::string       clusterName,
+                          const size_t            maxIter,
+                          const KMeansMethod      method,
+                          const InitMethod        init,
+                          const KMeansTolerance&  tol,
+                          const bool              bFullAssign,
+                          const bool              bVerbose)
+{
+    if(iNbCluster == 0 || iNbCluster > ds.size())
+    {
+        fprintf(stdout, "Error: cannot compute %ld clusters on %ld points\n", iNbCluster, ds.size());
+        return false;
+    }
+    DataSet coreset;
+    if(buildCoreset(ds, iNbCluster, coresetSize, coreset) < iNbCluster)
+    {
+        fprintf(stdout, "Error: coreset of %ld points for %ld clusters\n", coreset.size(), iNbCluster);
+        return false;
+    }
+    fprintf(stdout, "* Coreset: %ld points (%ld samples), weight %g (data set: %g)\n",
+            coreset.size(), coresetSize, coreset.totalWeight(), ds.totalWeight());
+    coreset.computeSquareNorms();
+
+    const bool printIter     = bVerbose;
+    const bool printSynopsis = false;
+    ClusterSet cs(coreset, iNbCluster);
+    double inertia = computeKMeans(cs, maxIter, printIter, method, init, tol, printSynopsis);
+    if(inertia < 0)
+    {
+        return false;
+    }
+
+    std::vector<Point>  centroids;
+    std::vector<size_t> clusterSize(iNbCluster, 0);
+    bool bFinite = true;
+    for(ClusterId cid=0; cid<iNbCluster; cid++)
+    {
+        centroids.push_back(cs.getCentroid(cid));
+        const Coord* c = cs.getCentroid(cid).data();
+        for(size_t d=0; d<ds.dim(); d++) bFinite = bFinite && std::isfinite(c[d]);
+    }
+
+    if(!bFullAssign)
+    {
+        // the weights of the coreset clusters estimate their sizes
+        for(ClusterId cid=0; cid<iNbCluster; cid++)
+        {
+            clusterSize[cid] = (size_t)(cs.clusterWeight(cid) + 0.5);
+        }
+        fprintf(stdout, "* Coreset inertia (estimate): %g\n", inertia);
+    }
+    else if(!bFinite)
+    {
+        fprintf(stdout, "Error: empty cluster on the coreset, no full assignment\n");
+        return false;
+    }
+    else
+    {
+        // one pass on the data set: each point to its closest centroid
+        std::vector<Coord> coords(iNbCluster * ds.dim());
+        for(ClusterId cid=0; cid<iNbCluster; cid++)
+        {
+            std::copy(centroids[cid].data(), centroids[cid].data() + ds.dim(), &coords[cid * ds.dim()]);
+        }
+        CentroidAssignTask assign(ds, coords);
+        parallelFor(assign, assign.m_nbChunks);
+
+        const double coresetInertia = inertia;
+        inertia = assign.reduce(clusterSize);
+        fprintf(stdout, "* Coreset inertia: %g, data set inertia: %g\n", coresetInertia, inertia);
+    }
+    writeCentroids(centroids, clusterSize, ds.size(), inertia, clusterName);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// \brief computeKMedoids Computes the K-Medoids of a data set.
+///
+void computeKMedoids(const DataSet&          ds,
+                     const size_t            iNbCluster,
+                     const std::string       clusterName,
+                     const size_t            maxIter,
+                     const MedoidMetric      metric,
+                     const size_t            nbSample,
+                     const size_t            sampleSize,
+                     const bool              bVerbose)
+{
+    ClusterSet cs(ds, iNbCluster);
+    const double deviation = computeKMedoids(cs, metric, maxIter, nbSample, sampleSize, bVerbose);
+    if(deviation < 0)
+    {
+        return;
+    }
+    fprintf(stdout, "* K-Medoids: metric %s, deviation %g\n", medoidMetricName(metric), deviation);
+    printClusterSynopsis(cs);
+
+    for(ClusterId cid=0; cid<cs.nbCluster(); cid++)
+    {
+        std::vector<Point> curve;
+
+        std::string curveName = clusterName + ".region." + toString(cid) + ".txt";
+        computeClusterBondary(cs, cid, curve, curveName, bVerbose);
+    }
+    // writes the pointid list for all clusters.
+    for(ClusterId cid=0; cid<cs.nbCluster(); cid++)
+    {
+        std::string fname = "clusterPid" + toString(cid) + ".txt";
+        writeClusterPointIdFile(ds, cs.pointsInCluster(cid), cs.getCentroid(cid), fname, bVerbose);
+    }
+    clustersCreatePlots(cs, clusterName, iNbCluster);
+}
@@ -4,6 +4,11 @@
 #include <string>
 #include <vector>
 #include "DataSet.h"
+#include "ClusterSet.h"
+#include "ClusterFunctions.h"
+#include "KMeansBounds.h"
+#include "KMedoids.h"
+#include "QuantizedDataSet.h"
 
 typedef std::pair<size_t, double> DistPair;
 
@@ -37,13 +42,189 @@ void computeKMeans(const DataSet&       ds,
 /// \param iNbCluster   number of clusster
 /// \param clusterName  cluster name, used to save data files
 /// \param createRegionPlot string: if given a region file will be created.
+/// \param method       the assignment step
+/// \param init         the initial partition of the points
+/// \param tol          the stop rules, before maxIter
+/// \param nbInit       number of independent runs (concurrent, each with
+///                     its own seed): the run of lowest inertia is kept,
+///                     and only its files are written.
+/// \return false on error (no files written)
 ///
-void computeKMeans(const DataSet&       ds,
-                   const size_t         iNbCluster,
-                   const std::string    clusterName,
-                   const size_t         maxIter,
-                   const bool           bVerbose);
+bool computeKMeans(const DataSet&          ds,
+                   const size_t            iNbCluster,
+                   const std::string       clusterName,
+                   const size_t            maxIter,
+                   const bool              bVerbose,
+                   const KMeansMethod      method   = KMeansLloyd,
+                   const InitMethod        init     = RandomPartition,
+                   const KMeansTolerance&  tol      = KMeansTolerance(),
+                   const size_t            nbInit   = 1);
+
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// \brief computeStreamKMeans Computes the K-Mean of a binary data set file,
+///                            read by blocks: the data set is not loaded in
+///                            memory. The centroids are written to the file
+///                            '<clusterName>.centroid.txt'.
+/// \param dsfname      binary data set file
+/// \param iNbCluster   number of clusster
+/// \param clusterName  cluster name, used to save data files
+/// \param maxIter      max number of passes on the data set
+/// \param blockSize    number of points read at once
+/// \param quantize     if not QuantizeNone, the data set is read once and
+///                     kept in memory as int8/int16 codes for the iterations.
+///
+void computeStreamKMeans(const std::string       dsfname,
+                         const size_t            iNbCluster,
+                         const std::string       clusterName,
+                         const size_t            maxIter,
+                         const size_t            blockSize,
+                         const bool              bVerbose,
+                         const QuantizationType  quantize = QuantizeNone);
+
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// \brief computeMiniBatchKMeans Computes the mini-batch K-Mean of a data set:
+///                               each step moves the centroids towards a
+///                               batch of random points, and the points are
+///                               all assigned once, at the end. The centroids
+///                               are written to '<clusterName>.centroid.txt'.
+/// \param ds           Data Set
+/// \param iNbCluster   number of clusster
+/// \param clusterName  cluster name, used to save data files
+/// \param batchSize    number of points of a batch
+/// \param nbStep       number of steps (batches)
+/// \param seed         seed of the random batches
+///
+void computeMiniBatchKMeans(const DataSet&    ds,
+                            const size_t      iNbCluster,
+                            const std::string clusterName,
+                            const size_t      batchSize,
+                            const size_t      nbStep,
+                            const size_t      seed,
+                            const bool        bVerbose);
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// \brief computeMiniBatchStreamKMeans Same, on a binary data set file: only
+///                               the batches are read during the steps, and
+///                               the last assignment is one pass by blocks.
+/// \param dsfname      binary data set file
+/// \param blockSize    number of points read at once, for the last pass
+///
+void computeMiniBatchStreamKMeans(const std::string dsfname,
+                                  const size_t      iNbCluster,
+                                  const std::string clusterName,
+                                  const size_t      batchSize,
+                                  const size_t      nbStep,
+                                  const size_t      seed,
+                                  const size_t      blockSize,
+                                  const bool        bVerbose);
+
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// \brief computeKMeansSweep Computes the K-Mean of each k in [kMin, kMax],
+///                           to pick k. The k are run in parallel, by chains
+///                           of consecutive k warm started from each other.
+///                           Prints the inertia, the elbow of the inertia
+///                           curve and the simplified (centroid) silhouette
+///                           of each k, and writes them to the table
+///                           '<clusterName>.ksweep.txt' (no cluster files).
+/// \param ds           Data Set
+/// \param kMin         first number of clusters
+/// \param kMax         last number of clusters
+/// \param clusterName  cluster name, used to save the table
+/// \param method       the assignment step
+/// \param tol          the stop rules, before maxIter
+/// \return false on error (no table written)
+///
+bool computeKMeansSweep(const DataSet&          ds,
+                        const size_t            kMin,
+                        const size_t            kMax,
+                        const std::string       clusterName,
+                        const size_t            maxIter,
+                        const KMeansMethod      method = KMeansLloyd,
+                        const KMeansTolerance&  tol    = KMeansTolerance());
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// \brief computeBisectingKMeans Computes the bisecting K-Mean of a data set
+///                               (see BisectingKMeans.h): the cluster tree is
+///                               printed, and written to the files
+///                               '<clusterName>.tree.txt' (one node per line)
+///                               and '<clusterName>.leaves.txt' (the leaf of
+///                               each point).
+/// \param ds           Data Set
+/// \param nbLeaves     number of clusters (leaves of the tree)
+/// \param clusterName  cluster name, used to save data files
+/// \param maxIter      max number of iterations of each 2-means
+/// \return false on error (no files written)
+///
+bool computeBisectingKMeans(const DataSet&          ds,
+                            const size_t            nbLeaves,
+                            const std::string       clusterName,
+                            const size_t            maxIter,
+                            const KMeansMethod      method,
+                            const KMeansTolerance&  tol,
+                            const bool              bVerbose);
 
+///////////////////////////////////////////////////////////////////////////////
+///
+/// \brief computeCoresetKMeans Computes the K-Mean of a coreset of the data
+///                             set (see Coreset.h): a weighted sample of
+///                             coresetSize points, whose cost approximates
+///                             the one of the data set. The centroids are
+///                             written to '<clusterName>.centroid.txt'.
+/// \param ds           Data Set
+/// \param iNbCluster   number of clusster
+/// \param coresetSize  number of samples of the coreset
+/// \param clusterName  cluster name, used to save data files
+/// \param maxIter      max number of iterations, on the coreset
+/// \param method       the assignment step
+/// \param init         the initial partition of the coreset points
+/// \param tol          the stop rules, before maxIter
+/// \param bFullAssign  if true, a last pass assigns the points of the data
+///                     set to the centroids, for their exact cluster sizes
+///                     and inertia. Otherwise, the sizes and the inertia
+///                     are the estimates of the coreset.
+/// \return false on error (no files written)
+///
+bool computeCoresetKMeans(const DataSet&          ds,
+                          const size_t            iNbCluster,
+                          const size_t            coresetSize,
+                          const std::string       clusterName,
+                          const size_t            maxIter,
+                          const KMeansMethod      method,
+                          const InitMethod        init,
+                          const KMeansTolerance&  tol,
+                          const bool              bFullAssign,
+                          const bool              bVerbose);
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// \brief computeKMedoids Computes the K-Medoids of a data set (see
+///                        KMedoids.h): the centroids are points of the data
+///                        set, for any metric. The clusters are printed and
+///                        written as the ones of computeKMeans.
+/// \param ds           Data Set
+/// \param iNbCluster   number of clusster
+/// \param clusterName  cluster name, used to save data files
+/// \param maxIter      max number of FasterPAM passes
+/// \param metric       the dissimilarity
+/// \param nbSample     number of CLARA samples (0: automatic)
+/// \param sampleSize   points per CLARA sample (0: automatic)
+///
+void computeKMedoids(const DataSet&          ds,
+                     const size_t            iNbCluster,
+                     const std::string       clusterName,
+                     const size_t            maxIter,
+                     const MedoidMetric      metric,
+                     const size_t            nbSample,
+                     const size_t            sampleSize,
+                     const bool              bVerbose);
 
 ///////////////////////////////////////////////////////////////////////////////
 ///
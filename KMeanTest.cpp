@@ -1,14 +1,599 @@
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <cmath>
+#include <limits>
 #include <memory>
 
+#include "BatchAssigner.h"
 #include "ClusterFunctions.h"
 #include "ClusterSet.h"
+#include "Coreset.h"
+#include "Distance.h"
 #include "KMean.h"
 #include "KMeanTest.h"
+#include "KMedoids.h"
+#include "Random.h"
 
 
+////////////////////////////////////////////////////////////////////////////////
+// the K-Means of a cluster set with some initial centroids, or a random
+// partition
+static void runKMeans(ClusterSet&               cs,
+                      const KMeansMethod        method,
+                      const std::vector<Point>& centroids,
+                      const size_t              seed)
+{
+    srand(seed);
+    for(ClusterId cid=0; cid<centroids.size(); cid++)
+    {
+        cs.getCentroid(cid) = centroids[cid];
+    }
+    const size_t maxIter       = 100;
+    const bool   printIter     = false;
+    const bool   printSynopsis = false;
+    computeKMeans(cs, maxIter, printIter, method, centroids.empty() ? RandomPartition : CurrentCentroids,
+                  KMeansTolerance(), printSynopsis);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// the Lloyd iterations by the exact point by point scan (the current cluster
+// wins the ties), from the initial partition of runKMeans: the cluster of
+// each point
+static std::vector<size_t> runExactLloyd(ClusterSet&               cs,
+                                         const std::vector<Point>& centroids,
+                                         const size_t              seed)
+{
+    srand(seed);
+    for(ClusterId cid=0; cid<centroids.size(); cid++)
+    {
+        cs.getCentroid(cid) = centroids[cid];
+    }
+    cs.initial_partition_points(centroids.empty() ? RandomPartition : CurrentCentroids);
+
+    const DataSet& ds      = cs.dataSet();
+    const size_t   dim     = ds.dim();
+    const size_t   k       = cs.nbCluster();
+    const size_t   maxIter = 100;
+    std::vector<size_t> cluster(ds.size());
+    for(size_t i=0; i<ds.size(); i++)
+    {
+        cluster[i] = cs.clusterContainingPoint(PointId(i));
+    }
+    for(size_t iter=0; iter<=maxIter; iter++)
+    {
+        // the centroids of the clusters (empty: not a number, never closest)
+        std::vector<double> sums(k * dim, 0.0);
+        std::vector<size_t> sizes(k, 0);
+        for(size_t i=0; i<ds.size(); i++)
+        {
+            for(size_t d=0; d<dim; d++) sums[cluster[i] * dim + d] += ds.coords(i)[d];
+            sizes[cluster[i]]++;
+        }
+        std::vector<Coord> means(k * dim);
+        for(size_t j=0; j<k * dim; j++)
+        {
+            means[j] = (Coord)(sums[j] / sizes[j / dim]);
+        }
+
+        size_t nbMove = 0;
+        for(size_t i=0; i<ds.size(); i++)
+        {
+            const size_t from = cluster[i];
+            DistanceType best = coordSquareDistance(ds.coords(i), &means[from * dim], dim);
+            for(size_t cid=0; cid<k; cid++)
+            {
+                const DistanceType dist = coordSquareDistance(ds.coords(i), &means[cid * dim], dim);
+                if(cid != from && dist < best)
+                {
+                    best       = dist;
+                    cluster[i] = cid;
+                }
+            }
+            if(cluster[i] != from) nbMove++;
+        }
+        if(nbMove == 0) break;
+    }
+    return cluster;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Lloyd (batch assignment from 16 clusters), the bounded assignments
+// (Elkan, Hamerly, Yinyang) and the kd-tree filtering must give the clusters
+// of the exact Lloyd iterations, with empty clusters: a centroid set twice
+// (its copy never gets a point), and random partitions of many blobs
+// (clusters empty during the iterations).
+//
+static bool testEmptyClusterMethods( )
+{
+    const size_t nbBlob   = 30;
+    const size_t blobSize = 200;
+
+    DataSet ds;
+    srand(7);
+    for(size_t b=0; b<nbBlob; b++)
+    {
+        const double x = randomValue(-100.0, 100.0);
+        const double y = randomValue(-100.0, 100.0);
+        for(size_t i=0; i<blobSize; i++)
+        {
+            Point::CoordVector coords(2);
+            coords[0] = randomNormal(x, 2.0);
+            coords[1] = randomNormal(y, 2.0);
+            ds.addPoint(coords);
+        }
+    }
+
+    // the first point of each blob, the last one twice
+    std::vector<Point> twice;
+    for(size_t b=0; b<nbBlob; b++)
+    {
+        twice.push_back(ds[b * blobSize]);
+    }
+    twice.push_back(ds[(nbBlob - 1) * blobSize]);
+    ds.computeKdTree();
+
+    const KMeansMethod methods[] = { KMeansLloyd, KMeansElkan, KMeansHamerly, KMeansYinyang, KMeansFilter };
+    bool bOk = true;
+    for(size_t run=0; run<=10; run++)
+    {
+        const std::vector<Point> centroids = (run == 0) ? twice : std::vector<Point>();
+        const size_t             k         = (run == 0) ? twice.size() : nbBlob;
+
+        ClusterSet                exact(ds, k);
+        const std::vector<size_t> reference = runExactLloyd(exact, centroids, run);
+        std::vector<size_t>       sizes(k, 0);
+        for(size_t i=0; i<ds.size(); i++) sizes[reference[i]]++;
+        const size_t nbEmpty = std::count(sizes.begin(), sizes.end(), (size_t)0);
+
+        for(size_t m=0; m<sizeof(methods)/sizeof(methods[0]); m++)
+        {
+            ClusterSet cs(ds, k);
+            runKMeans(cs, methods[m], centroids, run);
+            size_t nbDiff = 0;
+            for(size_t i=0; i<ds.size(); i++)
+            {
+                if(cs.clusterContainingPoint(PointId(i)) != reference[i]) nbDiff++;
+            }
+            fprintf(stdout, "  run %ld, %ld empty clusters: %s, %ld points in another cluster than the exact Lloyd: %s\n",
+                    run, nbEmpty, kmeansMethodName(methods[m]), nbDiff, nbDiff ? "FAILED" : "ok");
+            bOk = bOk && nbDiff == 0;
+        }
+    }
+    return bOk;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// The same, far from the origin: 8-D overlapping blobs offset by 1e6 and
+// 1e7, with few clusters (point by point Lloyd) and many clusters (batch
+// Lloyd).
+//
+static bool testOffsetMethods( )
+{
+    const size_t dim      = 8;
+    const size_t nbBlob   = 20;
+    const size_t blobSize = 500;
+
+    const KMeansMethod methods[] = { KMeansLloyd, KMeansElkan, KMeansHamerly, KMeansYinyang, KMeansFilter };
+    const double       offsets[] = { 1.0e6, 1.0e7 };
+    const size_t       ks[]      = { 10, 24 };
+    bool bOk = true;
+    for(size_t o=0; o<sizeof(offsets)/sizeof(offsets[0]); o++)
+    {
+        DataSet ds;
+        srand(5);
+        for(size_t b=0; b<nbBlob; b++)
+        {
+            std::vector<double> center(dim);
+            for(size_t d=0; d<dim; d++) center[d] = offsets[o] + randomValue(-5.0, 5.0);
+            for(size_t i=0; i<blobSize; i++)
+            {
+                Point::CoordVector coords(dim);
+                for(size_t d=0; d<dim; d++) coords[d] = randomNormal(center[d], 1.0);
+                ds.addPoint(coords);
+            }
+        }
+        // as main: the cached norms, and the kd-tree of the filtering
+        ds.computeSquareNorms();
+        ds.computeKdTree();
+
+        for(size_t i=0; i<sizeof(ks)/sizeof(ks[0]); i++)
+        {
+            const size_t              k = ks[i];
+            ClusterSet                exact(ds, k);
+            const std::vector<size_t> reference = runExactLloyd(exact, std::vector<Point>(), i);
+
+            for(size_t m=0; m<sizeof(methods)/sizeof(methods[0]); m++)
+            {
+                ClusterSet cs(ds, k);
+                runKMeans(cs, methods[m], std::vector<Point>(), i);
+                size_t nbDiff = 0;
+                for(size_t pid=0; pid<ds.size(); pid++)
+                {
+                    if(cs.clusterContainingPoint(PointId(pid)) != reference[pid]) nbDiff++;
+                }
+                fprintf(stdout, "  offset %g, k %ld: %s, %ld points in another cluster than the exact Lloyd: %s\n",
+                        offsets[o], k, kmeansMethodName(methods[m]), nbDiff, nbDiff ? "FAILED" : "ok");
+                bOk = bOk && nbDiff == 0;
+            }
+        }
+    }
+    return bOk;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// The batch assignment must give the assignment of the point by point scan
+// (the current centroid wins the ties) and its exact distances, far from the
+// origin, with points half way between two centroids.
+//
+static bool testBatchAssignOffset( )
+{
+    const size_t dim      = 8;
+    const size_t nbPoints = 2000;
+    const size_t k        = 20;
+    const double offsets[] = { 0.0, 1.0e6, 1.0e8 };
+
+    bool bOk = true;
+    srand(11);
+    for(size_t o=0; o<sizeof(offsets)/sizeof(offsets[0]); o++)
+    {
+        std::vector<Coord> centroids(k * dim);
+        for(size_t i=0; i<centroids.size(); i++)
+        {
+            centroids[i] = (Coord)(offsets[o] + randomValue(-10.0, 10.0));
+        }
+        std::vector<Coord> points(nbPoints * dim);
+        for(size_t pid=0; pid<nbPoints; pid++)
+        {
+            const Coord* a = &centroids[(pid % k) * dim];
+            const Coord* b = &centroids[((pid + 1) % k) * dim];
+            for(size_t d=0; d<dim; d++)
+            {
+                // one point out of 4 half way between two centroids
+                points[pid * dim + d] = (pid % 4 == 0) ? (Coord)(0.5 * a[d] + 0.5 * b[d])
+                                                       : (Coord)(a[d] + randomNormal(0.0, 3.0));
+            }
+        }
+
+        BatchAssigner assigner;
+        assigner.setCentroids(&centroids[0], k, dim);
+        std::vector<size_t>       closest(nbPoints);
+        std::vector<DistanceType> minDist(nbPoints);
+        for(size_t pid=0; pid<nbPoints; pid++) closest[pid] = randomInteger() % k;
+        const std::vector<size_t> current = closest;
+        assigner.assign(&points[0], nbPoints, &closest[0], &minDist[0]);
+
+        size_t nbDiff = 0;
+        for(size_t pid=0; pid<nbPoints; pid++)
+        {
+            const Coord* p    = &points[pid * dim];
+            size_t       to   = current[pid];
+            DistanceType best = coordSquareDistance(p, &centroids[to * dim], dim);
+            for(size_t cid=0; cid<k; cid++)
+            {
+                const DistanceType dist = coordSquareDistance(p, &centroids[cid * dim], dim);
+                if(dist < best)
+                {
+                    best = dist;
+                    to   = cid;
+                }
+            }
+            if(closest[pid] != to || minDist[pid] != best) nbDiff++;
+        }
+        fprintf(stdout, "  offset %g: %ld points with another centroid or distance than the scan: %s\n",
+                offsets[o], nbDiff, nbDiff ? "FAILED" : "ok");
+        bOk = bOk && nbDiff == 0;
+    }
+    return bOk;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// The weighted K-Means of the distinct points (see aggregateDuplicates) must
+// give the clusters and the inertia of the K-Means of all the points.
+//
+static bool testDedupWeights( )
+{
+    const size_t nbDistinct = 500;
+    const size_t k          = 8;
+
+    // the copies of a point are consecutive: the distinct point j is the
+    // first copy of the j-th point
+    DataSet all;
+    std::vector<size_t> distinctOf;
+    srand(3);
+    for(size_t j=0; j<nbDistinct; j++)
+    {
+        Point::CoordVector coords(2);
+        coords[0] = randomNormal(20.0 * (j % 4), 6.0);
+        coords[1] = randomNormal(20.0 * (j % 3), 6.0);
+        const size_t nbCopy = 1 + randomInteger() % 4;
+        for(size_t c=0; c<nbCopy; c++)
+        {
+            all.addPoint(coords);
+            distinctOf.push_back(j);
+        }
+    }
+    DataSet unique;
+    all.aggregateDuplicates(unique);
+
+    std::vector<Point> centroids;
+    for(size_t cid=0; cid<k; cid++)
+    {
+        centroids.push_back(unique[cid * 7]);
+    }
+
+    const KMeansMethod methods[] = { KMeansLloyd, KMeansElkan };
+    bool bOk = unique.size() == nbDistinct;
+    for(size_t m=0; m<sizeof(methods)/sizeof(methods[0]); m++)
+    {
+        ClusterSet full(all, k);
+        ClusterSet dedup(unique, k);
+        runKMeans(full,  methods[m], centroids, 0);
+        runKMeans(dedup, methods[m], centroids, 0);
+
+        size_t nbDiff = 0;
+        for(size_t i=0; i<all.size(); i++)
+        {
+            if(full.clusterContainingPoint(PointId(i)) != dedup.clusterContainingPoint(PointId(distinctOf[i]))) nbDiff++;
+        }
+        const double inertia  = computeInertia(full);
+        const double weighted = computeInertia(dedup);
+        const bool   bSame    = nbDiff == 0 && unique.size() == nbDistinct &&
+                                std::fabs(inertia - weighted) <= 1e-6 * inertia;
+        fprintf(stdout, "  %s: %ld points, %ld distinct, %ld points in another cluster, inertia %g / %g: %s\n",
+                kmeansMethodName(methods[m]), all.size(), unique.size(), nbDiff, inertia, weighted,
+                bSame ? "ok" : "FAILED");
+        bOk = bOk && bSame;
+    }
+    return bOk;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// The csv parser: quoted fields, CRLF and LF lines, blanks, tokens longer
+// than a small buffer, a blank trailing line, and a file of a few chunks
+// (the chunk boundaries fall in the middle of the lines).
+//
+static bool testCsvParser( )
+{
+    const std::string fname    = "parser.csv";
+    const size_t      nbPoints = 40000;
+    const std::string zeros(200, '0');
+
+    FILE* f = fopen(fname.c_str(), "wt");
+    if(!f)
+    {
+        fprintf(stdout, "  cannot write '%s': FAILED\n", fname.c_str());
+        return false;
+    }
+    for(size_t i=0; i<nbPoints; i++)
+    {
+        switch(i % 4)
+        {
+            case 0: fprintf(f, "%ld.25,%ld.5\r\n",         i, i);                break;
+            case 1: fprintf(f, "\"%ld.25\",\"%ld.5\"\r\n", i, i);                break;
+            case 2: fprintf(f, " %ld.25 , \"%ld.5\" \n",    i, i);                break;
+            case 3: fprintf(f, "%ld.25%s,%ld.5%s\n",      i, zeros.c_str(), i, zeros.c_str()); break;
+        }
+    }
+    fprintf(f, "\r\n");
+    const long size = ftell(f);
+    fclose(f);
+
+    DataSet ds;
+    bool bOk = ds.read(fname) && ds.size() == nbPoints && ds.dim() == 2;
+    size_t nbDiff = 0;
+    for(size_t i=0; bOk && i<nbPoints; i++)
+    {
+        const Coord* c = ds.coords(i);
+        if(c[0] != (Coord)(i + 0.25) || c[1] != (Coord)(i + 0.5)) nbDiff++;
+    }
+    bOk = bOk && nbDiff == 0;
+    fprintf(stdout, "  %ld bytes, %ld points read, %ld points with other values: %s\n",
+            size, ds.size(), nbDiff, bOk ? "ok" : "FAILED");
+    remove(fname.c_str());
+    return bOk;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// A data set written in binary, and read back: the file is mapped without
+// copy, with the same points and range. Read in a non empty data set, the
+// points are copied after the existing ones.
+//
+static bool testBinaryRoundTrip( )
+{
+    const std::string fname    = "roundtrip.bin";
+    const size_t      nbPoints = 1001;
+    const size_t      dim      = 5;
+
+    DataSet ds;
+    srand(9);
+    for(size_t i=0; i<nbPoints; i++)
+    {
+        Point::CoordVector coords(dim);
+        for(size_t d=0; d<dim; d++) coords[d] = randomValue(-1.0e3, 1.0e3);
+        ds.addPoint(coords);
+    }
+    bool bOk = ds.writeBinary(fname) && DataSet::isBinaryFile(fname);
+
+    DataSet mapped;
+    bOk = bOk && mapped.read(fname) && mapped.isMapped() &&
+          mapped.size() == nbPoints && mapped.dim() == dim;
+    size_t nbDiff = 0;
+    for(size_t i=0; bOk && i<nbPoints; i++)
+    {
+        if(!std::equal(ds.coords(i), ds.coords(i) + dim, mapped.coords(i))) nbDiff++;
+    }
+    std::vector<Coord> minCoord, maxCoord, mappedMin, mappedMax;
+    ds.range(minCoord, maxCoord);
+    if(bOk) mapped.range(mappedMin, mappedMax);
+    bOk = bOk && nbDiff == 0 && minCoord == mappedMin && maxCoord == mappedMax;
+
+    // the copy path: after the points of a data set
+    DataSet twice;
+    bOk = bOk && twice.read(fname) && twice.read(fname) && !twice.isMapped() && twice.size() == 2 * nbPoints;
+    for(size_t i=0; bOk && i<nbPoints; i++)
+    {
+        if(!std::equal(ds.coords(i), ds.coords(i) + dim, twice.coords(nbPoints + i))) nbDiff++;
+    }
+    bOk = bOk && nbDiff == 0;
+    fprintf(stdout, "  %ld points, dim %ld, mapped: %s, %ld points with other values: %s\n",
+            mapped.size(), mapped.dim(), mapped.isMapped() ? "yes" : "no", nbDiff, bOk ? "ok" : "FAILED");
+    remove(fname.c_str());
+    return bOk;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// the (weighted) k-means cost of a data set, for some centroids
+static double kmeansCost(const DataSet& ds, const std::vector<Coord>& centroids)
+{
+    const size_t dim = ds.dim();
+    double cost = 0.0;
+    for(size_t i=0; i<ds.size(); i++)
+    {
+        DistanceType best = std::numeric_limits<DistanceType>::max();
+        for(size_t c=0; c<centroids.size(); c+=dim)
+        {
+            best = std::min(best, coordSquareDistance(ds.coords(i), &centroids[c], dim));
+        }
+        cost += ds.weight(i) * best;
+    }
+    return cost;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// The cost of a coreset approximates the one of the data set, for the
+// centroids of its K-Means and for random centroids, and so does its weight
+// (both are unbiased estimates). No coreset K-Means for k = 0.
+//
+static bool testCoreset( )
+{
+    const size_t nbBlob      = 5;
+    const size_t blobSize    = 4000;
+    const size_t k           = 5;
+    const size_t coresetSize = 2000;
+    const double maxError    = 0.1;
+
+    DataSet ds;
+    srand(13);
+    for(size_t b=0; b<nbBlob; b++)
+    {
+        const double x = randomValue(-50.0, 50.0);
+        const double y = randomValue(-50.0, 50.0);
+        for(size_t i=0; i<blobSize; i++)
+        {
+            Point::CoordVector coords(2);
+            coords[0] = randomNormal(x, 5.0);
+            coords[1] = randomNormal(y, 5.0);
+            ds.addPoint(coords);
+        }
+    }
+    DataSet coreset;
+    buildCoreset(ds, k, coresetSize, coreset);
+
+    // the centroids of the K-Means of the data set, and random points
+    std::vector<std::vector<Coord> > solutions(2);
+    ClusterSet cs(ds, k);
+    runKMeans(cs, KMeansLloyd, std::vector<Point>(), 1);
+    for(ClusterId cid=0; cid<k; cid++)
+    {
+        const Coord* c = cs.getCentroid(cid).data();
+        solutions[0].insert(solutions[0].end(), c, c + 2);
+        const Coord* p = ds.coords(randomInteger() % ds.size());
+        solutions[1].insert(solutions[1].end(), p, p + 2);
+    }
+
+    const double weightError = std::fabs(coreset.totalWeight() - ds.totalWeight()) / ds.totalWeight();
+    bool bOk = coreset.size() > 0 && coreset.size() <= coresetSize && weightError <= maxError;
+    for(size_t s=0; s<solutions.size(); s++)
+    {
+        const double cost  = kmeansCost(ds, solutions[s]);
+        const double error = std::fabs(kmeansCost(coreset, solutions[s]) - cost) / cost;
+        fprintf(stdout, "  %s centroids: %ld coreset points, weight %g / %g, cost error %.4f: %s\n",
+                s == 0 ? "K-Means" : "random", coreset.size(), coreset.totalWeight(), ds.totalWeight(),
+                error, (bOk && error <= maxError) ? "ok" : "FAILED");
+        bOk = bOk && error <= maxError;
+    }
+
+    DataSet empty;
+    const bool bRejected = buildCoreset(ds, 0, coresetSize, empty) == 0 &&
+                           !computeCoresetKMeans(ds, 0, coresetSize, "coreset", 10, KMeansLloyd,
+                                                 KMeansPlusPlus, KMeansTolerance(), false, false);
+    fprintf(stdout, "  k = 0 rejected: %s\n", bRejected ? "ok" : "FAILED");
+    return bOk && bRejected;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// On a small data set, the K-Medoids by FasterPAM and by CLARA against the
+// optimal medoids (all the combinations of k points), and the CLARA
+// sample size capped to KMedoidsMaxExactPoints.
+//
+static bool testKMedoids( )
+{
+    const size_t       nbBlob   = 3;
+    const size_t       blobSize = 12;
+    const size_t       k        = 3;
+    const MedoidMetric metric   = MedoidEuclidean;
+
+    DataSet ds;
+    srand(17);
+    for(size_t b=0; b<nbBlob; b++)
+    {
+        const double x = randomValue(-20.0, 20.0);
+        const double y = randomValue(-20.0, 20.0);
+        for(size_t i=0; i<blobSize; i++)
+        {
+            Point::CoordVector coords(2);
+            coords[0] = randomNormal(x, 3.0);
+            coords[1] = randomNormal(y, 3.0);
+            ds.addPoint(coords);
+        }
+    }
+
+    // the optimal deviation
+    const size_t nb      = ds.size();
+    double       optimal = std::numeric_limits<double>::max();
+    for(size_t m0=0; m0<nb; m0++)
+    for(size_t m1=m0+1; m1<nb; m1++)
+    for(size_t m2=m1+1; m2<nb; m2++)
+    {
+        double deviation = 0.0;
+        for(size_t i=0; i<nb; i++)
+        {
+            deviation += std::min(medoidDistance(metric, ds.coords(i), ds.coords(m0), 2),
+                         std::min(medoidDistance(metric, ds.coords(i), ds.coords(m1), 2),
+                                  medoidDistance(metric, ds.coords(i), ds.coords(m2), 2)));
+        }
+        optimal = std::min(optimal, deviation);
+    }
+
+    // FasterPAM on all the points, and CLARA on samples of 2/3 of the points
+    srand(1);
+    ClusterSet exact(ds, k);
+    const double pam = computeKMedoids(exact, metric, 100);
+    srand(1);
+    ClusterSet sampled(ds, k);
+    const double clara = computeKMedoids(sampled, metric, 100, 5, 2 * nb / 3);
+
+    const bool bPam   = pam >= 0 && std::fabs(pam - optimal) <= 1e-5 * optimal;
+    const bool bClara = clara >= 0 && clara >= optimal * (1.0 - 1e-5) && clara <= optimal * 1.1;
+    fprintf(stdout, "  FasterPAM deviation %g, optimal %g: %s\n", pam, optimal, bPam ? "ok" : "FAILED");
+    fprintf(stdout, "  CLARA deviation %g, optimal %g: %s\n", clara, optimal, bClara ? "ok" : "FAILED");
+
+    const bool bCap = claraSampleSize(k, 10 * KMedoidsMaxExactPoints) == KMedoidsMaxExactPoints &&
+                      claraSampleSize(k, 2 * nb / 3) == 2 * nb / 3 &&
+                      claraSampleSize(KMedoidsMaxExactPoints, 0) == KMedoidsMaxExactPoints;
+    fprintf(stdout, "  CLARA sample size capped to %ld points: %s\n", KMedoidsMaxExactPoints, bCap ? "ok" : "FAILED");
+    return bPam && bClara && bCap;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 int KMeanTest(const int argc, const char** argv)
@@ -76,8 +661,40 @@ int KMeanTest(const int argc, const char** argv)
         computeKMeans(ds,"clusterPid1.txt", 2, clusterFile2, maxIter , bVerbose);
     }
 
+    fprintf(stdout, "****************************************************************\n");
+    fprintf(stdout, "** K-Means methods with empty clusters, against Lloyd\n");
+    bool bOk = testEmptyClusterMethods();
+
+    fprintf(stdout, "****************************************************************\n");
+    fprintf(stdout, "** Batch assignment of offset points, against the point by point scan\n");
+    bOk = testBatchAssignOffset() && bOk;
+
+    fprintf(stdout, "****************************************************************\n");
+    fprintf(stdout, "** K-Means methods on offset points, against Lloyd\n");
+    bOk = testOffsetMethods() && bOk;
+
+    fprintf(stdout, "****************************************************************\n");
+    fprintf(stdout, "** Weighted K-Means of the distinct points, against all the points\n");
+    bOk = testDedupWeights() && bOk;
+
+    fprintf(stdout, "****************************************************************\n");
+    fprintf(stdout, "** Csv parser\n");
+    bOk = testCsvParser() && bOk;
+
+    fprintf(stdout, "****************************************************************\n");
+    fprintf(stdout, "** Binary data set round trip\n");
+    bOk = testBinaryRoundTrip() && bOk;
+
+    fprintf(stdout, "****************************************************************\n");
+    fprintf(stdout, "** Coreset cost\n");
+    bOk = testCoreset() && bOk;
+
+    fprintf(stdout, "****************************************************************\n");
+    fprintf(stdout, "** K-Medoids\n");
+    bOk = testKMedoids() && bOk;
+
     fprintf(stdout, "\n\nend.\n");
-    return 0;
+    return bOk ? 0 : 1;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,675 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdio.h>
+
+#include "FixedPoint.h"
+#include "KMeansBounds.h"
+
+// Yinyang: about 10 centroids per group, and at most this number of groups
+static const size_t YinyangGroupSize = 10;
+static const size_t YinyangMaxGroups = 256;
+
+// Yinyang: number of iterations of the k-means that groups the centroids
+static const size_t YinyangGroupIter = 5;
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// The centroids of the current iteration, and the distance each centroid
+// moved since the previous iteration (its drift). The bounds are shifted by
+// the drifts at each iteration.
+//
+// A bound on the distance to a centroid c can also be stored relative to
+// the total drift of c (the sum of its drifts): b - total(c) is updated
+// without any work when c moves, and it is still a bound once the total
+// drift is added back.
+//
+template<class Dim>
+class CentroidBounds : public KMeansBounds
+{
+///////////////////////////////////////////////////////////////////////////////
+    public:
+///////////////////////////////////////////////////////////////////////////////
+
+    CentroidBounds(const size_t nbPoints, const size_t nbCentroid, const size_t dim)
+        :   m_nbPoints(nbPoints)
+        ,   m_nbCentroid(nbCentroid)
+        ,   m_dim(dim)
+        ,   m_bFirst(true)
+        ,   m_drift(nbCentroid, 0.0)
+        ,   m_totalDrift(nbCentroid, 0.0)
+    { }
+
+    virtual void setCentroids(const Coord* centroids)
+    {
+        m_bFirst = m_centroids.empty();
+        if(!m_bFirst)
+        {
+            for(size_t cid=0; cid<m_nbCentroid; cid++)
+            {
+                m_drift[cid] = sqrt(Dim::squareDistance(centroid(cid), centroids + cid * m_dim, m_dim));
+                m_totalDrift[cid] += m_drift[cid];
+            }
+        }
+        m_centroids.assign(centroids, centroids + m_nbCentroid * m_dim);
+    }
+
+///////////////////////////////////////////////////////////////////////////////
+    protected:
+///////////////////////////////////////////////////////////////////////////////
+
+    const Coord*            centroid            (const size_t cid)      const
+    { return &m_centroids[cid * m_dim]; }
+
+    DistanceType            squareDistance      (const Coord* p,
+                                                 const size_t cid)      const
+    { return Dim::squareDistance(p, centroid(cid), m_dim); }
+
+    const size_t                m_nbPoints                                    ;
+    const size_t                m_nbCentroid                                  ;
+    const size_t                m_dim                                         ;
+
+    // true until the first assignment: no bounds yet
+    bool                        m_bFirst                                      ;
+
+    std::vector<Coord>          m_centroids                                   ;
+    std::vector<DistanceType>   m_drift                                       ;
+    std::vector<DistanceType>   m_totalDrift                                  ;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Elkan: one upper bound u(x) >= d(x, a(x)) and one lower bound per
+// centroid l(x,c) <= d(x, c) for each point, and the centroid to centroid
+// distances. A centroid c cannot be closer than a(x) when:
+//
+//      u(x) <= l(x,c)   or   u(x) <= d(a(x), c) / 2
+//
+// and no centroid is when u(x) <= s(a(x)), half the distance of a(x) to its
+// closest other centroid.
+//
+// The bounds are stored relative to the total drift of their centroid, so
+// a point that keeps its centroid without any distance costs O(1).
+//
+// Memory: nbPoints x nbCentroid bounds.
+//
+template<class Dim>
+class ElkanBounds : public CentroidBounds<Dim>
+{
+    typedef CentroidBounds<Dim> Base;
+    using Base::m_nbPoints;
+    using Base::m_nbCentroid;
+    using Base::m_dim;
+    using Base::m_bFirst;
+    using Base::m_totalDrift;
+
+///////////////////////////////////////////////////////////////////////////////
+    public:
+///////////////////////////////////////////////////////////////////////////////
+
+    ElkanBounds(const size_t nbPoints, const size_t nbCentroid, const size_t dim)
+        :   Base(nbPoints, nbCentroid, dim)
+        ,   m_upper(nbPoints)
+        ,   m_lower(nbPoints * nbCentroid)
+        ,   m_halfDist(nbCentroid * nbCentroid)
+        ,   m_halfMin(nbCentroid)
+    { }
+
+    virtual void setCentroids(const Coord* centroids)
+    {
+        Base::setCentroids(centroids);
+
+        // half the centroid to centroid distances
+        std::fill(m_halfMin.begin(), m_halfMin.end(), std::numeric_limits<DistanceType>::max());
+        for(size_t i=0; i<m_nbCentroid; i++)
+        {
+            m_halfDist[i * m_nbCentroid + i] = 0;
+            for(size_t j=i+1; j<m_nbCentroid; j++)
+            {
+                const DistanceType half = 0.5 * sqrt(this->squareDistance(this->centroid(i), j));
+                m_halfDist[i * m_nbCentroid + j] = half;
+                m_halfDist[j * m_nbCentroid + i] = half;
+                if(half < m_halfMin[i]) m_halfMin[i] = half;
+                if(half < m_halfMin[j]) m_halfMin[j] = half;
+            }
+        }
+    }
+
+    virtual void assign(const Coord* const* points,
+                        const size_t        begin,
+                        const size_t        end,
+                        size_t*             closest)
+    {
+        for(size_t idx=begin; idx<end; idx++)
+        {
+            const Coord*  p     = points[idx];
+            DistanceType* lower = &m_lower[idx * m_nbCentroid];
+            size_t        a     = closest[idx];
+
+            if(m_bFirst)
+            {
+                // all the distances
+                DistanceType aSquare = this->squareDistance(p, a);
+                for(size_t cid=0; cid<m_nbCentroid; cid++)
+                {
+                    const DistanceType square = (cid == a) ? aSquare : this->squareDistance(p, cid);
+                    lower[cid] = sqrt(square);
+                    if(square < aSquare)
+                    {
+                        aSquare = square;
+                        a       = cid;
+                    }
+                }
+                m_upper[idx] = lower[a];
+                closest[idx] = a;
+                continue;
+            }
+
+            // the bounds follow the centroids
+            DistanceType upper = m_upper[idx] + m_totalDrift[a];
+            if(upper <= m_halfMin[a]) continue;
+
+            bool         bTight  = false;
+            DistanceType aSquare = 0;
+            for(size_t cid=0; cid<m_nbCentroid; cid++)
+            {
+                if(cid == a) continue;
+                if(upper <= lower[cid] - m_totalDrift[cid] || 
+                   upper <= m_halfDist[a * m_nbCentroid + cid]) continue;
+
+                // the upper bound is made exact, once
+                if(!bTight)
+                {
+                    aSquare  = this->squareDistance(p, a);
+                    upper    = sqrt(aSquare);
+                    lower[a] = upper + m_totalDrift[a];
+                    bTight   = true;
+                    if(upper <= lower[cid] - m_totalDrift[cid] || 
+                       upper <= m_halfDist[a * m_nbCentroid + cid]) continue;
+                }
+
+                const DistanceType square = this->squareDistance(p, cid);
+                const DistanceType dist   = sqrt(square);
+                lower[cid] = dist + m_totalDrift[cid];
+                if(square < aSquare)
+                {
+                    aSquare = square;
+                    upper   = dist;
+                    a       = cid;
+                }
+            }
+            m_upper[idx] = upper - m_totalDrift[a];
+            closest[idx] = a;
+        }
+    }
+
+///////////////////////////////////////////////////////////////////////////////
+    private:
+///////////////////////////////////////////////////////////////////////////////
+
+    std::vector<DistanceType>   m_upper                                       ;
+    std::vector<DistanceType>   m_lower                                       ;
+    std::vector<DistanceType>   m_halfDist                                    ;
+    std::vector<DistanceType>   m_halfMin                                     ;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Hamerly: one upper bound u(x) >= d(x, a(x)), and one lower bound
+// l(x) <= d(x, c) for all the other centroids c. The point keeps its
+// centroid when:
+//
+//      u(x) <= max(l(x), s(a(x)))
+//
+// where s(a) is half the distance of a to its closest other centroid.
+// Otherwise all the distances of the point are computed. The lower bound
+// follows the largest drift of the other centroids.
+//
+// Memory: 2 bounds per point. Best in low dimension, with a moderate
+// number of centroids.
+//
+template<class Dim>
+class HamerlyBounds : public CentroidBounds<Dim>
+{
+    typedef CentroidBounds<Dim> Base;
+    using Base::m_nbCentroid;
+    using Base::m_bFirst;
+    using Base::m_drift;
+
+///////////////////////////////////////////////////////////////////////////////
+    public:
+///////////////////////////////////////////////////////////////////////////////
+
+    HamerlyBounds(const size_t nbPoints, const size_t nbCentroid, const size_t dim)
+        :   Base(nbPoints, nbCentroid, dim)
+        ,   m_upper(nbPoints)
+        ,   m_lower(nbPoints)
+        ,   m_halfMin(nbCentroid)
+        ,   m_maxDrift(0)
+        ,   m_secondDrift(0)
+        ,   m_maxDriftCentroid(0)
+    { }
+
+    virtual void setCentroids(const Coord* centroids)
+    {
+        Base::setCentroids(centroids);
+
+        // half the distance to the closest other centroid
+        std::fill(m_halfMin.begin(), m_halfMin.end(), std::numeric_limits<DistanceType>::max());
+        for(size_t i=0; i<m_nbCentroid; i++)
+        {
+            for(size_t j=i+1; j<m_nbCentroid; j++)
+            {
+                const DistanceType half = 0.5 * sqrt(this->squareDistance(this->centroid(i), j));
+                if(half < m_halfMin[i]) m_halfMin[i] = half;
+                if(half < m_halfMin[j]) m_halfMin[j] = half;
+            }
+        }
+
+        // the two largest drifts
+        m_maxDrift         = 0;
+        m_secondDrift      = 0;
+        m_maxDriftCentroid = 0;
+        for(size_t cid=0; cid<m_nbCentroid; cid++)
+        {
+            if(m_drift[cid] > m_maxDrift)
+            {
+                m_secondDrift      = m_maxDrift;
+                m_maxDrift         = m_drift[cid];
+                m_maxDriftCentroid = cid;
+            }
+            else if(m_drift[cid] > m_secondDrift)
+            {
+                m_secondDrift = m_drift[cid];
+            }
+        }
+    }
+
+    virtual void assign(const Coord* const* points,
+                        const size_t        begin,
+                        const size_t        end,
+                        size_t*             closest)
+    {
+        for(size_t idx=begin; idx<end; idx++)
+        {
+            const Coord* p = points[idx];
+            const size_t a = closest[idx];
+
+            if(!m_bFirst)
+            {
+                // the bounds follow the centroids
+                m_upper[idx] += m_drift[a];
+                m_lower[idx] -= (a == m_maxDriftCentroid) ? m_secondDrift : m_maxDrift;
+
+                const DistanceType bound = std::max(m_lower[idx], m_halfMin[a]);
+                if(m_upper[idx] <= bound) continue;
+
+                // the upper bound is made exact
+                m_upper[idx] = sqrt(this->squareDistance(p, a));
+                if(m_upper[idx] <= bound) continue;
+            }
+
+            // all the distances: the closest and the second closest
+            DistanceType aSquare      = this->squareDistance(p, a);
+            DistanceType secondSquare = std::numeric_limits<DistanceType>::max();
+            size_t       to           = a;
+            for(size_t cid=0; cid<m_nbCentroid; cid++)
+            {
+                if(cid == a) continue;
+
+                const DistanceType square = this->squareDistance(p, cid);
+                if(square < aSquare)
+                {
+                    secondSquare = aSquare;
+                    aSquare      = square;
+                    to           = cid;
+                }
+                else if(square < secondSquare)
+                {
+                    secondSquare = square;
+                }
+            }
+            m_upper[idx] = sqrt(aSquare);
+            m_lower[idx] = sqrt(secondSquare);
+            closest[idx] = to;
+        }
+    }
+
+///////////////////////////////////////////////////////////////////////////////
+    private:
+///////////////////////////////////////////////////////////////////////////////
+
+    std::vector<DistanceType>   m_upper                                       ;
+    std::vector<DistanceType>   m_lower                                       ;
+    std::vector<DistanceType>   m_halfMin                                     ;
+    DistanceType                m_maxDrift                                    ;
+    DistanceType                m_secondDrift                                 ;
+    size_t                      m_maxDriftCentroid                            ;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Yinyang: the centroids are split in groups (a small k-means on the first
+// centroids), and each point keeps an upper bound u(x) >= d(x, a(x)), one
+// lower bound l(x,G) per group (on the centroids of G other than a(x)), and
+// the global lower bound l(x) = min_G l(x,G). The filters are:
+//
+//  - global: the point keeps its centroid when u(x) <= l(x),
+//  - group:  the centroids of G are skipped when l(x,G) > d(x, a(x)),
+//  - local:  c is skipped when l'(x,G) - drift(c) > d(x, a(x)), with l'
+//            the bound of G before its update.
+//
+// The global bound follows the largest group drift, and the group bounds
+// are stored relative to the total drift of their group.
+//
+// Memory: nbGroup bounds per point. Meant for a very large number of
+// centroids, where the k bounds of Elkan do not fit.
+//
+template<class Dim>
+class YinyangBounds : public CentroidBounds<Dim>
+{
+    typedef CentroidBounds<Dim> Base;
+    using Base::m_nbCentroid;
+    using Base::m_dim;
+    using Base::m_bFirst;
+    using Base::m_drift;
+
+///////////////////////////////////////////////////////////////////////////////
+    public:
+///////////////////////////////////////////////////////////////////////////////
+
+    YinyangBounds(const size_t nbPoints, const size_t nbCentroid, const size_t dim)
+        :   Base(nbPoints, nbCentroid, dim)
+        ,   m_nbGroup(std::max((size_t)1, std::min(YinyangMaxGroups, nbCentroid / YinyangGroupSize)))
+        ,   m_group(nbCentroid, 0)
+        ,   m_members(m_nbGroup)
+        ,   m_groupDrift(m_nbGroup, 0.0)
+        ,   m_totalGroupDrift(m_nbGroup, 0.0)
+        ,   m_maxGroupDrift(0)
+        ,   m_upper(nbPoints)
+        ,   m_global(nbPoints)
+        ,   m_lower(nbPoints * m_nbGroup)
+    { }
+
+    virtual void setCentroids(const Coord* centroids)
+    {
+        Base::setCentroids(centroids);
+        if(m_bFirst)
+        {
+            groupCentroids( );
+            return;
+        }
+
+        // the drift of a group is the largest drift of its centroids
+        m_maxGroupDrift = 0;
+        for(size_t g=0; g<m_nbGroup; g++)
+        {
+            m_groupDrift[g] = 0;
+            for(size_t i=0; i<m_members[g].size(); i++)
+            {
+                // an empty cluster (not a number) is never a candidate
+                const DistanceType drift = m_drift[m_members[g][i]];
+                if(!std::isfinite(drift)) continue;
+                if(drift > m_groupDrift[g]) m_groupDrift[g] = drift;
+            }
+            m_totalGroupDrift[g] += m_groupDrift[g];
+            if(m_groupDrift[g] > m_maxGroupDrift) m_maxGroupDrift = m_groupDrift[g];
+        }
+    }
+
+    virtual void assign(const Coord* const* points,
+                        const size_t        begin,
+                        const size_t        end,
+                        size_t*             closest)
+    {
+        // the distances of a point, the two smallest of each group
+        std::vector<DistanceType> dist(m_bFirst ? m_nbCentroid : 0);
+        std::vector<DistanceType> min1(m_nbGroup);
+        std::vector<DistanceType> min2(m_nbGroup);
+        std::vector<size_t>       argMin1(m_nbGroup);
+        std::vector<char>         examined(m_nbGroup);
+
+        for(size_t idx=begin; idx<end; idx++)
+        {
+            const Coord*  p     = points[idx];
+            DistanceType* lower = &m_lower[idx * m_nbGroup];
+            const size_t  from  = closest[idx];
+
+            if(m_bFirst)
+            {
+                // all the distances
+                size_t       a       = from;
+                DistanceType aSquare = this->squareDistance(p, a);
+                for(size_t cid=0; cid<m_nbCentroid; cid++)
+                {
+                    const DistanceType square = (cid == from) ? aSquare : this->squareDistance(p, cid);
+                    dist[cid] = sqrt(square);
+                    if(square < aSquare)
+                    {
+                        aSquare = square;
+                        a       = cid;
+                    }
+                }
+                for(size_t g=0; g<m_nbGroup; g++)
+                {
+                    lower[g] = std::numeric_limits<DistanceType>::max();
+                    for(size_t i=0; i<m_members[g].size(); i++)
+                    {
+                        const size_t cid = m_members[g][i];
+                        if(cid != a && dist[cid] < lower[g]) lower[g] = dist[cid];
+                    }
+                }
+                m_upper[idx]  = dist[a];
+                m_global[idx] = *std::min_element(lower, lower + m_nbGroup);
+                closest[idx]  = a;
+                continue;
+            }
+
+            // global filter
+            DistanceType upper  = m_upper[idx] + m_drift[from];
+            DistanceType global = m_global[idx] - m_maxGroupDrift;
+            m_upper[idx]  = upper;
+            m_global[idx] = global;
+            if(upper <= global) continue;
+
+            const DistanceType fromSquare = this->squareDistance(p, from);
+            upper        = sqrt(fromSquare);
+            m_upper[idx] = upper;
+            if(upper <= global) continue;
+
+            // group and local filters
+            size_t       a       = from;
+            DistanceType aSquare = fromSquare;
+            for(size_t g=0; g<m_nbGroup; g++)
+            {
+                const DistanceType bound = lower[g] - m_totalGroupDrift[g];
+                examined[g] = !(bound > upper);
+                if(!examined[g]) continue;
+
+                // the two smallest (square) distances of the group, or
+                // their lower bounds
+                const DistanceType previous = bound + m_groupDrift[g];
+                min1[g]    = std::numeric_limits<DistanceType>::max();
+                min2[g]    = std::numeric_limits<DistanceType>::max();
+                argMin1[g] = m_nbCentroid;
+                for(size_t i=0; i<m_members[g].size(); i++)
+                {
+                    const size_t cid = m_members[g][i];
+                    if(cid == from) continue;
+
+                    DistanceType       square = 0;
+                    const DistanceType d      = previous - m_drift[cid];
+                    if(d > upper)
+                    {
+                        square = d * d;
+                    }
+                    else
+                    {
+                        square = this->squareDistance(p, cid);
+
+                        // the Lloyd order: the current centroid, then the
+                        // smallest index wins the ties
+                        if(square < aSquare || (square == aSquare && a != from && cid < a))
+                        {
+                            aSquare = square;
+                            upper   = sqrt(square);
+                            a       = cid;
+                        }
+                    }
+                    if(square < min1[g])
+                    {
+                        min2[g]    = min1[g];
+                        min1[g]    = square;
+                        argMin1[g] = cid;
+                    }
+                    else if(square < min2[g])
+                    {
+                        min2[g] = square;
+                    }
+                }
+            }
+
+            // the bounds, on the centroids other than the closest
+            for(size_t g=0; g<m_nbGroup; g++)
+            {
+                if(!examined[g]) continue;
+                const DistanceType square = (argMin1[g] == a) ? min2[g] : min1[g];
+                lower[g] = sqrt(square) + m_totalGroupDrift[g];
+            }
+            if(a != from)
+            {
+                const size_t g = m_group[from];
+                if(sqrt(fromSquare) < lower[g] - m_totalGroupDrift[g])
+                {
+                    lower[g] = sqrt(fromSquare) + m_totalGroupDrift[g];
+                }
+            }
+            global = std::numeric_limits<DistanceType>::max();
+            for(size_t g=0; g<m_nbGroup; g++)
+            {
+                global = std::min(global, lower[g] - m_totalGroupDrift[g]);
+            }
+            m_upper[idx]  = upper;
+            m_global[idx] = global;
+            closest[idx]  = a;
+        }
+    }
+
+///////////////////////////////////////////////////////////////////////////////
+    private:
+///////////////////////////////////////////////////////////////////////////////
+
+    // groups the centroids by a few k-means iterations, seeded with
+    // centroids picked regularly
+    void groupCentroids( )
+    {
+        std::vector<Coord>    seeds(m_nbGroup * m_dim);
+        std::vector<CoordSum> sums(m_nbGroup * m_dim);
+        std::vector<size_t>   counts(m_nbGroup);
+        for(size_t g=0; g<m_nbGroup; g++)
+        {
+            const Coord* c = this->centroid(g * m_nbCentroid / m_nbGroup);
+            std::copy(c, c + m_dim, &seeds[g * m_dim]);
+        }
+        for(size_t iter=0; iter<YinyangGroupIter; iter++)
+        {
+            std::fill(sums.begin(), sums.end(), 0.0);
+            std::fill(counts.begin(), counts.end(), 0);
+            for(size_t cid=0; cid<m_nbCentroid; cid++)
+            {
+                DistanceType minDist = 0;
+                m_group[cid] = closestCentroid<Dim>(this->centroid(cid), &seeds[0], m_nbGroup, m_dim, minDist);
+                Dim::accumulate(&sums[m_group[cid] * m_dim], this->centroid(cid), m_dim);
+                counts[m_group[cid]]++;
+            }
+            for(size_t g=0; g<m_nbGroup; g++)
+            {
+                if(counts[g] == 0) continue;
+                for(size_t d=0; d<m_dim; d++)
+                {
+                    seeds[g * m_dim + d] = sums[g * m_dim + d] / (double)counts[g];
+                }
+            }
+        }
+        for(size_t g=0; g<m_nbGroup; g++)
+        {
+            m_members[g].clear();
+        }
+        for(size_t cid=0; cid<m_nbCentroid; cid++)
+        {
+            m_members[m_group[cid]].push_back(cid);
+        }
+    }
+
+    const size_t                        m_nbGroup                             ;
+    std::vector<size_t>                 m_group                               ;
+    std::vector<std::vector<size_t> >   m_members                             ;
+    std::vector<DistanceType>           m_groupDrift                          ;
+    std::vector<DistanceType>           m_totalGroupDrift                     ;
+    DistanceType                        m_maxGroupDrift                       ;
+
+    std::vector<DistanceType>           m_upper                               ;
+    std::vector<DistanceType>           m_global                              ;
+    std::vector<DistanceType>           m_lower                               ;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<class Dim>
+static KMeansBounds* createKMeansBounds_(const KMeansMethod method,
+                                         const size_t       nbPoints,
+                                         const size_t       nbCentroid,
+                                         const size_t       dim)
+{
+    switch(method)
+    {
+        case KMeansElkan:   return new ElkanBounds<Dim>(nbPoints, nbCentroid, dim);
+        case KMeansHamerly: return new HamerlyBounds<Dim>(nbPoints, nbCentroid, dim);
+        case KMeansYinyang: return new YinyangBounds<Dim>(nbPoints, nbCentroid, dim);
+        default:            return 0;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+KMeansBounds* createKMeansBounds(const KMeansMethod method,
+                                 const size_t       nbPoints,
+                                 const size_t       nbCentroid,
+                                 const size_t       dim)
+{
+    switch(dim)
+    {
+        case 2:  return createKMeansBounds_< FixedDim<2> >(method, nbPoints, nbCentroid, dim);
+        case 3:  return createKMeansBounds_< FixedDim<3> >(method, nbPoints, nbCentroid, dim);
+        case 4:  return createKMeansBounds_< FixedDim<4> >(method, nbPoints, nbCentroid, dim);
+        default: return createKMeansBounds_< FixedDim<0> >(method, nbPoints, nbCentroid, dim);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+static const char* s_methodNames[] = { "lloyd", "elkan", "hamerly", "yinyang", "filter" };
+static const size_t s_nbMethod     = sizeof(s_methodNames) / sizeof(s_methodNames[0]);
+
+const char* kmeansMethodName(const KMeansMethod method)
+{
+    return ((size_t)method < s_nbMethod) ? s_methodNames[method] : "unknown";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool kmeansMethodFromName(const std::string& name, KMeansMethod& method)
+{
+    for(size_t i=0; i<s_nbMethod; i++)
+    {
+        if(name == s_methodNames[i])
+        {
+            method = (KMeansMethod)i;
+            return true;
+        }
+    }
+    fprintf(stdout, "Error: unknown k-means method '%s'\n", name.c_str());
+    return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,78 @@
+#ifndef _KMeansBounds_h_
+#define _KMeansBounds_h_
+
+#include <string>
+#include "Point.h"
+
+// The assignment step of the K-Means iterations
+enum KMeansMethod
+{
+        KMeansLloyd     = 0     // all the distances, at each iteration
+    ,   KMeansElkan     = 1     // k lower bounds per point
+    ,   KMeansHamerly   = 2     // one lower bound per point
+    ,   KMeansYinyang   = 3     // one lower bound per group of centroids
+    ,   KMeansFilter    = 4     // kd-tree filtering (low dimensions, see KdTree)
+};
+
+//
+// Accelerated K-Means assignment. Distance bounds are kept from one
+// iteration to the next: when the centroids move by a small amount, the
+// triangle inequality proves that most points keep their centroid, and
+// most point to centroid distances are not computed.
+//
+// The assignment is the one of the Lloyd iterations, on the exact
+// distances: the closest centroid, and the current one on ties.
+//
+class KMeansBounds
+{
+///////////////////////////////////////////////////////////////////////////////
+    public:
+///////////////////////////////////////////////////////////////////////////////
+
+    virtual                 ~KMeansBounds       ( )
+    { }
+
+    ///
+    /// \brief setCentroids The centroids of the next assignment, called
+    ///                     once per iteration. The bounds are updated from
+    ///                     the centroid moves.
+    /// \param centroids row-major block of nbCentroid x dim coordinates
+    ///
+    virtual void            setCentroids        (const Coord* centroids) = 0;
+
+    ///
+    /// \brief assign Finds the closest centroid of the points [begin, end).
+    ///               Can be called concurrently, on disjoint ranges.
+    ///               The points must be the same at each iteration.
+    /// \param points  the coordinates of each point
+    /// \param closest in:  the current centroid of each point
+    ///                out: the closest centroid of each point
+    ///
+    virtual void            assign              (const Coord* const* points,
+                                                 const size_t        begin,
+                                                 const size_t        end,
+                                                 size_t*             closest) = 0;
+};
+
+///
+/// \brief createKMeansBounds Creates the bounds of a K-Means method.
+/// \return a new object (the client is responsible for deleting it), or
+///         0 for KMeansLloyd and KMeansFilter.
+///
+KMeansBounds* createKMeansBounds(const KMeansMethod method,
+                                 const size_t       nbPoints,
+                                 const size_t       nbCentroid,
+                                 const size_t       dim);
+
+///
+/// \brief kmeansMethodName "lloyd", "elkan", "hamerly", "yinyang", "filter"
+///
+const char* kmeansMethodName(const KMeansMethod method);
+
+///
+/// \brief kmeansMethodFromName The method of a name (see kmeansMethodName).
+/// \return false if the name is unknown.
+///
+bool kmeansMethodFromName(const std::string& name, KMeansMethod& method);
+
+#endif
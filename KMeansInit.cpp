@@ -0,0 +1,421 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <limits>
+
+#include "BatchAssigner.h"
+#include "Distance.h"
+#include "FixedPoint.h"
+#include "Parallel.h"
+#include "Random.h"
+#include "KMeansInit.h"
+
+// k-means||: number of candidates picked per round, per seed
+static const size_t ParallelOversampling = 2;
+
+////////////////////////////////////////////////////////////////////////////////
+// random index in [0, nb), with a probability proportional to the weights
+// (weights: 0 for all 1)
+static size_t weightedRandomIndex(const double* weights, const size_t nb)
+{
+    if(!weights)
+    {
+        return randomIndex(nb);
+    }
+    double total = 0.0;
+    for(size_t i=0; i<nb; i++) total += weights[i];
+    double r = randomValue(0.0, total);
+    size_t idx = 0;
+    for(idx=0; idx+1<nb && r>=weights[idx]; idx++)
+    {
+        r -= weights[idx];
+    }
+    return idx;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// a uniform value in [0, 1), function of (key, round, idx) only: the
+// sampling does not depend on the number of threads.
+static double hashUniform(const uint64_t key, const size_t round, const size_t idx)
+{
+    // splitmix64
+    uint64_t z = key + 0x9E3779B97F4A7C15ULL * ((uint64_t)idx * 64 + round + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z =  z ^ (z >> 31);
+    return (z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Updates the square distance of each point to its closest seed, with new
+// seeds, and sums the (weighted) distances of each chunk.
+//
+class SeedDistanceTask : public ParallelTask
+{
+public:
+    SeedDistanceTask(const std::vector<const Coord*>& points,
+                     const double*                    weights,
+                     const size_t                     dim,
+                     const size_t                     nbChunks)
+        :   m_points(points)
+        ,   m_weights(weights)
+        ,   m_dim(dim)
+        ,   m_nbChunks(nbChunks)
+        ,   m_minDist(points.size(), std::numeric_limits<DistanceType>::max())
+        ,   m_chunkSums(nbChunks, 0.0)
+        ,   m_seeds(0)
+        ,   m_nbSeed(0)
+    {
+    }
+
+    // adds the seeds (row-major), returns the total of the distances
+    double addSeeds(const Coord* seeds, const size_t nbSeed)
+    {
+        m_seeds  = seeds;
+        m_nbSeed = nbSeed;
+        parallelFor(*this, m_nbChunks);
+
+        double total = 0.0;
+        for(size_t i=0; i<m_nbChunks; i++) total += m_chunkSums[i];
+        return total;
+    }
+
+    virtual void run(const size_t chunkIdx)
+    {
+        size_t begin = 0;
+        size_t end   = 0;
+        chunkRange(m_points.size(), m_nbChunks, chunkIdx, begin, end);
+
+        double sum = 0.0;
+        for(size_t i=begin; i<end; i++)
+        {
+            for(size_t s=0; s<m_nbSeed; s++)
+            {
+                const DistanceType dist = coordSquareDistance(m_points[i], m_seeds + s * m_dim, m_dim);
+                if(dist < m_minDist[i]) m_minDist[i] = dist;
+            }
+            sum += weight(i) * m_minDist[i];
+        }
+        m_chunkSums[chunkIdx] = sum;
+    }
+
+    double weight(const size_t i)const
+    { return m_weights ? m_weights[i] : 1.0; }
+
+    const std::vector<const Coord*>&    m_points;
+    const double*                       m_weights;
+    const size_t                        m_dim;
+    const size_t                        m_nbChunks;
+    std::vector<DistanceType>           m_minDist;
+    std::vector<double>                 m_chunkSums;
+    const Coord*                        m_seeds;
+    size_t                              m_nbSeed;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// k-means||: picks each point with the probability
+// min(1, oversampling x w.d^2 / total), by chunks.
+//
+class SeedSamplingTask : public ParallelTask
+{
+public:
+    SeedSamplingTask(const SeedDistanceTask& dist,
+                     const uint64_t          key)
+        :   m_dist(dist)
+        ,   m_key(key)
+        ,   m_round(0)
+        ,   m_factor(0)
+        ,   m_picked(dist.m_nbChunks)
+    {
+    }
+
+    // picks the candidates of a round, in the order of the points
+    void sample(const size_t round, const double factor, std::vector<size_t>& picked)
+    {
+        m_round  = round;
+        m_factor = factor;
+        parallelFor(*this, m_dist.m_nbChunks);
+
+        picked.resize(0);
+        for(size_t i=0; i<m_picked.size(); i++)
+        {
+            picked.insert(picked.end(), m_picked[i].begin(), m_picked[i].end());
+        }
+    }
+
+    virtual void run(const size_t chunkIdx)
+    {
+        size_t begin = 0;
+        size_t end   = 0;
+        chunkRange(m_dist.m_points.size(), m_dist.m_nbChunks, chunkIdx, begin, end);
+
+        m_picked[chunkIdx].resize(0);
+        for(size_t i=begin; i<end; i++)
+        {
+            const double p = m_factor * m_dist.weight(i) * m_dist.m_minDist[i];
+            if(p > 0 && hashUniform(m_key, m_round, i) < p)
+            {
+                m_picked[chunkIdx].push_back(i);
+            }
+        }
+    }
+
+    const SeedDistanceTask&             m_dist;
+    const uint64_t                      m_key;
+    size_t                              m_round;
+    double                              m_factor;
+    std::vector<std::vector<size_t> >   m_picked;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// The closest seed of each point, by chunks.
+//
+class ClosestSeedTask : public ParallelTask
+{
+public:
+    ClosestSeedTask(const std::vector<const Coord*>& points,
+                    const size_t                     dim,
+                    const std::vector<Coord>&        seeds,
+                    std::vector<size_t>&             closest)
+        :   m_points(points)
+        ,   m_dim(dim)
+        ,   m_nbSeed(seeds.size() / dim)
+        ,   m_seeds(seeds)
+        ,   m_closest(closest)
+        ,   m_nbChunks(getNbThreads())
+    {
+        m_closest.assign(points.size(), m_nbSeed);
+        if(m_nbSeed >= BatchAssignMinCentroids)
+        {
+            m_assigner.setCentroids(&seeds[0], m_nbSeed, dim);
+        }
+    }
+
+    virtual void run(const size_t chunkIdx)
+    {
+        size_t begin = 0;
+        size_t end   = 0;
+        chunkRange(m_points.size(), m_nbChunks, chunkIdx, begin, end);
+        if(begin == end) return;
+
+        if(m_nbSeed >= BatchAssignMinCentroids)
+        {
+            m_assigner.assign(&m_points[begin], end - begin, &m_closest[begin], 0);
+        }
+        else for(size_t i=begin; i<end; i++)
+        {
+            DistanceType dist = 0;
+            m_closest[i] = closestCentroid< FixedDim<0> >(m_points[i], &m_seeds[0], m_nbSeed, m_dim, dist);
+        }
+    }
+
+    const std::vector<const Coord*>&    m_points;
+    const size_t                        m_dim;
+    const size_t                        m_nbSeed;
+    const std::vector<Coord>&           m_seeds;
+    std::vector<size_t>&                m_closest;
+    const size_t                        m_nbChunks;
+    BatchAssigner                       m_assigner;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// the coordinates of the points 'idx', row-major
+static void gatherCoords(const std::vector<const Coord*>& points,
+                         const size_t                     dim,
+                         const std::vector<size_t>&       idx,
+                         std::vector<Coord>&              coords)
+{
+    coords.resize(idx.size() * dim);
+    for(size_t i=0; i<idx.size(); i++)
+    {
+        std::copy(points[idx[i]], points[idx[i]] + dim, &coords[i * dim]);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// D^2 sampling: a point picked with a probability proportional to its
+// (weighted) square distance to the closest seed, of total 'total'
+static size_t sampleSeed(const SeedDistanceTask& task, const double total)
+{
+    const size_t nb   = task.m_points.size();
+    size_t       next = nb;
+    if(total > 0)
+    {
+        // the chunk, then the point in the chunk
+        double r = randomValue(0.0, total);
+        size_t chunk = 0;
+        while(chunk+1 < task.m_nbChunks && r >= task.m_chunkSums[chunk])
+        {
+            r -= task.m_chunkSums[chunk];
+            chunk++;
+        }
+        size_t begin = 0;
+        size_t end   = 0;
+        chunkRange(nb, task.m_nbChunks, chunk, begin, end);
+        for(size_t i=begin; i<end; i++)
+        {
+            const double d = task.weight(i) * task.m_minDist[i];
+            if(d <= 0) continue;
+            next = i;
+            if(r < d) break;
+            r -= d;
+        }
+    }
+    if(next == nb)
+    {
+        // all the points are on the seeds
+        next = randomIndex(nb);
+    }
+    return next;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// k-means++, on weighted points (weights: 0 for all 1)
+static void weightedPlusPlusSeeds(const std::vector<const Coord*>& points,
+                                  const double*                    weights,
+                                  const size_t                     dim,
+                                  const size_t                     nbSeed,
+                                  std::vector<size_t>&             seeds)
+{
+    const size_t nb = points.size();
+    seeds.resize(0);
+    if(nb == 0) return;
+
+    SeedDistanceTask task(points, weights, dim, getNbThreads());
+
+    // the first seed: a random point, or a weighted random point
+    const size_t first = weightedRandomIndex(weights, nb);
+    seeds.push_back(first);
+    double total = task.addSeeds(points[first], 1);
+
+    while(seeds.size() < nbSeed)
+    {
+        const size_t next = sampleSeed(task, total);
+        seeds.push_back(next);
+        total = task.addSeeds(points[next], 1);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void kmeansPlusPlusSeeds(const std::vector<const Coord*>& points,
+                         const size_t                     dim,
+                         const size_t                     nbSeed,
+                         std::vector<size_t>&             seeds,
+                         const double*                    weights)
+{
+    weightedPlusPlusSeeds(points, weights, dim, nbSeed, seeds);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void kmeansPlusPlusExtend(const std::vector<const Coord*>& points,
+                          const size_t                     dim,
+                          const std::vector<Coord>&        centroids,
+                          const size_t                     nbSeed,
+                          std::vector<size_t>&             seeds,
+                          const double*                    weights)
+{
+    seeds.resize(0);
+    if(points.empty()) return;
+
+    // no centroid: the first seed is any point
+    SeedDistanceTask task(points, weights, dim, getNbThreads());
+    double total = centroids.empty() ? 0.0 : task.addSeeds(&centroids[0], centroids.size() / dim);
+    while(seeds.size() < nbSeed)
+    {
+        const size_t next = sampleSeed(task, total);
+        seeds.push_back(next);
+        total = task.addSeeds(points[next], 1);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void kmeansParallelSeeds(const std::vector<const Coord*>& points,
+                         const size_t                     dim,
+                         const size_t                     nbSeed,
+                         const size_t                     nbRound,
+                         std::vector<size_t>&             seeds,
+                         const double*                    weights)
+{
+    const size_t nb = points.size();
+    seeds.resize(0);
+    if(nb == 0) return;
+
+    SeedDistanceTask   task(points, weights, dim, getNbThreads());
+    SeedSamplingTask   sampling(task, ((uint64_t)randomInteger() << 31) ^ (uint64_t)randomInteger());
+    std::vector<size_t> candidates(1, weightedRandomIndex(weights, nb));
+    std::vector<size_t> picked;
+    std::vector<Coord>  coords;
+
+    double total = task.addSeeds(points[candidates[0]], 1);
+    for(size_t round=0; round<nbRound && total>0; round++)
+    {
+        sampling.sample(round, ParallelOversampling * nbSeed / total, picked);
+        if(picked.empty()) continue;
+
+        gatherCoords(points, dim, picked, coords);
+        candidates.insert(candidates.end(), picked.begin(), picked.end());
+        total = task.addSeeds(&coords[0], picked.size());
+    }
+    if(candidates.size() <= nbSeed)
+    {
+        // too few candidates (small data set)
+        kmeansPlusPlusSeeds(points, dim, nbSeed, seeds, weights);
+        return;
+    }
+
+    // the weight of a candidate: the weight of the points closest to it
+    std::vector<size_t> closest;
+    gatherCoords(points, dim, candidates, coords);
+    ClosestSeedTask assign(points, dim, coords, closest);
+    parallelFor(assign, assign.m_nbChunks);
+
+    std::vector<double> candidateWeights(candidates.size(), 0.0);
+    for(size_t i=0; i<nb; i++)
+    {
+        candidateWeights[closest[i]] += task.weight(i);
+    }
+
+    // k-means++ on the weighted candidates
+    std::vector<const Coord*> candidatePoints(candidates.size());
+    for(size_t i=0; i<candidates.size(); i++)
+    {
+        candidatePoints[i] = points[candidates[i]];
+    }
+    std::vector<size_t> local;
+    weightedPlusPlusSeeds(candidatePoints, &candidateWeights[0], dim, nbSeed, local);
+    for(size_t i=0; i<local.size(); i++)
+    {
+        seeds.push_back(candidates[local[i]]);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void assignToClosestSeed(const std::vector<const Coord*>& points,
+                         const size_t                     dim,
+                         const std::vector<size_t>&       seeds,
+                         std::vector<size_t>&             closest)
+{
+    std::vector<Coord> coords;
+    gatherCoords(points, dim, seeds, coords);
+    assignToClosestCentroid(points, dim, coords, closest);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void assignToClosestCentroid(const std::vector<const Coord*>& points,
+                             const size_t                     dim,
+                             const std::vector<Coord>&        centroids,
+                             std::vector<size_t>&             closest)
+{
+    ClosestSeedTask task(points, dim, centroids, closest);
+    parallelFor(task, task.m_nbChunks);
+}
+
+////////////////////////////////////////////////////////////////////////////////
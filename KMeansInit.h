@@ -0,0 +1,82 @@
+#ifndef _KMeansInit_h_
+#define _KMeansInit_h_
+
+#include <vector>
+#include "Point.h"
+
+//
+// Seeding of the K-Means: the initial centroids are points of the data set,
+// picked far from each other. The random values come from randomInteger()
+// (rand(), see srand and the -seed option, or the seed of the thread).
+//
+
+///
+/// \brief kmeansPlusPlusSeeds k-means++: the first seed is a random point,
+///                            and each next seed is a point picked with a
+///                            probability proportional to its square
+///                            distance to the closest seed (D^2 sampling).
+/// \param points the coordinates of each point
+/// \param dim    dimension
+/// \param nbSeed number of seeds
+/// \param seeds  the index (in points) of each seed
+/// \param weights the weight of each point (0: all 1), the probabilities
+///                are multiplied by the weights
+///
+void kmeansPlusPlusSeeds(const std::vector<const Coord*>& points,
+                         const size_t                     dim,
+                         const size_t                     nbSeed,
+                         std::vector<size_t>&             seeds,
+                         const double*                    weights = 0);
+
+///
+/// \brief kmeansPlusPlusExtend k-means++, from existing centroids: nbSeed
+///                             more seeds, by D^2 sampling (warm start of a
+///                             K-Means with more clusters).
+/// \param centroids the existing centroids (row-major), the non finite
+///                  ones are ignored
+/// \param seeds     the index (in points) of each new seed
+///
+void kmeansPlusPlusExtend(const std::vector<const Coord*>& points,
+                          const size_t                     dim,
+                          const std::vector<Coord>&        centroids,
+                          const size_t                     nbSeed,
+                          std::vector<size_t>&             seeds,
+                          const double*                    weights = 0);
+
+///
+/// \brief kmeansParallelSeeds k-means||: a few rounds, where each point is
+///                            picked independently with a probability
+///                            proportional to its square distance to the
+///                            closest candidate (oversampling nbSeed points
+///                            per round, in parallel). The candidates are
+///                            weighted by the weight of the points closest
+///                            to them, and reduced to nbSeed by a weighted
+///                            k-means++.
+/// \param nbRound number of rounds
+///
+void kmeansParallelSeeds(const std::vector<const Coord*>& points,
+                         const size_t                     dim,
+                         const size_t                     nbSeed,
+                         const size_t                     nbRound,
+                         std::vector<size_t>&             seeds,
+                         const double*                    weights = 0);
+
+///
+/// \brief assignToClosestSeed The closest seed of each point (in parallel).
+/// \param closest the index (in seeds) of the closest seed of each point
+///
+void assignToClosestSeed(const std::vector<const Coord*>& points,
+                         const size_t                     dim,
+                         const std::vector<size_t>&       seeds,
+                         std::vector<size_t>&             closest);
+
+///
+/// \brief assignToClosestCentroid Same, with the coordinates of the
+///                                centroids (row-major).
+///
+void assignToClosestCentroid(const std::vector<const Coord*>& points,
+                             const size_t                     dim,
+                             const std::vector<Coord>&        centroids,
+                             std::vector<size_t>&             closest);
+
+#endif
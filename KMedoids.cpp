@@ -0,0 +1,675 @@
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <set>
+
+#include "Distance.h"
+#include "Parallel.h"
+#include "Random.h"
+#include "KMedoids.h"
+
+// the rows and columns of the blocks of the distance matrix
+static const size_t DistanceBlockSize = 64;
+
+// CLARA: default number of samples, and min number of points per sample
+// (Kaufman & Rousseeuw: 40 + 2k)
+static const size_t ClaraDefaultSamples  = 5;
+static const size_t ClaraMinSampleSize   = 1000;
+
+// a swap must decrease the deviation by more than this fraction (rounding)
+static const double PamSwapTolerance = 1e-12;
+
+////////////////////////////////////////////////////////////////////////////////
+
+static const char* s_metricNames[] = { "l2", "sql2", "l1", "cosine" };
+static const size_t s_nbMetric     = sizeof(s_metricNames) / sizeof(s_metricNames[0]);
+
+const char* medoidMetricName(const MedoidMetric metric)
+{
+    return ((size_t)metric < s_nbMetric) ? s_metricNames[metric] : "unknown";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool medoidMetricFromName(const std::string& name, MedoidMetric& metric)
+{
+    for(size_t i=0; i<s_nbMetric; i++)
+    {
+        if(name == s_metricNames[i])
+        {
+            metric = (MedoidMetric)i;
+            return true;
+        }
+    }
+    fprintf(stdout, "Error: unknown k-medoids metric '%s'\n", name.c_str());
+    return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// 1 - cos, from the dot product and the norms (a null vector: 1, or 0 to a
+// null vector)
+static DistanceType cosineDistance(const DistanceType dot,
+                                   const DistanceType normA,
+                                   const DistanceType normB)
+{
+    if(normA == 0 || normB == 0)
+    {
+        return (normA == normB) ? 0.0 : 1.0;
+    }
+    return std::max(0.0, 1.0 - dot / (normA * normB));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+DistanceType medoidDistance(const MedoidMetric metric,
+                            const Coord*       a,
+                            const Coord*       b,
+                            const size_t       dim)
+{
+    switch(metric)
+    {
+        case MedoidSquareEuclidean: return coordSquareDistance(a, b, dim);
+        case MedoidManhattan:       return coordL1Distance(a, b, dim);
+        case MedoidCosine:          return cosineDistance(coordDot(a, b, dim),
+                                                          sqrt(coordDot(a, a, dim)),
+                                                          sqrt(coordDot(b, b, dim)));
+        default:                    return coordDistance(a, b, dim);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// The distances of the blocks of the upper triangle of the matrix, and their
+// symmetric. The blocks are interleaved on the chunks: they have the same
+// size, but the last ones.
+//
+class DistanceBlockTask : public ParallelTask
+{
+public:
+    DistanceBlockTask(const std::vector<const Coord*>& points,
+                      const size_t                     dim,
+                      const MedoidMetric               metric,
+                      std::vector<float>&              dist)
+        :   m_points(points)
+        ,   m_dim(dim)
+        ,   m_metric(metric)
+        ,   m_dist(dist)
+        ,   m_nbChunks(4 * getNbThreads())
+    {
+        const size_t nb      = points.size();
+        const size_t nbBlock = (nb + DistanceBlockSize - 1) / DistanceBlockSize;
+        for(size_t bi=0; bi<nbBlock; bi++)
+        {
+            for(size_t bj=bi; bj<nbBlock; bj++)
+            {
+                m_blocks.push_back(std::make_pair(bi, bj));
+            }
+        }
+        // the cosine needs the norms only
+        if(metric == MedoidCosine)
+        {
+            m_norms.resize(nb);
+            for(size_t i=0; i<nb; i++)
+            {
+                m_norms[i] = sqrt(coordDot(points[i], points[i], dim));
+            }
+        }
+    }
+
+    virtual void run(const size_t chunkIdx)
+    {
+        const size_t nb = m_points.size();
+        for(size_t b=chunkIdx; b<m_blocks.size(); b+=m_nbChunks)
+        {
+            const size_t iBegin = m_blocks[b].first  * DistanceBlockSize;
+            const size_t jBegin = m_blocks[b].second * DistanceBlockSize;
+            const size_t iEnd   = std::min(nb, iBegin + DistanceBlockSize);
+            const size_t jEnd   = std::min(nb, jBegin + DistanceBlockSize);
+            for(size_t i=iBegin; i<iEnd; i++)
+            {
+                m_dist[i * nb + i] = 0;
+                for(size_t j=std::max(jBegin, i+1); j<jEnd; j++)
+                {
+                    const float d = (float)distance(i, j);
+                    m_dist[i * nb + j] = d;
+                    m_dist[j * nb + i] = d;
+                }
+            }
+        }
+    }
+
+    DistanceType distance(const size_t i, const size_t j)const
+    {
+        if(m_metric == MedoidCosine)
+        {
+            return cosineDistance(coordDot(m_points[i], m_points[j], m_dim), m_norms[i], m_norms[j]);
+        }
+        return medoidDistance(m_metric, m_points[i], m_points[j], m_dim);
+    }
+
+    const std::vector<const Coord*>&        m_points;
+    const size_t                            m_dim;
+    const MedoidMetric                      m_metric;
+    std::vector<float>&                     m_dist;
+    const size_t                            m_nbChunks;
+    std::vector<std::pair<size_t, size_t> > m_blocks;
+    std::vector<DistanceType>               m_norms;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+DistanceMatrix::DistanceMatrix(const std::vector<const Coord*>& points,
+                               const size_t                     dim,
+                               const MedoidMetric               metric)
+    :   m_nb(points.size())
+    ,   m_dist(points.size() * points.size())
+{
+    DistanceBlockTask task(points, dim, metric, m_dist);
+    parallelFor(task, task.m_nbChunks);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// The FasterPAM state: the nearest and second nearest medoid of each point
+// (their rank in the medoids), and the removal loss of each medoid (the
+// increase of the deviation if it is removed).
+//
+class PamState
+{
+public:
+    PamState(const DistanceMatrix&      dist,
+             const double*              weights,
+             const std::vector<size_t>& medoids)
+        :   m_dist(dist)
+        ,   m_weights(weights)
+        ,   m_medoids(medoids)
+        ,   m_nearest(dist.size())
+        ,   m_second(dist.size())
+        ,   m_d1(dist.size())
+        ,   m_d2(dist.size())
+        ,   m_loss(medoids.size())
+    {
+        for(size_t o=0; o<dist.size(); o++)
+        {
+            updateNearest(o);
+        }
+        updateLoss();
+    }
+
+    double weight(const size_t o)const
+    { return m_weights ? m_weights[o] : 1.0; }
+
+    // the nearest and second nearest medoids of o (the first ones on ties)
+    void updateNearest(const size_t o)
+    {
+        const float* row = m_dist.row(o);
+        m_nearest[o] = 0;
+        m_second[o]  = 1;
+        m_d1[o]      = row[m_medoids[0]];
+        m_d2[o]      = row[m_medoids[1]];
+        if(m_d2[o] < m_d1[o])
+        {
+            std::swap(m_nearest[o], m_second[o]);
+            std::swap(m_d1[o], m_d2[o]);
+        }
+        for(size_t m=2; m<m_medoids.size(); m++)
+        {
+            const double d = row[m_medoids[m]];
+            if(d < m_d1[o])
+            {
+                m_second[o]  = m_nearest[o];
+                m_d2[o]      = m_d1[o];
+                m_nearest[o] = m;
+                m_d1[o]      = d;
+            }
+            else if(d < m_d2[o])
+            {
+                m_second[o] = m;
+                m_d2[o]     = d;
+            }
+        }
+    }
+
+    void updateLoss( )
+    {
+        std::fill(m_loss.begin(), m_loss.end(), 0.0);
+        for(size_t o=0; o<m_dist.size(); o++)
+        {
+            m_loss[m_nearest[o]] += weight(o) * (m_d2[o] - m_d1[o]);
+        }
+    }
+
+    double deviation( )const
+    {
+        double td = 0.0;
+        for(size_t o=0; o<m_dist.size(); o++)
+        {
+            td += weight(o) * m_d1[o];
+        }
+        return td;
+    }
+
+    // the best swap of the candidate xc: its medoid rank, and the change of
+    // the deviation
+    double bestSwap(const size_t xc, std::vector<double>& delta, size_t& best)const
+    {
+        delta = m_loss;
+        double acc = 0.0;
+        const float* row = m_dist.row(xc);
+        for(size_t o=0; o<m_dist.size(); o++)
+        {
+            const double doj = row[o];
+            const double w   = weight(o);
+            if(doj < m_d1[o])
+            {
+                // o moves to xc, whatever the removed medoid
+                acc                   += w * (doj - m_d1[o]);
+                delta[m_nearest[o]]   += w * (m_d1[o] - m_d2[o]);
+            }
+            else if(doj < m_d2[o])
+            {
+                // o moves to xc if its nearest medoid is removed
+                delta[m_nearest[o]]   += w * (doj - m_d2[o]);
+            }
+        }
+        best = std::min_element(delta.begin(), delta.end()) - delta.begin();
+        return delta[best] + acc;
+    }
+
+    // replaces the medoid of rank m with xc
+    void swap(const size_t m, const size_t xc)
+    {
+        m_medoids[m] = xc;
+        const float* row = m_dist.row(xc);
+        for(size_t o=0; o<m_dist.size(); o++)
+        {
+            const double doj = row[o];
+            if(m_nearest[o] == m || m_second[o] == m)
+            {
+                updateNearest(o);
+            }
+            else if(doj < m_d1[o])
+            {
+                m_second[o]  = m_nearest[o];
+                m_d2[o]      = m_d1[o];
+                m_nearest[o] = m;
+                m_d1[o]      = doj;
+            }
+            else if(doj < m_d2[o])
+            {
+                m_second[o] = m;
+                m_d2[o]     = doj;
+            }
+        }
+        updateLoss();
+    }
+
+    const DistanceMatrix&       m_dist;
+    const double*               m_weights;
+    std::vector<size_t>         m_medoids;
+    std::vector<size_t>         m_nearest;
+    std::vector<size_t>         m_second;
+    std::vector<double>         m_d1;
+    std::vector<double>         m_d2;
+    std::vector<double>         m_loss;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// nbSample distinct random values in [0, nb), sorted (Floyd's sampling)
+static void randomSubset(const size_t nb, const size_t nbSample, std::vector<size_t>& subset)
+{
+    std::set<size_t> chosen;
+    for(size_t j=nb-nbSample; j<nb; j++)
+    {
+        const size_t r = randomIndex(j + 1);
+        if(!chosen.insert(r).second)
+        {
+            chosen.insert(j);
+        }
+    }
+    subset.assign(chosen.begin(), chosen.end());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double fasterPAM(const DistanceMatrix&  dist,
+                 const double*          weights,
+                 const size_t           nbMedoid,
+                 const size_t           maxIter,
+                 std::vector<size_t>&   medoids,
+                 const bool             printIter)
+{
+    const size_t nb = dist.size();
+    medoids.resize(0);
+    if(nbMedoid == 0 || nbMedoid >= nb)
+    {
+        fprintf(stdout, "Error: %ld medoids of %ld points\n", nbMedoid, nb);
+        return -1.0;
+    }
+
+    // a single medoid: the point of the lowest deviation
+    if(nbMedoid == 1)
+    {
+        double best = -1.0;
+        for(size_t c=0; c<nb; c++)
+        {
+            const float* row = dist.row(c);
+            double td = 0.0;
+            for(size_t o=0; o<nb; o++)
+            {
+                td += (weights ? weights[o] : 1.0) * row[o];
+            }
+            if(best < 0 || td < best)
+            {
+                best = td;
+                medoids.assign(1, c);
+            }
+        }
+        return best;
+    }
+
+    // random medoids
+    randomSubset(nb, nbMedoid, medoids);
+
+    PamState state(dist, weights, medoids);
+    std::vector<bool>   isMedoid(nb, false);
+    std::vector<double> delta;
+    for(size_t m=0; m<nbMedoid; m++)
+    {
+        isMedoid[medoids[m]] = true;
+    }
+
+    double td         = state.deviation();
+    size_t lastSwap   = nb;
+    bool   bConverged = false;
+    for(size_t iter=0; iter<maxIter && !bConverged; iter++)
+    {
+        size_t nbSwap = 0;
+        for(size_t xc=0; xc<nb; xc++)
+        {
+            if(xc == lastSwap)
+            {
+                // a whole pass without swap
+                bConverged = true;
+                break;
+            }
+            if(isMedoid[xc])
+            {
+                continue;
+            }
+            size_t       m      = 0;
+            const double change = state.bestSwap(xc, delta, m);
+            if(change < -PamSwapTolerance * td)
+            {
+                isMedoid[state.m_medoids[m]] = false;
+                isMedoid[xc]                 = true;
+                state.swap(m, xc);
+                td       = state.deviation();
+                lastSwap = xc;
+                nbSwap++;
+            }
+        }
+        if(printIter)
+        {
+            fprintf(stdout, "* FasterPAM pass %ld: %ld swaps, deviation %g\n", iter, nbSwap, td);
+        }
+        bConverged = bConverged || nbSwap == 0;
+    }
+    medoids = state.m_medoids;
+    return td;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// The nearest medoid of each point (the first one on ties), and the
+// deviation of the chunks.
+//
+class MedoidAssignTask : public ParallelTask
+{
+public:
+    MedoidAssignTask(const std::vector<const Coord*>& points,
+                     const std::vector<double>&       weights,
+                     const size_t                     dim,
+                     const MedoidMetric               metric,
+                     const std::vector<size_t>&       medoids)
+        :   m_points(points)
+        ,   m_weights(weights)
+        ,   m_dim(dim)
+        ,   m_metric(metric)
+        ,   m_medoids(medoids)
+        ,   m_nbChunks(getNbThreads())
+        ,   m_closest(points.size())
+        ,   m_deviation(m_nbChunks, 0.0)
+    {
+    }
+
+    virtual void run(const size_t chunkIdx)
+    {
+        size_t begin = 0;
+        size_t end   = 0;
+        chunkRange(m_points.size(), m_nbChunks, chunkIdx, begin, end);
+
+        for(size_t i=begin; i<end; i++)
+        {
+            DistanceType best = 0;
+            for(size_t m=0; m<m_medoids.size(); m++)
+            {
+                const DistanceType d = medoidDistance(m_metric, m_points[i], m_points[m_medoids[m]], m_dim);
+                if(m == 0 || d < best)
+                {
+                    best         = d;
+                    m_closest[i] = m;
+                }
+            }
+            m_deviation[chunkIdx] += m_weights[i] * best;
+        }
+    }
+
+    double deviation( )const
+    {
+        double td = 0.0;
+        for(size_t c=0; c<m_nbChunks; c++)
+        {
+            td += m_deviation[c];
+        }
+        return td;
+    }
+
+    const std::vector<const Coord*>&    m_points;
+    const std::vector<double>&          m_weights;
+    const size_t                        m_dim;
+    const MedoidMetric                  m_metric;
+    const std::vector<size_t>&          m_medoids;
+    const size_t                        m_nbChunks;
+    std::vector<size_t>                 m_closest;
+    std::vector<double>                 m_deviation;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// CLARA: the FasterPAM of a random sample of the points, one sample per
+// chunk, and its deviation on all the points. The samples are independent
+// (each one has its own seed): the result does not depend on the number of
+// threads.
+//
+class ClaraSampleTask : public ParallelTask
+{
+public:
+    ClaraSampleTask(const std::vector<const Coord*>& points,
+                    const std::vector<double>&       weights,
+                    const size_t                     dim,
+                    const MedoidMetric               metric,
+                    const size_t                     nbMedoid,
+                    const size_t                     maxIter,
+                    const size_t                     sampleSize,
+                    const size_t                     nbSample)
+        :   m_points(points)
+        ,   m_weights(weights)
+        ,   m_dim(dim)
+        ,   m_metric(metric)
+        ,   m_nbMedoid(nbMedoid)
+        ,   m_maxIter(maxIter)
+        ,   m_sampleSize(sampleSize)
+        ,   m_seeds(nbSample)
+        ,   m_medoids(nbSample)
+        ,   m_deviation(nbSample, -1.0)
+    {
+        // the seeds of the samples come from rand() (see -seed)
+        for(size_t s=0; s<nbSample; s++)
+        {
+            m_seeds[s] = ((size_t)randomInteger() << 16) ^ (size_t)randomInteger();
+        }
+    }
+
+    virtual void run(const size_t sampleIdx)
+    {
+        ThreadRandomSeed seed(m_seeds[sampleIdx]);
+
+        std::vector<size_t> sample;
+        randomSubset(m_points.size(), m_sampleSize, sample);
+
+        std::vector<const Coord*> points(sample.size());
+        std::vector<double>       weights(sample.size());
+        for(size_t i=0; i<sample.size(); i++)
+        {
+            points[i]  = m_points[sample[i]];
+            weights[i] = m_weights[sample[i]];
+        }
+        std::vector<size_t> medoids;
+        {
+            const DistanceMatrix dist(points, m_dim, m_metric);
+            if(fasterPAM(dist, &weights[0], m_nbMedoid, m_maxIter, medoids) < 0)
+            {
+                return;
+            }
+        }
+        for(size_t m=0; m<medoids.size(); m++)
+        {
+            medoids[m] = sample[medoids[m]];
+        }
+
+        // the deviation of all the points
+        MedoidAssignTask assign(m_points, m_weights, m_dim, m_metric, medoids);
+        parallelFor(assign, assign.m_nbChunks);
+        m_medoids[sampleIdx]   = medoids;
+        m_deviation[sampleIdx] = assign.deviation();
+    }
+
+    const std::vector<const Coord*>&    m_points;
+    const std::vector<double>&          m_weights;
+    const size_t                        m_dim;
+    const MedoidMetric                  m_metric;
+    const size_t                        m_nbMedoid;
+    const size_t                        m_maxIter;
+    const size_t                        m_sampleSize;
+    std::vector<size_t>                 m_seeds;
+    std::vector<std::vector<size_t> >   m_medoids;
+    std::vector<double>                 m_deviation;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t claraSampleSize(const size_t nbMedoid, const size_t sampleSize)
+{
+    const size_t size = sampleSize ? sampleSize : std::max(ClaraMinSampleSize, 40 + 2 * nbMedoid);
+    return std::min(size, KMedoidsMaxExactPoints);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double computeKMedoids(ClusterSet&            cs,
+                       const MedoidMetric     metric,
+                       const size_t           maxIter,
+                       const size_t           nbSample,
+                       const size_t           sampleSize,
+                       const bool             printIter,
+                       std::vector<size_t>*   medoidIdx)
+{
+    const DataSet& ds  = cs.dataSet();
+    const size_t   nb  = cs.nbPoints();
+    const size_t   k   = cs.nbCluster();
+    const size_t   dim = ds.dim();
+    if(medoidIdx) medoidIdx->resize(0);
+    if(k == 0 || k >= nb)
+    {
+        fprintf(stdout, "Error: %ld medoids of %ld points\n", k, nb);
+        return -1.0;
+    }
+
+    std::vector<const Coord*> points(nb);
+    std::vector<double>       weights(nb);
+    for(size_t i=0; i<nb; i++)
+    {
+        const size_t pid = cs.point(i).getId().value();
+        points[i]  = ds.coords(pid);
+        weights[i] = ds.weight(pid);
+    }
+
+    // exact on all the points, or CLARA. The matrix of a sample is not
+    // larger than the exact one.
+    const size_t size = claraSampleSize(k, sampleSize);
+    if(sampleSize > size)
+    {
+        fprintf(stdout, "* CLARA: sample size %ld reduced to %ld points\n", sampleSize, size);
+    }
+    const size_t samples = nbSample ? nbSample : (nb > KMedoidsMaxExactPoints ? ClaraDefaultSamples : 0);
+
+    std::vector<size_t> medoids;
+    if(samples == 0 || size >= nb)
+    {
+        const DistanceMatrix dist(points, dim, metric);
+        if(printIter)
+        {
+            fprintf(stdout, "* K-Medoids: distance matrix of %ld points, %ld bytes\n", nb, dist.memorySize());
+        }
+        if(fasterPAM(dist, &weights[0], k, maxIter, medoids, printIter) < 0)
+        {
+            return -1.0;
+        }
+    }
+    else if(size <= k)
+    {
+        fprintf(stdout, "Error: CLARA samples of %ld points for %ld medoids\n", size, k);
+        return -1.0;
+    }
+    else
+    {
+        ClaraSampleTask clara(points, weights, dim, metric, k, maxIter, size, samples);
+        parallelFor(clara, samples);
+
+        size_t best = samples;
+        for(size_t s=0; s<samples; s++)
+        {
+            if(printIter)
+            {
+                fprintf(stdout, "* CLARA sample %ld: %ld points, seed %ld, deviation %g\n",
+                        s, size, clara.m_seeds[s], clara.m_deviation[s]);
+            }
+            if(clara.m_deviation[s] >= 0 && (best == samples || clara.m_deviation[s] < clara.m_deviation[best]))
+            {
+                best = s;
+            }
+        }
+        if(best == samples)
+        {
+            return -1.0;
+        }
+        medoids = clara.m_medoids[best];
+    }
+
+    // the medoids are the centroids, the points go to the nearest one
+    MedoidAssignTask assign(points, weights, dim, metric, medoids);
+    parallelFor(assign, assign.m_nbChunks);
+    for(ClusterId cid=0; cid<k; cid++)
+    {
+        cs.getCentroid(cid) = cs.point(medoids[cid]);
+    }
+    for(size_t i=0; i<nb; i++)
+    {
+        cs.addPointToCluster(cs.point(i), assign.m_closest[i]);
+    }
+    if(medoidIdx) *medoidIdx = medoids;
+    return assign.deviation();
+}
+
+////////////////////////////////////////////////////////////////////////////////
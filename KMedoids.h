@@ -0,0 +1,142 @@
+#ifndef _KMedoids_h_
+#define _KMedoids_h_
+
+#include <string>
+#include <vector>
+#include "ClusterSet.h"
+
+// max number of points of the exact K-Medoids (a 400MB distance matrix)
+static const size_t KMedoidsMaxExactPoints = 10000;
+
+// The dissimilarity of the K-Medoids
+enum MedoidMetric
+{
+        MedoidEuclidean         = 0     // |a - b|
+    ,   MedoidSquareEuclidean   = 1     // |a - b|^2
+    ,   MedoidManhattan         = 2     // |a[0]-b[0]| + |a[1]-b[1]| + ...
+    ,   MedoidCosine            = 3     // 1 - a.b / (|a| |b|)
+};
+
+///
+/// \brief medoidMetricName The name of a metric (l2, sql2, l1, cosine)
+///
+const char* medoidMetricName(const MedoidMetric metric);
+
+///
+/// \brief medoidMetricFromName The metric of a name, prints an error if the
+///                             name is unknown
+///
+bool medoidMetricFromName(const std::string& name, MedoidMetric& metric);
+
+///
+/// \brief medoidDistance The dissimilarity of two points
+///
+DistanceType medoidDistance(const MedoidMetric metric,
+                            const Coord*       a,
+                            const Coord*       b,
+                            const size_t       dim);
+
+//
+// The cached dissimilarities of all the pairs of a set of points: a square
+// matrix of floats (n^2 x 4 bytes), one contiguous row per point.
+//
+// The matrix is computed in parallel, by square blocks of the upper
+// triangle: the rows and the columns of a block stay in the cache, and each
+// distance is computed once.
+//
+class DistanceMatrix
+{
+///////////////////////////////////////////////////////////////////////////////
+    public:
+///////////////////////////////////////////////////////////////////////////////
+
+                        DistanceMatrix      (const std::vector<const Coord*>& points,
+                                             const size_t                     dim,
+                                             const MedoidMetric               metric);
+
+    size_t              size                ( )                         const
+    { return m_nb; }
+
+    // the distances of the point i to all the points
+    const float*        row                 (const size_t i)            const
+    { return &m_dist[i * m_nb]; }
+
+    float               operator()          (const size_t i,
+                                             const size_t j)            const
+    { return m_dist[i * m_nb + j]; }
+
+    size_t              memorySize          ( )                         const
+    { return m_dist.size() * sizeof(float); }
+
+///////////////////////////////////////////////////////////////////////////////
+    private:
+///////////////////////////////////////////////////////////////////////////////
+
+    const size_t                m_nb                                          ;
+    std::vector<float>          m_dist                                        ;
+};
+
+///
+/// \brief fasterPAM The K-Medoids of the points of a distance matrix, by the
+///                  FasterPAM swaps (Schubert & Rousseeuw): from random
+///                  medoids, each non medoid point is a candidate in turn;
+///                  the change of the total deviation of its swap with each
+///                  medoid is computed at once in O(n) (from the nearest and
+///                  second nearest medoid of each point), and the best swap
+///                  is done as soon as it decreases the total deviation.
+///                  Stops after a whole pass on the candidates without swap.
+///                  The random values come from randomInteger().
+/// \param dist     the distances of the points
+/// \param weights  the weight of each point, or 0 for all 1
+/// \param nbMedoid k (< number of points)
+/// \param maxIter  max number of passes on the candidates
+/// \param medoids  the index of the k medoids
+/// \param printIter prints the deviation after each pass
+/// \return the total deviation (sum of the weighted distances of the points
+///         to their nearest medoid)
+///
+double fasterPAM(const DistanceMatrix&  dist,
+                 const double*          weights,
+                 const size_t           nbMedoid,
+                 const size_t           maxIter,
+                 std::vector<size_t>&   medoids,
+                 const bool             printIter = false);
+
+///
+/// \brief claraSampleSize The number of points of a CLARA sample: sampleSize,
+///                        or 40 + 2k and at least 1000 if 0, at most
+///                        KMedoidsMaxExactPoints
+///
+size_t claraSampleSize(const size_t nbMedoid, const size_t sampleSize);
+
+///
+/// \brief computeKMedoids The K-Medoids of the points of a cluster set: the
+///                        centroids are the medoids (points of the cluster
+///                        set), each point is in the cluster of its nearest
+///                        medoid (the first one on ties).
+///                        Up to KMedoidsMaxExactPoints points (or sampleSize)
+///                        FasterPAM runs on the distance matrix of all the
+///                        points. Above, CLARA: FasterPAM runs on the
+///                        matrices of nbSample random samples, in parallel,
+///                        and the medoids of the lowest deviation on all the
+///                        points are kept.
+///                        The data set weights are taken into account.
+/// \param cs           a new cluster set (no point assigned)
+/// \param metric       the dissimilarity
+/// \param maxIter      max number of FasterPAM passes
+/// \param nbSample     number of CLARA samples (0: automatic)
+/// \param sampleSize   points per CLARA sample (0: automatic), at most
+///                     KMedoidsMaxExactPoints
+/// \param printIter    prints the passes and the samples
+/// \param medoids      if not 0, the index of the medoids in the cluster set
+/// \return the total deviation, or -1 on error
+///
+double computeKMedoids(ClusterSet&            cs,
+                       const MedoidMetric     metric,
+                       const size_t           maxIter,
+                       const size_t           nbSample   = 0,
+                       const size_t           sampleSize = 0,
+                       const bool             printIter  = false,
+                       std::vector<size_t>*   medoids    = 0);
+
+#endif
@@ -0,0 +1,343 @@
+#include <algorithm>
+#include <cmath>
+
+#include "Distance.h"
+#include "FixedPoint.h"
+#include "KdTree.h"
+
+// the index of no node (the children of a leaf)
+static const size_t NoKdNode = (size_t)-1;
+
+// max number of points of a leaf
+static const size_t KdLeafSize = 16;
+
+// the depth of the subtrees filtered in parallel (2^depth subtrees)
+static const size_t KdFrontierDepth = 6;
+
+////////////////////////////////////////////////////////////////////////////////
+// orders the points by one coordinate
+class KdCoordLess
+{
+public:
+    KdCoordLess(const std::vector<const Coord*>& points, const size_t d)
+        :   m_points(points)
+        ,   m_d(d)
+    {
+    }
+
+    bool operator()(const size_t a, const size_t b)const
+    { return m_points[a][m_d] < m_points[b][m_d]; }
+
+    const std::vector<const Coord*>&    m_points;
+    const size_t                        m_d;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+KdTree::KdTree(const std::vector<const Coord*>& points,
+               const size_t                     dim,
+               const double*                    weights)
+    :   m_dim(dim)
+    ,   m_depth(0)
+{
+    const size_t nb = points.size();
+    m_index.resize(nb);
+    for(size_t i=0; i<nb; i++)
+    {
+        m_index[i] = i;
+    }
+    if(nb == 0)
+    {
+        return;
+    }
+    const size_t nbNodes = 2 * (nb / KdLeafSize + 1);
+    m_nodes.reserve(nbNodes);
+    m_cells.reserve(nbNodes * 2 * dim);
+    m_centroids.reserve(nbNodes * dim);
+    build(points, weights, 0, nb, 0);
+
+    // the points in the tree order, for the locality of the leaves
+    m_coords.resize(nb * dim);
+    m_weights.resize(weights ? nb : 0);
+    for(size_t i=0; i<nb; i++)
+    {
+        std::copy(points[m_index[i]], points[m_index[i]] + dim, &m_coords[i * dim]);
+        if(weights) m_weights[i] = weights[m_index[i]];
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t KdTree::build(const std::vector<const Coord*>& points,
+                     const double*                    weights,
+                     const size_t                     begin,
+                     const size_t                     end,
+                     const size_t                     depth)
+{
+    const size_t dim = m_dim;
+    const size_t idx = m_nodes.size();
+    m_depth = std::max(m_depth, depth);
+
+    Node node;
+    node.m_begin       = begin;
+    node.m_end         = end;
+    node.m_children[0] = NoKdNode;
+    node.m_children[1] = NoKdNode;
+    node.m_weight      = 0;
+    node.m_sse         = 0;
+    m_nodes.push_back(node);
+    m_cells.resize(m_cells.size() + 2 * dim);
+    m_centroids.resize(m_centroids.size() + dim, 0.0);
+
+    if(end - begin > KdLeafSize)
+    {
+        // the median of the widest dimension of the points
+        size_t widest = 0;
+        Coord  width  = -1;
+        for(size_t d=0; d<dim; d++)
+        {
+            Coord minCoord = points[m_index[begin]][d];
+            Coord maxCoord = minCoord;
+            for(size_t i=begin+1; i<end; i++)
+            {
+                minCoord = std::min(minCoord, points[m_index[i]][d]);
+                maxCoord = std::max(maxCoord, points[m_index[i]][d]);
+            }
+            if(maxCoord - minCoord > width)
+            {
+                width  = maxCoord - minCoord;
+                widest = d;
+            }
+        }
+        const size_t middle = begin + (end - begin) / 2;
+        std::nth_element(m_index.begin() + begin, m_index.begin() + middle, m_index.begin() + end,
+                         KdCoordLess(points, widest));
+
+        if(depth == KdFrontierDepth) m_frontier.push_back(idx);
+        const size_t left  = build(points, weights, begin,  middle, depth + 1);
+        const size_t right = build(points, weights, middle, end,    depth + 1);
+        m_nodes[idx].m_children[0] = left;
+        m_nodes[idx].m_children[1] = right;
+
+        // the cell, centroid and SSE, from the children
+        const Node& l  = m_nodes[left];
+        const Node& r  = m_nodes[right];
+        const double w = l.m_weight + r.m_weight;
+        double dl = 0;
+        double dr = 0;
+        for(size_t d=0; d<dim; d++)
+        {
+            m_cells[idx * 2 * dim + d]       = std::min(m_cells[left * 2 * dim + d],       m_cells[right * 2 * dim + d]);
+            m_cells[idx * 2 * dim + dim + d] = std::max(m_cells[left * 2 * dim + dim + d], m_cells[right * 2 * dim + dim + d]);
+
+            const double c = (l.m_weight * m_centroids[left * dim + d] + r.m_weight * m_centroids[right * dim + d]) / w;
+            m_centroids[idx * dim + d] = c;
+            dl += (m_centroids[left  * dim + d] - c) * (m_centroids[left  * dim + d] - c);
+            dr += (m_centroids[right * dim + d] - c) * (m_centroids[right * dim + d] - c);
+        }
+        m_nodes[idx].m_weight = w;
+        m_nodes[idx].m_sse    = l.m_sse + r.m_sse + l.m_weight * dl + r.m_weight * dr;
+        return idx;
+    }
+
+    // a leaf
+    if(depth <= KdFrontierDepth) m_frontier.push_back(idx);
+
+    Coord*  minCoord = &m_cells[idx * 2 * dim];
+    Coord*  maxCoord = minCoord + dim;
+    double* centroid = &m_centroids[idx * dim];
+    std::copy(points[m_index[begin]], points[m_index[begin]] + dim, minCoord);
+    std::copy(points[m_index[begin]], points[m_index[begin]] + dim, maxCoord);
+    double weight = 0;
+    for(size_t i=begin; i<end; i++)
+    {
+        const Coord* p = points[m_index[i]];
+        const double w = weights ? weights[m_index[i]] : 1.0;
+        for(size_t d=0; d<dim; d++)
+        {
+            minCoord[d]  = std::min(minCoord[d], p[d]);
+            maxCoord[d]  = std::max(maxCoord[d], p[d]);
+            centroid[d] += w * p[d];
+        }
+        weight += w;
+    }
+    for(size_t d=0; d<dim; d++)
+    {
+        centroid[d] /= weight;
+    }
+    double sse = 0;
+    for(size_t i=begin; i<end; i++)
+    {
+        const Coord* p = points[m_index[i]];
+        const double w = weights ? weights[m_index[i]] : 1.0;
+        for(size_t d=0; d<dim; d++)
+        {
+            sse += w * (p[d] - centroid[d]) * (p[d] - centroid[d]);
+        }
+    }
+    m_nodes[idx].m_weight = weight;
+    m_nodes[idx].m_sse    = sse;
+    return idx;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<class Dim>
+double KdTree::filterNode(const size_t  nodeIdx,
+                          const size_t* candidates,
+                          const size_t  nbCandidate,
+                          size_t*       scratch,
+                          const Coord*  centroids,
+                          const size_t* current,
+                          size_t*       closest)const
+{
+    const size_t  dim      = Dim::dim(m_dim);
+    const Node&   node     = m_nodes[nodeIdx];
+    const Coord*  minCoord = &m_cells[nodeIdx * 2 * dim];
+    const Coord*  maxCoord = minCoord + dim;
+
+    if(node.m_children[0] == NoKdNode)
+    {
+        // a leaf: the closest candidate of each point, as Lloyd does on
+        // ties: the current one, else the first one
+        double inertia = 0.0;
+        for(size_t i=node.m_begin; i<node.m_end; i++)
+        {
+            const size_t pid  = m_index[i];
+            const Coord* p    = &m_coords[i * dim];
+            DistanceType best = 0;
+            size_t       to   = current[pid];
+            for(size_t c=0; c<nbCandidate; c++)
+            {
+                const size_t       z    = candidates[c];
+                const DistanceType dist = Dim::squareDistance(p, centroids + z * dim, dim);
+                if(c == 0 || dist < best || 
+                   (dist == best && (z == current[pid] || (to != current[pid] && z < to))))
+                {
+                    best = dist;
+                    to   = z;
+                }
+            }
+            closest[pid] = to;
+            inertia     += (m_weights.empty() ? 1.0 : m_weights[i]) * best;
+        }
+        return inertia;
+    }
+
+    // the candidate closest to the cell midpoint
+    size_t       zBest    = candidates[0];
+    DistanceType bestDist = 0;
+    for(size_t c=0; c<nbCandidate; c++)
+    {
+        const Coord* z    = centroids + candidates[c] * dim;
+        DistanceType dist = 0;
+        for(size_t d=0; d<dim; d++)
+        {
+            const DistanceType diff = 0.5 * (minCoord[d] + maxCoord[d]) - z[d];
+            dist += diff * diff;
+        }
+        if(c == 0 || dist < bestDist)
+        {
+            bestDist = dist;
+            zBest    = candidates[c];
+        }
+    }
+
+    // the candidates closer than zBest to some point of the cell: the cell
+    // vertex the farthest in the direction z - zBest is closer to z
+    const Coord* zb = centroids + zBest * dim;
+    size_t nbKept = 0;
+    scratch[nbKept++] = zBest;
+    for(size_t c=0; c<nbCandidate; c++)
+    {
+        if(candidates[c] == zBest) continue;
+
+        const Coord* z     = centroids + candidates[c] * dim;
+        DistanceType distZ = 0;
+        DistanceType distB = 0;
+        for(size_t d=0; d<dim; d++)
+        {
+            const Coord        v  = (z[d] > zb[d]) ? maxCoord[d] : minCoord[d];
+            const DistanceType dz = v - z[d];
+            const DistanceType db = v - zb[d];
+            distZ += dz * dz;
+            distB += db * db;
+        }
+        if(!(distZ > distB))
+        {
+            scratch[nbKept++] = candidates[c];
+        }
+    }
+
+    if(nbKept == 1)
+    {
+        // the whole subtree goes to zBest: sse + w |centroid - zBest|^2
+        for(size_t i=node.m_begin; i<node.m_end; i++)
+        {
+            closest[m_index[i]] = zBest;
+        }
+        const double* centroid = &m_centroids[nodeIdx * dim];
+        double dist = 0;
+        for(size_t d=0; d<dim; d++)
+        {
+            dist += (centroid[d] - zb[d]) * (centroid[d] - zb[d]);
+        }
+        return node.m_sse + node.m_weight * dist;
+    }
+    return filterNode<Dim>(node.m_children[0], scratch, nbKept, scratch + nbKept, centroids, current, closest)
+         + filterNode<Dim>(node.m_children[1], scratch, nbKept, scratch + nbKept, centroids, current, closest);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<class Dim>
+double KdTree::filter_(const size_t  begin,
+                       const size_t  end,
+                       const Coord*  centroids,
+                       const size_t  nbCentroid,
+                       const size_t* current,
+                       size_t*       closest)const
+{
+    // the finite centroids (the empty clusters are not numbers)
+    std::vector<size_t> candidates;
+    for(size_t c=0; c<nbCentroid; c++)
+    {
+        bool bFinite = true;
+        for(size_t d=0; d<m_dim; d++) bFinite = bFinite && std::isfinite(centroids[c * m_dim + d]);
+        if(bFinite) candidates.push_back(c);
+    }
+    if(candidates.empty())
+    {
+        return 0.0;
+    }
+
+    // the candidates of each depth
+    std::vector<size_t> scratch((m_depth + 1) * candidates.size());
+    double inertia = 0.0;
+    for(size_t f=begin; f<end; f++)
+    {
+        inertia += filterNode<Dim>(m_frontier[f], &candidates[0], candidates.size(), &scratch[0],
+                                   centroids, current, closest);
+    }
+    return inertia;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double KdTree::filter(const size_t  begin,
+                      const size_t  end,
+                      const Coord*  centroids,
+                      const size_t  nbCentroid,
+                      const size_t* current,
+                      size_t*       closest)const
+{
+    switch(m_dim)
+    {
+        case 2:  return filter_< FixedDim<2> >(begin, end, centroids, nbCentroid, current, closest);
+        case 3:  return filter_< FixedDim<3> >(begin, end, centroids, nbCentroid, current, closest);
+        case 4:  return filter_< FixedDim<4> >(begin, end, centroids, nbCentroid, current, closest);
+        default: return filter_< FixedDim<0> >(begin, end, centroids, nbCentroid, current, closest);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,122 @@
+#ifndef _KdTree_h_
+#define _KdTree_h_
+
+#include <vector>
+#include "Point.h"
+
+//
+// A kd-tree over a set of points, for the filtering K-Means assignment
+// (Kanungo et al.): each node stores the bounding box, the (weighted)
+// centroid and the SSE of the points of its subtree.
+//
+// At each iteration, the candidate centroids are filtered down the tree: a
+// centroid is pruned from a node when it is farther than the centroid
+// closest to the cell midpoint from all the cell. When a single candidate
+// is left, the whole subtree goes to it, and its inertia comes from the
+// node centroid and SSE. The assignment is the one of the Lloyd iterations:
+// the closest centroid, and the current one on ties.
+//
+// Efficient in low dimensions (2D/3D): the cells of the higher dimensions
+// are seldom closer to a single centroid.
+//
+class KdTree
+{
+///////////////////////////////////////////////////////////////////////////////
+    public:
+///////////////////////////////////////////////////////////////////////////////
+
+    ///
+    /// \brief KdTree Builds the tree: the cells are split at the median of
+    ///               their widest dimension, down to a few points per leaf.
+    /// \param points  the coordinates of each point
+    /// \param dim     dimension
+    /// \param weights the weight of each point, or 0 for all 1
+    ///
+                        KdTree              (const std::vector<const Coord*>& points,
+                                             const size_t                     dim,
+                                             const double*                    weights = 0);
+
+    size_t              nbPoints            ( )                         const
+    { return m_index.size(); }
+
+    size_t              nbNodes             ( )                         const
+    { return m_nodes.size(); }
+
+    // the subtrees filtered independently (in parallel)
+    size_t              nbFrontier          ( )                         const
+    { return m_frontier.size(); }
+
+    ///
+    /// \brief filter Assigns the points of the frontier subtrees [begin, end)
+    ///               to their closest centroid. Can be called concurrently,
+    ///               on disjoint ranges.
+    /// \param centroids  row-major block of nbCentroid x dim coordinates
+    ///                   (the non finite ones are ignored)
+    /// \param current    the current centroid of each point (the ties)
+    /// \param closest    the closest centroid of each point
+    /// \return the inertia of the points (weighted square distances to
+    ///         their closest centroid)
+    ///
+    double              filter              (const size_t  begin,
+                                             const size_t  end,
+                                             const Coord*  centroids,
+                                             const size_t  nbCentroid,
+                                             const size_t* current,
+                                             size_t*       closest)     const ;
+
+///////////////////////////////////////////////////////////////////////////////
+    private:
+///////////////////////////////////////////////////////////////////////////////
+
+    struct Node
+    {
+        size_t          m_begin;        // the points [begin, end), tree order
+        size_t          m_end;
+        size_t          m_children[2];  // NoKdNode for a leaf
+        double          m_weight;       // sum of the weights
+        double          m_sse;          // sum of the weighted square
+                                        // distances to the centroid
+    };
+
+    // builds the subtree of the points [begin, end), returns its index
+    size_t              build               (const std::vector<const Coord*>& points,
+                                             const double*                    weights,
+                                             const size_t                     begin,
+                                             const size_t                     end,
+                                             const size_t                     depth);
+
+    template<class Dim>
+    double              filterNode          (const size_t  node,
+                                             const size_t* candidates,
+                                             const size_t  nbCandidate,
+                                             size_t*       scratch,
+                                             const Coord*  centroids,
+                                             const size_t* current,
+                                             size_t*       closest)     const ;
+
+    template<class Dim>
+    double              filter_             (const size_t  begin,
+                                             const size_t  end,
+                                             const Coord*  centroids,
+                                             const size_t  nbCentroid,
+                                             const size_t* current,
+                                             size_t*       closest)     const ;
+
+    const size_t                m_dim                                         ;
+
+    // the points in the tree order: their index, coordinates and weight
+    std::vector<size_t>         m_index                                       ;
+    std::vector<Coord>          m_coords                                      ;
+    std::vector<double>         m_weights                                     ;
+
+    // the nodes (the root first), their cell (min, max) and centroid
+    std::vector<Node>           m_nodes                                       ;
+    std::vector<Coord>          m_cells                                       ;
+    std::vector<double>         m_centroids                                   ;
+    size_t                      m_depth                                       ;
+
+    // the roots of the subtrees filtered in parallel
+    std::vector<size_t>         m_frontier                                    ;
+};
+
+#endif
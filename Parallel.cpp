@@ -0,0 +1,206 @@
+#include <stdio.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Parallel.h"
+
+// number of threads required by the user (0: hardware threads)
+static size_t s_nbThreads = 0;
+
+// true on the threads running a parallelFor
+static thread_local bool s_inParallel = false;
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// A set of worker threads, waiting for a task to run.
+//
+class ThreadPool
+{
+///////////////////////////////////////////////////////////////////////////////
+    public:
+///////////////////////////////////////////////////////////////////////////////
+
+    ThreadPool(const size_t nbWorkers)
+        :   m_task(0)
+        ,   m_nbChunks(0)
+        ,   m_next(0)
+        ,   m_pending(0)
+        ,   m_generation(0)
+        ,   m_stop(false)
+    {
+        for(size_t i=0; i<nbWorkers; i++)
+        {
+            m_workers.push_back(std::thread(&ThreadPool::workerLoop, this));
+        }
+    }
+
+    ~ThreadPool( )
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wakeUp.notify_all();
+        for(size_t i=0; i<m_workers.size(); i++)
+        {
+            m_workers[i].join();
+        }
+    }
+
+    size_t nbWorkers( )const
+    { return m_workers.size(); }
+
+    // runs all the chunks of the task, and waits for their completion
+    void run(ParallelTask& task, const size_t nbChunks)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_task     = &task;
+            m_nbChunks = nbChunks;
+            m_next     = 0;
+            m_pending  = m_workers.size();
+            m_generation++;
+        }
+        m_wakeUp.notify_all();
+
+        work();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while(m_pending != 0)
+        {
+            m_done.wait(lock);
+        }
+        m_task = 0;
+    }
+
+///////////////////////////////////////////////////////////////////////////////
+    private:
+///////////////////////////////////////////////////////////////////////////////
+
+    // run the chunks, until there are no more left
+    void work( )
+    {
+        for(;;)
+        {
+            const size_t chunk = m_next++;
+            if(chunk >= m_nbChunks) break;
+            m_task->run(chunk);
+        }
+    }
+
+    void workerLoop( )
+    {
+        s_inParallel = true;
+        size_t generation = 0;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for(;;)
+        {
+            while(!m_stop && m_generation == generation)
+            {
+                m_wakeUp.wait(lock);
+            }
+            if(m_stop) break;
+            generation = m_generation;
+
+            lock.unlock();
+            work();
+            lock.lock();
+
+            if(--m_pending == 0)
+            {
+                m_done.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread>    m_workers                                     ;
+    std::mutex                  m_mutex                                       ;
+    std::condition_variable     m_wakeUp                                      ;
+    std::condition_variable     m_done                                        ;
+
+    ParallelTask*               m_task                                        ;
+    size_t                      m_nbChunks                                    ;
+    std::atomic<size_t>         m_next                                        ;
+    size_t                      m_pending                                     ;
+    size_t                      m_generation                                  ;
+    bool                        m_stop                                        ;
+};
+
+// the pool, and the lock held by the parallelFor using it.
+static std::mutex  s_poolMutex;
+static ThreadPool* s_pool = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+
+static void deletePool( )
+{
+    delete s_pool;
+    s_pool = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t getNbThreads( )
+{
+    size_t nb = s_nbThreads;
+    if(nb == 0)
+    {
+        nb = std::thread::hardware_concurrency();
+    }
+    return (nb > 0) ? nb : 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void setNbThreads(const size_t nbThreads)
+{
+    s_nbThreads = nbThreads;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void parallelFor(ParallelTask& task, const size_t nbChunks)
+{
+    const size_t nbThreads = getNbThreads();
+
+    if(nbThreads <= 1 || nbChunks <= 1 || s_inParallel || !s_poolMutex.try_lock())
+    {
+        for(size_t i=0; i<nbChunks; i++)
+        {
+            task.run(i);
+        }
+        return;
+    }
+    if(!s_pool || s_pool->nbWorkers() != nbThreads-1)
+    {
+        if(!s_pool)
+        {
+            atexit(deletePool);
+        }
+        delete s_pool;
+        s_pool = new ThreadPool(nbThreads-1);
+    }
+    s_inParallel = true;
+    s_pool->run(task, nbChunks);
+    s_inParallel = false;
+
+    s_poolMutex.unlock();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void chunkRange(const size_t  nb,
+                const size_t  nbChunks,
+                const size_t  chunkIdx,
+                size_t&       begin,
+                size_t&       end)
+{
+    begin = (nb * chunkIdx)     / nbChunks;
+    end   = (nb * (chunkIdx+1)) / nbChunks;
+}
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,56 @@
+#ifndef _Parallel_h_
+#define _Parallel_h_
+
+#include <stdlib.h>
+
+//
+// A piece of work divided in chunks. The chunks are independent, and they
+// can be run concurrently by the worker threads (see parallelFor).
+//
+class ParallelTask
+{
+public:
+    ParallelTask( )
+    { }
+
+    virtual ~ParallelTask( )
+    { }
+
+    // process the chunk 'chunkIdx'
+    virtual void run(const size_t chunkIdx)=0;
+};
+
+///
+/// \brief getNbThreads The number of threads used by parallelFor.
+///                     Defaults to the number of hardware threads.
+/// \return size_t
+///
+size_t getNbThreads( );
+
+///
+/// \brief setNbThreads Sets the number of threads used by parallelFor.
+/// \param nbThreads number of threads. 0: number of hardware threads.
+///
+void setNbThreads(const size_t nbThreads);
+
+///
+/// \brief parallelFor Runs task.run(i) for i in [0, nbChunks), on a pool of
+///                    worker threads. The calling thread takes part in the
+///                    work, and returns when all the chunks are done.
+///                    Nested (or concurrent) calls run on the calling thread.
+/// \param task the work to run
+/// \param nbChunks number of chunks
+///
+void parallelFor(ParallelTask& task, const size_t nbChunks);
+
+///
+/// \brief chunkRange The range [begin, end) of the chunk 'chunkIdx', when
+///                   'nb' elements are split in 'nbChunks' chunks.
+///
+void chunkRange(const size_t  nb,
+                const size_t  nbChunks,
+                const size_t  chunkIdx,
+                size_t&       begin,
+                size_t&       end);
+
+#endif
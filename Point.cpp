@@ -2,16 +2,11 @@
 #include <cmath>
 #include <set>
 #include "Point.h"
+#include "Distance.h"
 
 double pointDiffNorm(const Point& p1, const Point& p2)
 {
-    double norm(0);
-    size_t nb = p1.dim();
-    for(size_t i=0; i<nb; i++)
-    {
-        norm += fabs(p1[i] - p2[i]);
-    }
-    return sqrt(norm);
+    return sqrt(coordL1Distance(p1.data(), p2.data(), p1.dim()));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -38,10 +33,10 @@ std::ostream& operator<<(std::ostream& os, const Point& point)
 Point& Point::operator+=(const Point& other)
 {
     assert(size() == other.size());
-    std::vector<Coord>&       thisV = coordVector( );
-    const std::vector<Coord>& thisO = other.coordVector( );
+    Coord*       thisV = data( );
+    const Coord* thisO = other.data( );
     
-    for(size_t i =0; i<thisV.size(); i++)
+    for(size_t i =0; i<m_dim; i++)
     {
         thisV[i] += thisO[i];
     }
@@ -52,10 +47,10 @@ Point& Point::operator+=(const Point& other)
 
 Point& Point::operator/=(double other)
 {
-    assert(m_coordenateVector.size()!=0);
+    assert(m_dim!=0);
     
-    std::vector<Coord>&  thisV = coordVector( );
-    for(size_t i=0; i<thisV.size(); i++)
+    Coord* thisV = data( );
+    for(size_t i=0; i<m_dim; i++)
     {
         thisV[i] /= other;
     }
@@ -66,8 +61,8 @@ Point& Point::operator/=(double other)
 
 void Point::clear( )
 {
-    std::vector<Coord>&  thisV = coordVector( );
-    for(size_t i=0; i<thisV.size(); i++)
+    Coord* thisV = data( );
+    for(size_t i=0; i<m_dim; i++)
     {
         thisV[i] = 0.0;
     }
@@ -75,12 +70,24 @@ void Point::clear( )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void Point::detach( )
+{
+    if(m_view)
+    {
+        m_coordenateVector.assign(m_view, m_view + m_dim);
+        m_view = 0;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void Point::print(FILE* p, const char* sep)const
 {
+    const Coord* thisV = data( );
     bool first = true;
-    for(size_t i=0; i<m_coordenateVector.size(); i++)
+    for(size_t i=0; i<m_dim; i++)
     {
-        const Coord coord = m_coordenateVector[i];
+        const Coord coord = thisV[i];
     
         if(!first) fprintf(p, "%s", sep);
         fprintf(p, "%15.10E", coord);
@@ -102,9 +109,10 @@ std::string Point::toString(const bool addBracket )const
     {
         s += "(";
     }
-    for(size_t i=0; i<m_coordenateVector.size(); i++)
+    const Coord* thisV = data( );
+    for(size_t i=0; i<m_dim; i++)
     {
-        const Coord coord = m_coordenateVector[i];
+        const Coord coord = thisV[i];
         
         if(addBracket) {
             if(i>0) s += ", ";
@@ -127,46 +135,12 @@ std::string Point::toString(const bool addBracket )const
 
 DistanceType Point::distanceTo(const Point& p)const
 {
-    const Point::CoordVector& xCoord =   coordVector( );
-    const Point::CoordVector& yCoord = p.coordVector( );
-    
-    Point::CoordVector::const_iterator c1     = xCoord.begin();
-    Point::CoordVector::const_iterator c2     = yCoord.begin();
-    Point::CoordVector::const_iterator c1_end = xCoord.end();
-    
-    DistanceType total(0);
-    
-    for(; c1!=c1_end; ++c1, ++c2)
-    {
-        const DistanceType diff = *c1 - *c2;
-        total += (diff * diff);
-    }
-    total = sqrt(total);
-    return total;
+    return coordDistance(data(), p.data(), m_dim);
 }
     
 ///////////////////////////////////////////////////////////////////////////////
 
 DistanceType Point::squareDistanceTo(const Point& p)const
 {
-    const Point::CoordVector& xCoord =   coordVector( );
-    const Point::CoordVector& yCoord = p.coordVector( );
-    
-    Point::CoordVector::const_iterator c1     = xCoord.begin();
-    Point::CoordVector::const_iterator c2     = yCoord.begin();
-    Point::CoordVector::const_iterator c1_end = xCoord.end();
-
-    DistanceType total(0);
-    for(; c1!=c1_end; ++c1, ++c2)
-    {
-        const DistanceType diff(*c1 - *c2);
-        total += (diff * diff);
-    }
-    return total;
+    return coordSquareDistance(data(), p.data(), m_dim);
 }
-
-
-
-
-
-
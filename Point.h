@@ -6,8 +6,16 @@
 #include <vector>
 #include <assert.h>
 
-// a coordinate
+// a coordinate. Defining CLUSTER_FLOAT_COORD at build time stores the
+// coordinates in single precision (half the memory of the data set).
+#ifdef CLUSTER_FLOAT_COORD
+typedef float Coord;
+#else
 typedef double Coord;
+#endif
+
+// sum of coordinates (centroids): always accumulated in double precision
+typedef double CoordSum;
 
 // distance
 typedef double DistanceType;
@@ -65,6 +73,12 @@ class PointId
 // set of points
 typedef std::set<PointId> PointIdSet;
 
+//
+// A point of the model. A Point either owns its coordinates, or it is a
+// light-weight view into the coordinate block of a DataSet (see
+// DataSet::operator[]). Views are read-only: any modification of a view
+// detaches it into its own storage first, so the data set is never changed.
+//
 class Point
 {
 ////////////////////////////////////////////////////////////////////////////////
@@ -74,31 +88,62 @@ class Point
     typedef std::vector<Coord> CoordVector;
     
     Point( )
-        : m_id(0)
+        : m_view(0)
+        , m_dim(0)
+        , m_id(0)
     {
     }
     
     Point(const PointId& _id, const size_t dim)
-    :   m_id(_id)
+        : m_coordenateVector(dim)
+        , m_view(0)
+        , m_dim(dim)
+        , m_id(_id)
     {
-        m_coordenateVector.resize(dim);
     }
     
     Point(const PointId& _id, const CoordVector& other)
+        : m_coordenateVector(other)
+        , m_view(0)
+        , m_dim(other.size())
+        , m_id(_id)
+    {
+    }
+
+    ///
+    /// \brief Point Creates a view on externally owned coordinates. The
+    ///              memory must outlive the point (and its copies).
+    /// \param _id  the point id
+    /// \param data pointer to the 'dim' coordinates
+    /// \param dim  number of coordinates
+    ///
+    Point(const PointId& _id, const Coord* data, const size_t dim)
+        : m_view(data)
+        , m_dim(dim)
+        , m_id(_id)
     {
-        m_id = _id;
-        m_coordenateVector = other;
     }
     
+    // a copy of a view is a view, a copy of an owning point owns its data.
     Point(const Point& other)
+        : m_coordenateVector(other.m_coordenateVector)
+        , m_view(other.m_view)
+        , m_dim(other.m_dim)
+        , m_id(other.m_id)
     {
-        operator=(other);
     }
     
+    // the assignment always copies the coordinates into this point storage.
     Point&              operator=          (const Point& other)
     {
-        m_id = other.m_id;
-        m_coordenateVector = other.m_coordenateVector;
+        if(this != &other)
+        {
+            const Coord* src = other.data();
+            m_coordenateVector.assign(src, src + other.m_dim);
+            m_view = 0;
+            m_dim  = other.m_dim;
+            m_id   = other.m_id;
+        }
         return *this;
     }
 
@@ -116,44 +161,49 @@ class Point
     /// \return
     ///
     Coord                       operator[]     (const size_t i)           const
-    { return m_coordenateVector[i]; }
+    { return data()[i]; }
     
     Coord                        coord          (const size_t i)          const
-    { return m_coordenateVector[i]; }
+    { return data()[i]; }
     
     size_t                      dim            ( )                        const
-    { return m_coordenateVector.size(); }
+    { return m_dim; }
     
     void                        set             (const size_t idx, Coord val)
-    { m_coordenateVector[idx] = val; }
+    { data()[idx] = val; }
     
     Point&                      operator+=      (const Point& other)           ;
     Point&                      operator/=      (double other)                 ;
     
-    //! coordenate vector
-    const std::vector<Coord>&   coordVector     ( )                       const
-    { return m_coordenateVector; }
+    //! pointer to the 'dim()' coordenates
+    const Coord*                data            ( )                       const
+    { return m_view ? m_view : (m_dim ? &m_coordenateVector[0] : 0); }
     
-    std::vector<Coord>&         coordVector     ( )
-    { return m_coordenateVector;  }
+    //! pointer to the coordenates. A view is detached before.
+    Coord*                      data            ( )
+    { detach( ); return (m_dim ? &m_coordenateVector[0] : 0); }
+    
+    //! true if this point refers to coordinates it does not own
+    bool                        isView          ( )                       const
+    { return m_view != 0; }
     
     //! Number of coordenates
     //@return the nb of coordenates
     size_t                      size            ( )                       const
-    { return m_coordenateVector.size(); }
+    { return m_dim; }
 
 
     // alias for the first coordenate
     Coord                       x               ( )                       const
-    { return m_coordenateVector[0]; }
+    { return data()[0]; }
 
     // alias for the 2nd coordenate
     Coord                       y               ( )                       const
-    { return m_coordenateVector[1]; }
+    { return data()[1]; }
 
     // alias for the 3rd coordenate
     Coord                       z               ( )                       const
-    { return m_coordenateVector[2]; }
+    { return data()[2]; }
 
     void                        clear           ( )                           ;
     void                        print      (FILE* p, const char* sep= " ")const;
@@ -174,7 +224,12 @@ class Point
 private:
 ////////////////////////////////////////////////////////////////////////////////
     
+    // copies the viewed coordinates into the own storage
+    void                        detach          ( )                           ;
+    
     CoordVector     m_coordenateVector                                         ;
+    const Coord*    m_view                                                     ;
+    size_t          m_dim                                                      ;
     PointId         m_id                                                       ;
 };
 
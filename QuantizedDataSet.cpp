@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <cmath>
+#include <algorithm>
+
+#include "QuantizedDataSet.h"
+
+////////////////////////////////////////////////////////////////////////////////
+
+QuantizedDataSet::QuantizedDataSet( )
+    :   m_type(QuantizeNone)
+    ,   m_nb_points(0)
+    ,   m_nb_dimension(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void QuantizedDataSet::init(const size_t              nbPoints,
+                            const std::vector<Coord>& minCoord,
+                            const std::vector<Coord>& maxCoord,
+                            const QuantizationType    type)
+{
+    // the codes are in [-maxCode, maxCode]
+    const double maxCode = (type == Quantize8) ? 127.0 : 32767.0;
+
+    m_type          = type;
+    m_nb_points     = nbPoints;
+    m_nb_dimension  = minCoord.size();
+
+    m_scale.resize(m_nb_dimension);
+    m_offset.resize(m_nb_dimension);
+    m_weights.resize(m_nb_dimension);
+    for(size_t d=0; d<m_nb_dimension; d++)
+    {
+        const double range = (double)maxCoord[d] - (double)minCoord[d];
+        m_offset[d]  = 0.5 * ((double)minCoord[d] + (double)maxCoord[d]);
+        m_scale[d]   = (range > 0) ? range / (2.0 * maxCode) : 1.0;
+        m_weights[d] = m_scale[d] * m_scale[d];
+    }
+    m_codes8.clear();
+    m_codes16.clear();
+    if(type == Quantize8)
+    {
+        m_codes8.resize(m_nb_points * m_nb_dimension);
+    }
+    else
+    {
+        m_codes16.resize(m_nb_points * m_nb_dimension);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void QuantizedDataSet::encode(const size_t i, const Coord* coords)
+{
+    const double maxCode = (m_type == Quantize8) ? 127.0 : 32767.0;
+    for(size_t d=0; d<m_nb_dimension; d++)
+    {
+        double code = floor((coords[d] - m_offset[d]) / m_scale[d] + 0.5);
+        code = std::max(-maxCode, std::min(maxCode, code));
+        if(m_type == Quantize8)
+        {
+            m_codes8[i * m_nb_dimension + d]  = (int8_t)code;
+        }
+        else
+        {
+            m_codes16[i * m_nb_dimension + d] = (int16_t)code;
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool QuantizedDataSet::build(DataSetStream& stream, const QuantizationType type)
+{
+    if(type != Quantize8 && type != Quantize16)
+    {
+        fprintf(stdout, "Error: invalid quantization type %d\n", (int)type);
+        return false;
+    }
+    std::vector<Coord> minCoord;
+    std::vector<Coord> maxCoord;
+    stream.range(minCoord, maxCoord);
+
+    init(stream.size(), minCoord, maxCoord, type);
+    stream.rewind();
+    for(size_t nb=stream.nextBlock(); nb>0; nb=stream.nextBlock())
+    {
+        for(size_t i=0; i<nb; i++)
+        {
+            encode(stream.blockBegin() + i, stream.block() + i * m_nb_dimension);
+        }
+    }
+    return !stream.failed();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void QuantizedDataSet::toCodeSpace(const Coord* coords, float* codes)const
+{
+    for(size_t d=0; d<m_nb_dimension; d++)
+    {
+        codes[d] = (coords[d] - m_offset[d]) / m_scale[d];
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void QuantizedDataSet::fromCodeSpace(const double* codes, Coord* coords)const
+{
+    for(size_t d=0; d<m_nb_dimension; d++)
+    {
+        coords[d] = m_offset[d] + m_scale[d] * codes[d];
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t QuantizedDataSet::memorySize( )const
+{
+    return m_codes8.size() * sizeof(int8_t) + m_codes16.size() * sizeof(int16_t);
+}
+
+////////////////////////////////////////////////////////////////////////////////
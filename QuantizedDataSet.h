@@ -0,0 +1,153 @@
+#ifndef _QuantizedDataSet_h_
+#define _QuantizedDataSet_h_
+
+#include <stdint.h>
+#include <vector>
+#include "Point.h"
+#include "DataSetStream.h"
+
+// Number of bits of the quantized coordinates
+enum QuantizationType
+{
+        QuantizeNone    = 0
+    ,   Quantize8       = 8
+    ,   Quantize16      = 16
+};
+
+//
+// A compact copy of a data set stream, where each dimension is linearly
+// quantized to int8 or int16:
+//
+//      x[d] = offset[d] + scale[d] * code[d]
+//
+// The distance of a point to a centroid can be computed on the codes, with
+// the centroid expressed on the same grid (see toCodeSpace):
+//
+//      |x - c|^2 = sum_d scale[d]^2 * (code[d] - c'[d])^2
+//
+class QuantizedDataSet
+{
+///////////////////////////////////////////////////////////////////////////////
+    public:
+///////////////////////////////////////////////////////////////////////////////
+
+                        QuantizedDataSet    ( )                               ;
+
+    ///
+    /// \brief build Quantizes all the points of a data set stream. The range
+    ///              is taken from the file header, and the stream read once.
+    /// \param stream the data set stream
+    /// \param type Quantize8 or Quantize16
+    /// \return true/false
+    ///
+    bool                build               (DataSetStream&         stream,
+                                             const QuantizationType type)     ;
+
+    size_t              size                ( )                         const
+    { return m_nb_points; }
+
+    size_t              dim                 ( )                         const
+    { return m_nb_dimension; }
+
+    QuantizationType    type                ( )                         const
+    { return m_type; }
+
+    // the codes of the ith point (Quantize8 data sets)
+    const int8_t*       codes8              (const size_t i)            const
+    { return &m_codes8[i * m_nb_dimension]; }
+
+    // the codes of the ith point (Quantize16 data sets)
+    const int16_t*      codes16             (const size_t i)            const
+    { return &m_codes16[i * m_nb_dimension]; }
+
+    // the weight of each dimension in the distance: scale[d]^2
+    const float*        weights             ( )                         const
+    { return &m_weights[0]; }
+
+    // converts coordinates to the (real valued) code space
+    void                toCodeSpace         (const Coord* coords,
+                                             float*       codes)        const ;
+
+    // converts a point of the code space to coordinates
+    void                fromCodeSpace       (const double* codes,
+                                             Coord*        coords)      const ;
+
+    // the memory used by the codes, in bytes
+    size_t              memorySize          ( )                         const ;
+
+///////////////////////////////////////////////////////////////////////////////
+    private:
+///////////////////////////////////////////////////////////////////////////////
+
+    // computes the scale and offset of each dimension, from its range
+    void                init                (const size_t              nbPoints,
+                                             const std::vector<Coord>& minCoord,
+                                             const std::vector<Coord>& maxCoord,
+                                             const QuantizationType    type)  ;
+
+    // quantizes the coordinates of the point i
+    void                encode              (const size_t i,
+                                             const Coord* coords)             ;
+
+    QuantizationType        m_type                                            ;
+    size_t                  m_nb_points                                       ;
+    size_t                  m_nb_dimension                                    ;
+    std::vector<double>     m_scale                                           ;
+    std::vector<double>     m_offset                                          ;
+    std::vector<float>      m_weights                                         ;
+    std::vector<int8_t>     m_codes8                                          ;
+    std::vector<int16_t>    m_codes16                                         ;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// the codes of the ith point, for the code type T (int8_t or int16_t)
+template<class T>
+const T* quantizedCodes(const QuantizedDataSet& qds, const size_t i);
+
+template<>
+inline const int8_t* quantizedCodes<int8_t>(const QuantizedDataSet& qds, const size_t i)
+{ return qds.codes8(i); }
+
+template<>
+inline const int16_t* quantizedCodes<int16_t>(const QuantizedDataSet& qds, const size_t i)
+{ return qds.codes16(i); }
+
+////////////////////////////////////////////////////////////////////////////////
+///
+/// \brief closestQuantizedCentroid The closest centroid to a quantized point
+/// \param codes      the point codes
+/// \param centroids  nbCentroid x dim centroids, in the code space
+/// \param weights    the weight of each dimension (QuantizedDataSet::weights)
+/// \param nbCentroid number of centroids
+/// \param dim        dimension
+/// \param minDist    the square distance to the closest centroid
+/// \return the index of the closest centroid (the first one, on ties)
+///
+template<class T>
+inline size_t closestQuantizedCentroid(const T*     codes,
+                                       const float* centroids,
+                                       const float* weights,
+                                       const size_t nbCentroid,
+                                       const size_t dim,
+                                       float&       minDist)
+{
+    size_t closest = 0;
+    for(size_t cid=0; cid<nbCentroid; cid++)
+    {
+        const float* c = centroids + cid * dim;
+        float dist = 0;
+        for(size_t d=0; d<dim; d++)
+        {
+            const float diff = (float)codes[d] - c[d];
+            dist += weights[d] * diff * diff;
+        }
+        if(cid == 0 || dist < minDist)
+        {
+            minDist = dist;
+            closest = cid;
+        }
+    }
+    return closest;
+}
+
+#endif
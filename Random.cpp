@@ -1,12 +1,68 @@
 #include <cmath>
 #include <time.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <random>
 #include "Random.h"
 
+//
+// The random state of a thread, when seeded (see ThreadRandomSeed): its
+// generator, and the second value of the last Box-Muller draw.
+//
+struct ThreadRandomState
+{
+    ThreadRandomState(const size_t seed)
+        :   m_generator(seed)
+        ,   m_normal(0.0)
+        ,   m_bNormal(false)
+    { }
+
+    std::mt19937    m_generator;
+    double          m_normal;
+    bool            m_bNormal;
+};
+
+// the state of the thread, if seeded
+static thread_local ThreadRandomState* s_threadState = 0;
+
+// the second value of the last Box-Muller draw of rand(), per thread
+static thread_local double s_normal  = 0.0;
+static thread_local bool   s_bNormal = false;
+
+////////////////////////////////////////////////////////////////////////////////
+
+ThreadRandomSeed::ThreadRandomSeed(const size_t seed)
+    :   m_previous(s_threadState)
+{
+    s_threadState = new ThreadRandomState(seed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ThreadRandomSeed::~ThreadRandomSeed( )
+{
+    // the state of an enclosing instance is restored
+    delete s_threadState;
+    s_threadState = m_previous;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int randomInteger( )
+{
+    if(s_threadState)
+    {
+        return (int)(s_threadState->m_generator() % ((unsigned int)RAND_MAX + 1));
+    }
+    return rand();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 double randomNormal(double mean, double stddev)
 {   //Box muller method
-    static double n2 = 0.0;
-    static int n2_cached = 0;
+    double& n2        = s_threadState ? s_threadState->m_normal  : s_normal;
+    bool&   n2_cached = s_threadState ? s_threadState->m_bNormal : s_bNormal;
 
     if (!n2_cached)
     {
@@ -15,8 +71,8 @@ double randomNormal(double mean, double stddev)
         double r = 0.0;
         do
         {
-            x = 2.0*rand()/RAND_MAX - 1;
-            y = 2.0*rand()/RAND_MAX - 1;
+            x = 2.0*randomInteger()/RAND_MAX - 1;
+            y = 2.0*randomInteger()/RAND_MAX - 1;
 
             r = x*x + y*y;
         }
@@ -26,13 +82,13 @@ double randomNormal(double mean, double stddev)
             double n1 = x*d;
             n2 = y*d;
             double result = n1*stddev + mean;
-            n2_cached = 1;
+            n2_cached = true;
             return result;
         }
     }
     else
     {
-        n2_cached = 0;
+        n2_cached = false;
         return n2*stddev + mean;
     }
 }
@@ -41,7 +97,7 @@ double randomNormal(double mean, double stddev)
 
 double randomValue(const double min_val, const double max_val)
 {
-    double v =  min_val + (max_val-min_val) * ((rand() % RAND_MAX)/(double)RAND_MAX);
+    double v =  min_val + (max_val-min_val) * ((randomInteger() % RAND_MAX)/(double)RAND_MAX);
     return v;
 }
 
@@ -49,7 +105,15 @@ double randomValue(const double min_val, const double max_val)
 
 size_t intRandomValue(const size_t max_val)
 {
-    return (rand() % max_val);
+    return (randomInteger() % max_val);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t randomIndex(const size_t nb)
+{
+    const uint64_t r = ((uint64_t)randomInteger() << 31) ^ (uint64_t)randomInteger();
+    return r % nb;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -2,6 +2,37 @@
 #define _Random_h_
 
 #include <vector>
+
+struct ThreadRandomState;
+
+///
+/// \brief ThreadRandomSeed While this object exists, the random values of
+///                         the calling thread come from its own generator,
+///                         seeded with 'seed', instead of rand(). Used by
+///                         concurrent runs that must not share rand().
+///                         The instances may be nested: the generator of
+///                         the enclosing one is restored on destruction.
+///
+class ThreadRandomSeed
+{
+public:
+    ThreadRandomSeed(const size_t seed);
+    ~ThreadRandomSeed( );
+
+private:
+    ThreadRandomSeed(const ThreadRandomSeed&);
+    ThreadRandomSeed& operator=(const ThreadRandomSeed&);
+
+    ThreadRandomState*  m_previous;
+};
+
+///
+/// \brief randomInteger rand(), or the generator of the thread (see
+///                      ThreadRandomSeed)
+/// \return an integer in [0, RAND_MAX]
+///
+int randomInteger( );
+
 ///
 /// \brief randomValue returns a random double number in the given interval
 /// \param min_val
@@ -16,6 +47,14 @@ double randomValue(const double min_val, const double max_val);
 ///
 size_t intRandomValue(const size_t maxVal);
 
+///
+/// \brief randomIndex random index in [0, nb), from 62 random bits: for more
+///                    than RAND_MAX values (intRandomValue is below RAND_MAX)
+/// \param nb
+/// \return
+///
+size_t randomIndex(const size_t nb);
+
 double randomNormal(double mean, double stddev);
 
 std::vector<double> getRandomVector(const size_t    iNb,
@@ -0,0 +1,749 @@
+#include <stdio.h>
+#include <algorithm>
+#include <random>
+
+#include "BatchAssigner.h"
+#include "FixedPoint.h"
+#include "Parallel.h"
+#include "Random.h"
+#include "StreamKMeans.h"
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Assigns the points of a block to their closest centroid, and accumulates
+// the centroid sums. Each chunk of the block has its own accumulators, so
+// the chunks can run concurrently.
+//
+template<class Dim>
+class StreamAssignTask : public ParallelTask
+{
+public:
+    StreamAssignTask(const size_t nbChunks,
+                     const size_t nbCluster,
+                     const size_t dim)
+        :   m_nbChunks(nbChunks)
+        ,   m_nbCluster(nbCluster)
+        ,   m_dim(dim)
+        ,   m_centroids(0)
+        ,   m_block(0)
+        ,   m_nbPoints(0)
+        ,   m_sums(nbChunks)
+        ,   m_counts(nbChunks)
+        ,   m_inertia(nbChunks)
+    {
+    }
+
+    // clears the accumulators, before a pass
+    void reset(const Coord* centroids)
+    {
+        m_centroids = centroids;
+        for(size_t i=0; i<m_nbChunks; i++)
+        {
+            m_sums[i].assign(m_nbCluster * m_dim, 0.0);
+            m_counts[i].assign(m_nbCluster, 0);
+            m_inertia[i] = 0.0;
+        }
+        if(m_nbCluster >= BatchAssignMinCentroids)
+        {
+            m_assigner.setCentroids(centroids, m_nbCluster, m_dim);
+        }
+    }
+
+    void setBlock(const Coord* block, const size_t nbPoints)
+    {
+        m_block    = block;
+        m_nbPoints = nbPoints;
+    }
+
+    virtual void run(const size_t chunkIdx)
+    {
+        size_t begin = 0;
+        size_t end   = 0;
+        chunkRange(m_nbPoints, m_nbChunks, chunkIdx, begin, end);
+
+        CoordSum* sums   = &m_sums[chunkIdx][0];
+        size_t*   counts = &m_counts[chunkIdx][0];
+        double    inertia = 0.0;
+        if(m_nbCluster >= BatchAssignMinCentroids)
+        {
+            if(begin == end) return;
+
+            // the whole chunk at once
+            std::vector<size_t>       closest(end - begin, m_nbCluster);
+            std::vector<DistanceType> dist(end - begin);
+            m_assigner.assign(m_block + begin * m_dim, end - begin, &closest[0], &dist[0]);
+            for(size_t i=begin; i<end; i++)
+            {
+                const size_t cid = closest[i - begin];
+                Dim::accumulate(sums + cid * m_dim, m_block + i * m_dim, m_dim);
+                counts[cid]++;
+                inertia += dist[i - begin];
+            }
+        }
+        else for(size_t i=begin; i<end; i++)
+        {
+            const Coord* p = m_block + i * m_dim;
+            DistanceType dist = 0;
+            const size_t cid = closestCentroid<Dim>(p, m_centroids, m_nbCluster, m_dim, dist);
+
+            Dim::accumulate(sums + cid * m_dim, p, m_dim);
+            counts[cid]++;
+            inertia += dist;
+        }
+        m_inertia[chunkIdx] += inertia;
+    }
+
+    // adds the accumulators of all the chunks
+    double reduce(std::vector<CoordSum>& sums, std::vector<size_t>& counts)const
+    {
+        sums.assign(m_nbCluster * m_dim, 0.0);
+        counts.assign(m_nbCluster, 0);
+        double inertia = 0.0;
+        for(size_t i=0; i<m_nbChunks; i++)
+        {
+            for(size_t j=0; j<sums.size(); j++)   sums[j]   += m_sums[i][j];
+            for(size_t j=0; j<counts.size(); j++) counts[j] += m_counts[i][j];
+            inertia += m_inertia[i];
+        }
+        return inertia;
+    }
+
+    const size_t                        m_nbChunks;
+    const size_t                        m_nbCluster;
+    const size_t                        m_dim;
+    const Coord*                        m_centroids;
+    BatchAssigner                       m_assigner;
+    const Coord*                        m_block;
+    size_t                              m_nbPoints;
+    std::vector<std::vector<CoordSum> > m_sums;
+    std::vector<std::vector<size_t> >   m_counts;
+    std::vector<double>                 m_inertia;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Assigns the quantized points to their closest centroid (in the code space),
+// and accumulates the code sums of each cluster, per chunk.
+//
+template<class T>
+class QuantizedAssignTask : public ParallelTask
+{
+public:
+    QuantizedAssignTask(const QuantizedDataSet& qds,
+                        const size_t            nbChunks,
+                        const size_t            nbCluster)
+        :   m_qds(qds)
+        ,   m_nbChunks(nbChunks)
+        ,   m_nbCluster(nbCluster)
+        ,   m_dim(qds.dim())
+        ,   m_centroids(0)
+        ,   m_assignment(qds.size(), nbCluster)
+        ,   m_sums(nbChunks)
+        ,   m_counts(nbChunks)
+        ,   m_nbMove(nbChunks)
+    {
+    }
+
+    void reset(const float* centroids)
+    {
+        m_centroids = centroids;
+        for(size_t i=0; i<m_nbChunks; i++)
+        {
+            m_sums[i].assign(m_nbCluster * m_dim, 0.0);
+            m_counts[i].assign(m_nbCluster, 0);
+            m_nbMove[i] = 0;
+        }
+    }
+
+    virtual void run(const size_t chunkIdx)
+    {
+        size_t begin = 0;
+        size_t end   = 0;
+        chunkRange(m_qds.size(), m_nbChunks, chunkIdx, begin, end);
+
+        double* sums   = &m_sums[chunkIdx][0];
+        size_t* counts = &m_counts[chunkIdx][0];
+        size_t  nbMove = 0;
+        for(size_t i=begin; i<end; i++)
+        {
+            const T* codes = quantizedCodes<T>(m_qds, i);
+            float dist = 0;
+            const size_t cid = closestQuantizedCentroid(codes, m_centroids, m_qds.weights(),
+                                                        m_nbCluster, m_dim, dist);
+            if(cid != m_assignment[i])
+            {
+                m_assignment[i] = cid;
+                nbMove++;
+            }
+            for(size_t d=0; d<m_dim; d++)
+            {
+                sums[cid * m_dim + d] += codes[d];
+            }
+            counts[cid]++;
+        }
+        m_nbMove[chunkIdx] = nbMove;
+    }
+
+    // adds the accumulators of all the chunks, returns the number of moves
+    size_t reduce(std::vector<double>& sums, std::vector<size_t>& counts)const
+    {
+        sums.assign(m_nbCluster * m_dim, 0.0);
+        counts.assign(m_nbCluster, 0);
+        size_t nbMove = 0;
+        for(size_t i=0; i<m_nbChunks; i++)
+        {
+            for(size_t j=0; j<sums.size(); j++)   sums[j]   += m_sums[i][j];
+            for(size_t j=0; j<counts.size(); j++) counts[j] += m_counts[i][j];
+            nbMove += m_nbMove[i];
+        }
+        return nbMove;
+    }
+
+    const QuantizedDataSet&             m_qds;
+    const size_t                        m_nbChunks;
+    const size_t                        m_nbCluster;
+    const size_t                        m_dim;
+    const float*                        m_centroids;
+    std::vector<size_t>                 m_assignment;
+    std::vector<std::vector<double> >   m_sums;
+    std::vector<std::vector<size_t> >   m_counts;
+    std::vector<size_t>                 m_nbMove;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// picks nbCluster points at random on the whole stream (reservoir sampling).
+// Returns false on a read error.
+static bool pickInitialCentroids(DataSetStream&      stream,
+                                 const size_t        nbCluster,
+                                 std::vector<Coord>& centroids)
+{
+    const size_t dim = stream.dim();
+    centroids.assign(nbCluster * dim, 0.0);
+
+    stream.rewind();
+    for(size_t nb=stream.nextBlock(); nb>0; nb=stream.nextBlock())
+    {
+        for(size_t i=0; i<nb; i++)
+        {
+            const size_t pid = stream.blockBegin() + i;
+            const size_t cid = (pid < nbCluster) ? pid : randomIndex(pid + 1);
+            if(cid < nbCluster)
+            {
+                const Coord* p = stream.block() + i * dim;
+                std::copy(p, p + dim, &centroids[cid * dim]);
+            }
+        }
+    }
+    return !stream.failed();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// A full assignment pass: on the stream, or on the data set. Returns the
+// inertia, or -1 on a read error.
+template<class Dim>
+static double assignAll(StreamAssignTask<Dim>& task,
+                        DataSetStream&         stream,
+                        std::vector<CoordSum>& sums,
+                        std::vector<size_t>&   counts)
+{
+    stream.rewind();
+    for(size_t nb=stream.nextBlock(); nb>0; nb=stream.nextBlock())
+    {
+        task.setBlock(stream.block(), nb);
+        parallelFor(task, task.m_nbChunks);
+    }
+    if(stream.failed())
+    {
+        return -1.0;
+    }
+    return task.reduce(sums, counts);
+}
+
+template<class Dim>
+static double assignAll(StreamAssignTask<Dim>& task,
+                        const DataSet&         ds,
+                        std::vector<CoordSum>& sums,
+                        std::vector<size_t>&   counts)
+{
+    task.setBlock(ds.coordBlock(), ds.size());
+    parallelFor(task, task.m_nbChunks);
+    return task.reduce(sums, counts);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<class Dim>
+static double computeStreamKMeans_(DataSetStream&       stream,
+                                   const size_t         nbCluster,
+                                   const size_t         maxIter,
+                                   std::vector<Coord>&  centroids,
+                                   std::vector<size_t>& counts,
+                                   const bool           bVerbose)
+{
+    const size_t dim = stream.dim();
+
+    StreamAssignTask<Dim>  task(getNbThreads(), nbCluster, dim);
+    std::vector<CoordSum>  sums;
+
+    for(size_t iter=0; iter<maxIter; iter++)
+    {
+        // one pass on the stream
+        task.reset(&centroids[0]);
+        const double inertia = assignAll(task, stream, sums, counts);
+        if(inertia < 0)
+        {
+            return inertia;
+        }
+
+        // new centroids. An empty cluster keeps its centroid.
+        bool bMoved = false;
+        for(size_t cid=0; cid<nbCluster; cid++)
+        {
+            if(counts[cid] == 0) continue;
+            for(size_t d=0; d<dim; d++)
+            {
+                const Coord c = sums[cid * dim + d] / (double)counts[cid];
+                bMoved = bMoved || (c != centroids[cid * dim + d]);
+                centroids[cid * dim + d] = c;
+            }
+        }
+        if(bVerbose)
+        {
+            fprintf(stdout, "*** Stream iteration %ld, inertia (before the update): %g\n", iter, inertia);
+        }
+        // no centroid moved: the inertia and the sizes are those of the centroids
+        if(!bMoved)
+        {
+            return inertia;
+        }
+    }
+
+    // a last pass: the inertia and the sizes of the updated centroids
+    task.reset(&centroids[0]);
+    return assignAll(task, stream, sums, counts);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double computeStreamKMeans(DataSetStream&       stream,
+                           const size_t         nbCluster,
+                           const size_t         maxIter,
+                           std::vector<Point>&  centroids,
+                           std::vector<size_t>& clusterSize,
+                           const bool           bVerbose)
+{
+    centroids.resize(0);
+    clusterSize.resize(0);
+    if(stream.size() < nbCluster || nbCluster == 0)
+    {
+        fprintf(stdout, "Error: cannot compute %ld clusters on %ld points\n",
+                nbCluster, stream.size());
+        return 0.0;
+    }
+    const size_t dim = stream.dim();
+
+    std::vector<Coord> coords;
+    if(!pickInitialCentroids(stream, nbCluster, coords))
+    {
+        return 0.0;
+    }
+
+    double inertia = 0.0;
+    switch(dim)
+    {
+        case 2:  inertia = computeStreamKMeans_< FixedDim<2> >(stream, nbCluster, maxIter, coords, clusterSize, bVerbose); break;
+        case 3:  inertia = computeStreamKMeans_< FixedDim<3> >(stream, nbCluster, maxIter, coords, clusterSize, bVerbose); break;
+        case 4:  inertia = computeStreamKMeans_< FixedDim<4> >(stream, nbCluster, maxIter, coords, clusterSize, bVerbose); break;
+        default: inertia = computeStreamKMeans_< FixedDim<0> >(stream, nbCluster, maxIter, coords, clusterSize, bVerbose); break;
+    }
+    if(inertia < 0)
+    {
+        clusterSize.resize(0);
+        return 0.0;
+    }
+    for(size_t cid=0; cid<nbCluster; cid++)
+    {
+        centroids.push_back(Point(cid, Point::CoordVector(&coords[cid * dim], &coords[cid * dim] + dim)));
+    }
+    return inertia;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Lloyd iterations on the quantized points. The centroids are in the code space.
+template<class T>
+static void computeQuantizedKMeans_(const QuantizedDataSet& qds,
+                                    const size_t            nbCluster,
+                                    const size_t            maxIter,
+                                    std::vector<float>&     centroids,
+                                    const bool              bVerbose)
+{
+    const size_t dim = qds.dim();
+
+    QuantizedAssignTask<T> task(qds, getNbThreads(), nbCluster);
+    std::vector<double>    sums;
+    std::vector<size_t>    counts;
+
+    for(size_t iter=0; iter<maxIter; iter++)
+    {
+        task.reset(&centroids[0]);
+        parallelFor(task, task.m_nbChunks);
+        const size_t nbMove = task.reduce(sums, counts);
+
+        // new centroids. An empty cluster keeps its centroid.
+        for(size_t cid=0; cid<nbCluster; cid++)
+        {
+            if(counts[cid] == 0) continue;
+            for(size_t d=0; d<dim; d++)
+            {
+                centroids[cid * dim + d] = sums[cid * dim + d] / (double)counts[cid];
+            }
+        }
+        if(bVerbose)
+        {
+            fprintf(stdout, "*** Quantized iteration %ld, moving points: %ld\n", iter, nbMove);
+        }
+        if(nbMove == 0) break;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double computeQuantizedStreamKMeans(DataSetStream&         stream,
+                                    const QuantizationType type,
+                                    const size_t           nbCluster,
+                                    const size_t           maxIter,
+                                    std::vector<Point>&    centroids,
+                                    std::vector<size_t>&   clusterSize,
+                                    const bool             bVerbose)
+{
+    centroids.resize(0);
+    clusterSize.resize(0);
+    if(stream.size() < nbCluster || nbCluster == 0)
+    {
+        fprintf(stdout, "Error: cannot compute %ld clusters on %ld points\n",
+                nbCluster, stream.size());
+        return 0.0;
+    }
+    QuantizedDataSet qds;
+    if(!qds.build(stream, type))
+    {
+        return 0.0;
+    }
+    if(bVerbose)
+    {
+        fprintf(stdout, "* Quantized data set: %d bits, %ld bytes\n", (int)type, qds.memorySize());
+    }
+    const size_t dim = stream.dim();
+
+    // the iterations on the codes
+    std::vector<Coord> coords;
+    if(!pickInitialCentroids(stream, nbCluster, coords))
+    {
+        return 0.0;
+    }
+
+    std::vector<float> codeCentroids(nbCluster * dim);
+    for(size_t cid=0; cid<nbCluster; cid++)
+    {
+        qds.toCodeSpace(&coords[cid * dim], &codeCentroids[cid * dim]);
+    }
+    if(type == Quantize8)
+    {
+        computeQuantizedKMeans_<int8_t> (qds, nbCluster, maxIter, codeCentroids, bVerbose);
+    }
+    else
+    {
+        computeQuantizedKMeans_<int16_t>(qds, nbCluster, maxIter, codeCentroids, bVerbose);
+    }
+    std::vector<double> codes(codeCentroids.begin(), codeCentroids.end());
+    for(size_t cid=0; cid<nbCluster; cid++)
+    {
+        qds.fromCodeSpace(&codes[cid * dim], &coords[cid * dim]);
+    }
+
+    // the last iteration, at full precision. It is followed by an assignment
+    // pass if the centroids moved: the inertia and the sizes are those of
+    // the returned centroids.
+    const size_t lastPass = 1;
+    double inertia = 0.0;
+    switch(dim)
+    {
+        case 2:  inertia = computeStreamKMeans_< FixedDim<2> >(stream, nbCluster, lastPass, coords, clusterSize, bVerbose); break;
+        case 3:  inertia = computeStreamKMeans_< FixedDim<3> >(stream, nbCluster, lastPass, coords, clusterSize, bVerbose); break;
+        case 4:  inertia = computeStreamKMeans_< FixedDim<4> >(stream, nbCluster, lastPass, coords, clusterSize, bVerbose); break;
+        default: inertia = computeStreamKMeans_< FixedDim<0> >(stream, nbCluster, lastPass, coords, clusterSize, bVerbose); break;
+    }
+    if(inertia < 0)
+    {
+        clusterSize.resize(0);
+        return 0.0;
+    }
+    for(size_t cid=0; cid<nbCluster; cid++)
+    {
+        centroids.push_back(Point(cid, Point::CoordVector(&coords[cid * dim], &coords[cid * dim] + dim)));
+    }
+    return inertia;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Assigns the points of a mini-batch to their closest centroid, by chunks.
+//
+template<class Dim>
+class MiniBatchAssignTask : public ParallelTask
+{
+public:
+    MiniBatchAssignTask(const size_t nbChunks,
+                        const size_t nbCluster,
+                        const size_t dim)
+        :   m_nbChunks(nbChunks)
+        ,   m_nbCluster(nbCluster)
+        ,   m_dim(dim)
+        ,   m_centroids(0)
+    {
+    }
+
+    void reset(const Coord* centroids, const std::vector<const Coord*>& points)
+    {
+        m_centroids = centroids;
+        m_points    = &points;
+        m_closest.assign(points.size(), m_nbCluster);
+        if(m_nbCluster >= BatchAssignMinCentroids)
+        {
+            m_assigner.setCentroids(centroids, m_nbCluster, m_dim);
+        }
+    }
+
+    virtual void run(const size_t chunkIdx)
+    {
+        size_t begin = 0;
+        size_t end   = 0;
+        chunkRange(m_points->size(), m_nbChunks, chunkIdx, begin, end);
+        if(begin == end) return;
+
+        const Coord* const* points = &(*m_points)[0];
+        if(m_nbCluster >= BatchAssignMinCentroids)
+        {
+            m_assigner.assign(points + begin, end - begin, &m_closest[begin], 0);
+        }
+        else for(size_t i=begin; i<end; i++)
+        {
+            DistanceType dist = 0;
+            m_closest[i] = closestCentroid<Dim>(points[i], m_centroids, m_nbCluster, m_dim, dist);
+        }
+    }
+
+    const size_t                        m_nbChunks;
+    const size_t                        m_nbCluster;
+    const size_t                        m_dim;
+    const Coord*                        m_centroids;
+    const std::vector<const Coord*>*    m_points;
+    BatchAssigner                       m_assigner;
+    std::vector<size_t>                 m_closest;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// The points of a mini-batch: read from the file, or views on the data set.
+static bool readBatch(DataSetStream&             stream,
+                      const std::vector<size_t>& pids,
+                      std::vector<Coord>&        buffer,
+                      std::vector<const Coord*>& points)
+{
+    const size_t dim = stream.dim();
+    buffer.resize(pids.size() * dim);
+    points.resize(pids.size());
+    for(size_t i=0; i<pids.size(); i++)
+    {
+        if(!stream.readPoint(pids[i], &buffer[i * dim]))
+        {
+            return false;
+        }
+        points[i] = &buffer[i * dim];
+    }
+    return true;
+}
+
+static bool readBatch(const DataSet&             ds,
+                      const std::vector<size_t>& pids,
+                      std::vector<Coord>&        ,
+                      std::vector<const Coord*>& points)
+{
+    points.resize(pids.size());
+    for(size_t i=0; i<pids.size(); i++)
+    {
+        points[i] = ds.coords(pids[i]);
+    }
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<class Dim, class Source>
+static double computeMiniBatchKMeans_(Source&              source,
+                                      const size_t         nbPoints,
+                                      const size_t         dim,
+                                      const size_t         nbCluster,
+                                      const size_t         batchSize,
+                                      const size_t         nbStep,
+                                      const size_t         seed,
+                                      std::vector<Coord>&  centroids,
+                                      std::vector<size_t>& clusterSize,
+                                      const bool           bVerbose)
+{
+    std::mt19937_64                       generator(seed);
+    std::uniform_int_distribution<size_t> pick(0, nbPoints - 1);
+
+    std::vector<size_t>       pids;
+    std::vector<Coord>        buffer;
+    std::vector<const Coord*> points;
+
+    // the initial centroids: nbCluster distinct random points (on huge
+    // data sets, a duplicate is unlikely and is not checked)
+    std::vector<char> picked(nbPoints < 100000000 ? nbPoints : 0, 0);
+    while(pids.size() < nbCluster)
+    {
+        const size_t pid = pick(generator);
+        if(!picked.empty())
+        {
+            if(picked[pid]) continue;
+            picked[pid] = 1;
+        }
+        pids.push_back(pid);
+    }
+    if(!readBatch(source, pids, buffer, points))
+    {
+        return 0.0;
+    }
+    centroids.resize(nbCluster * dim);
+    for(size_t cid=0; cid<nbCluster; cid++)
+    {
+        std::copy(points[cid], points[cid] + dim, &centroids[cid * dim]);
+    }
+
+    // the steps
+    MiniBatchAssignTask<Dim> task(getNbThreads(), nbCluster, dim);
+    std::vector<size_t>      counts(nbCluster, 0);
+    const size_t             printStep = std::max((size_t)1, nbStep / 10);
+    for(size_t step=0; step<nbStep; step++)
+    {
+        // the batch, read in the file order
+        pids.resize(batchSize);
+        for(size_t i=0; i<batchSize; i++)
+        {
+            pids[i] = pick(generator);
+        }
+        std::sort(pids.begin(), pids.end());
+        if(!readBatch(source, pids, buffer, points))
+        {
+            return 0.0;
+        }
+        task.reset(&centroids[0], points);
+        parallelFor(task, task.m_nbChunks);
+
+        // each centroid moves towards its points, with a decreasing rate
+        double inertia = 0.0;
+        for(size_t i=0; i<batchSize; i++)
+        {
+            const size_t cid = task.m_closest[i];
+            Coord*       c   = &centroids[cid * dim];
+            inertia += Dim::squareDistance(points[i], c, dim);
+
+            counts[cid]++;
+            const double rate = 1.0 / (double)counts[cid];
+            for(size_t d=0; d<dim; d++)
+            {
+                c[d] += rate * (points[i][d] - c[d]);
+            }
+        }
+        if(bVerbose && (step % printStep == 0 || step + 1 == nbStep))
+        {
+            fprintf(stdout, "*** Mini-batch step %ld, batch inertia: %g\n", step, inertia);
+        }
+    }
+
+    // the last pass: all the points are assigned
+    StreamAssignTask<Dim>  assign(getNbThreads(), nbCluster, dim);
+    std::vector<CoordSum>  sums;
+    assign.reset(&centroids[0]);
+    const double inertia = assignAll(assign, source, sums, clusterSize);
+    if(inertia < 0)
+    {
+        clusterSize.resize(0);
+    }
+    return inertia;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<class Source>
+static double miniBatchKMeans(Source&              source,
+                              const size_t         nbPoints,
+                              const size_t         dim,
+                              const size_t         nbCluster,
+                              const size_t         batchSize,
+                              const size_t         nbStep,
+                              const size_t         seed,
+                              std::vector<Point>&  centroids,
+                              std::vector<size_t>& clusterSize,
+                              const bool           bVerbose)
+{
+    centroids.resize(0);
+    clusterSize.resize(0);
+    if(nbPoints < nbCluster || nbCluster == 0 || batchSize == 0)
+    {
+        fprintf(stdout, "Error: cannot compute %ld clusters on %ld points, batch size %ld\n",
+                nbCluster, nbPoints, batchSize);
+        return 0.0;
+    }
+
+    std::vector<Coord> coords;
+    double inertia = 0.0;
+    switch(dim)
+    {
+        case 2:  inertia = computeMiniBatchKMeans_< FixedDim<2> >(source, nbPoints, dim, nbCluster, batchSize, nbStep, seed, coords, clusterSize, bVerbose); break;
+        case 3:  inertia = computeMiniBatchKMeans_< FixedDim<3> >(source, nbPoints, dim, nbCluster, batchSize, nbStep, seed, coords, clusterSize, bVerbose); break;
+        case 4:  inertia = computeMiniBatchKMeans_< FixedDim<4> >(source, nbPoints, dim, nbCluster, batchSize, nbStep, seed, coords, clusterSize, bVerbose); break;
+        default: inertia = computeMiniBatchKMeans_< FixedDim<0> >(source, nbPoints, dim, nbCluster, batchSize, nbStep, seed, coords, clusterSize, bVerbose); break;
+    }
+    if(clusterSize.size() != nbCluster)
+    {
+        return 0.0;
+    }
+    for(size_t cid=0; cid<nbCluster; cid++)
+    {
+        centroids.push_back(Point(cid, Point::CoordVector(&coords[cid * dim], &coords[cid * dim] + dim)));
+    }
+    return inertia;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double computeMiniBatchKMeans(DataSetStream&       stream,
+                              const size_t         nbCluster,
+                              const size_t         batchSize,
+                              const size_t         nbStep,
+                              const size_t         seed,
+                              std::vector<Point>&  centroids,
+                              std::vector<size_t>& clusterSize,
+                              const bool           bVerbose)
+{
+    return miniBatchKMeans(stream, stream.size(), stream.dim(), nbCluster, 
+                           batchSize, nbStep, seed, centroids, clusterSize, bVerbose);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+double computeMiniBatchKMeans(const DataSet&       ds,
+                              const size_t         nbCluster,
+                              const size_t         batchSize,
+                              const size_t         nbStep,
+                              const size_t         seed,
+                              std::vector<Point>&  centroids,
+                              std::vector<size_t>& clusterSize,
+                              const bool           bVerbose)
+{
+    return miniBatchKMeans(ds, ds.size(), ds.dim(), nbCluster, 
+                           batchSize, nbStep, seed, centroids, clusterSize, bVerbose);
+}
+
+////////////////////////////////////////////////////////////////////////////////
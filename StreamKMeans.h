@@ -0,0 +1,94 @@
+#ifndef _StreamKMeans_h_
+#define _StreamKMeans_h_
+
+#include <vector>
+#include "Point.h"
+#include "DataSet.h"
+#include "DataSetStream.h"
+#include "QuantizedDataSet.h"
+
+///
+/// \brief computeStreamKMeans Computes the K-Means of a data set read by
+///                            blocks (out-of-core). Each iteration is one
+///                            pass on the stream: the points of each block
+///                            are assigned to their closest centroid, and the
+///                            centroid sums are accumulated. The initial
+///                            centroids are nbCluster points picked at random
+///                            on the whole stream.
+/// \param stream       opened data set stream
+/// \param nbCluster    number of clusters
+/// \param maxIter      max number of iterations (passes)
+/// \param centroids    the computed centroids
+/// \param clusterSize  number of points of each cluster
+/// \param bVerbose     prints the iterations
+/// \return the total SSE (inertia) of the returned centroids (a last pass
+///         is run if the centroids moved in the last iteration). On a read
+///         error, the centroids and the sizes are empty.
+///
+double computeStreamKMeans(DataSetStream&       stream,
+                           const size_t         nbCluster,
+                           const size_t         maxIter,
+                           std::vector<Point>&  centroids,
+                           std::vector<size_t>& clusterSize,
+                           const bool           bVerbose);
+
+///
+/// \brief computeQuantizedStreamKMeans Same as computeStreamKMeans, but the
+///                            stream is read once and quantized in memory
+///                            (int8/int16). The iterations run on the codes;
+///                            a last full precision iteration on the stream
+///                            then assigns the points and computes the
+///                            centroids.
+/// \param type         Quantize8 or Quantize16
+/// \return the total SSE (inertia) of the returned centroids. On a read
+///         error, the centroids and the sizes are empty.
+///
+double computeQuantizedStreamKMeans(DataSetStream&         stream,
+                                    const QuantizationType type,
+                                    const size_t           nbCluster,
+                                    const size_t           maxIter,
+                                    std::vector<Point>&    centroids,
+                                    std::vector<size_t>&   clusterSize,
+                                    const bool             bVerbose);
+
+///
+/// \brief computeMiniBatchKMeans Mini-batch K-Means: each step draws a batch
+///                            of random points, assigns them to their
+///                            closest centroid, and moves each centroid
+///                            towards its points with a learning rate of
+///                            1 / (number of points it got so far). Each
+///                            step reads batchSize points only. A last full
+///                            pass on the stream assigns all the points.
+/// \param stream       opened data set stream
+/// \param nbCluster    number of clusters
+/// \param batchSize    number of points of a batch
+/// \param nbStep       number of steps (batches)
+/// \param seed         seed of the random batches
+/// \param centroids    the computed centroids
+/// \param clusterSize  number of points of each cluster (last pass)
+/// \param bVerbose     prints the steps
+/// \return the total SSE (inertia) of the last pass. On a read error, the
+///         centroids and the sizes are empty.
+///
+double computeMiniBatchKMeans(DataSetStream&       stream,
+                              const size_t         nbCluster,
+                              const size_t         batchSize,
+                              const size_t         nbStep,
+                              const size_t         seed,
+                              std::vector<Point>&  centroids,
+                              std::vector<size_t>& clusterSize,
+                              const bool           bVerbose);
+
+///
+/// \brief computeMiniBatchKMeans Same, on a data set in memory.
+///
+double computeMiniBatchKMeans(const DataSet&       ds,
+                              const size_t         nbCluster,
+                              const size_t         batchSize,
+                              const size_t         nbStep,
+                              const size_t         seed,
+                              std::vector<Point>&  centroids,
+                              std::vector<size_t>& clusterSize,
+                              const bool           bVerbose);
+
+#endif
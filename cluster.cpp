@@ -2,6 +2,8 @@
 #include  <stdio.h>
 
 #include "CommandLine.h"
+#include "Distance.h"
+#include "Parallel.h"
 #include "computeDBSCAN.h"
 #include "KMean.h"
 #include "KMeanTest.h"
@@ -29,8 +31,28 @@ struct CommandLineOptions
         m_outfile  = "data";
         m_maxIter  = 10;
         m_seed     = 45;
+        m_nbThreads= 0;
+        m_streamBlockSize = 0;
+        m_quantize = QuantizeNone;
+        m_method   = KMeansLloyd;
+        m_miniBatchSize = 0;
+        m_init     = RandomPartition;
+        m_nbInit   = 1;
+        m_kSweepMin = 0;
+        m_kSweepMax = 0;
+        m_bisectLeaves = 0;
+        m_bDedup   = false;
+        m_coresetSize = 0;
+        m_bCoresetAssign = false;
+        m_bKMedoids = false;
+        m_medoidMetric = MedoidEuclidean;
+        m_claraSamples = 0;
+        m_claraSampleSize = 0;
+        m_miniBatchStep = 0;
     }
     std::string m_dsfname;
+    std::string m_binfname;
+    std::string m_weightfname;
     std::string m_outfile;
     Command     m_command;
     double      m_eps;
@@ -38,6 +60,25 @@ struct CommandLineOptions
     size_t      m_seed;
     size_t      m_maxIter;
     size_t      m_minpts;
+    size_t      m_nbThreads;
+    size_t      m_streamBlockSize;
+    QuantizationType m_quantize;
+    KMeansMethod     m_method;
+    size_t      m_miniBatchSize;
+    size_t      m_miniBatchStep;
+    InitMethod  m_init;
+    KMeansTolerance  m_tol;
+    size_t      m_nbInit;
+    size_t      m_kSweepMin;
+    size_t      m_kSweepMax;
+    size_t      m_bisectLeaves;
+    bool        m_bDedup;
+    size_t      m_coresetSize;
+    bool        m_bCoresetAssign;
+    bool        m_bKMedoids;
+    MedoidMetric m_medoidMetric;
+    size_t      m_claraSamples;
+    size_t      m_claraSampleSize;
     bool        m_verbose;
 };
 
@@ -48,7 +89,10 @@ bool parseCommandLine(CommandLineOptions& options, const int argc, const char**
     if(argc <= 1)
     {
         fprintf(stdout, "%s\n", argv[0]);
-        fprintf(stdout, "   -ds <dsfname>           # input data set (csv) format\n");
+        fprintf(stdout, "   -ds <dsfname>           # input data set (csv or binary) format\n");
+        fprintf(stdout, "   -write-binary <fname>   # writes the data set in binary format\n");
+        fprintf(stdout, "   -weights <fname>        # weight of each point, one per line (K-mean, DBSCAN, not -stream, -minibatch)\n");
+        fprintf(stdout, "   -dedup                  # aggregates the duplicate points in weighted points\n");
         fprintf(stdout, "   -dbscan <minpts> <eps>\n");
         fprintf(stdout, "   -knn <n>                # K-mean with clusters\n");
         fprintf(stdout, "   -out <outfile>          # output file\n");
@@ -58,6 +102,24 @@ bool parseCommandLine(CommandLineOptions& options, const int argc, const char**
         fprintf(stdout, "   -dbscan-test            # run DBScan test\n");
         fprintf(stdout, "   -max-iter               # max nb iter (K-mean\n");
         fprintf(stdout, "   -seed <value>           # seed value for random generator\n");
+        fprintf(stdout, "   -threads <n>            # number of threads (default: all cores)\n");
+        fprintf(stdout, "   -stream [blockSize]     # K-mean on a binary data set, read by blocks\n");
+        fprintf(stdout, "   -quantize <8|16>        # K-mean on int8/int16 quantized coordinates (with -stream)\n");
+        fprintf(stdout, "   -distance-kernel <name> # scalar, sse2, avx2 or avx512 (default: best supported)\n");
+        fprintf(stdout, "   -kmeans-method <name>   # K-mean assignment: lloyd (default), elkan, hamerly, yinyang, filter (kd-tree)\n");
+        fprintf(stdout, "   -minibatch [size] [steps] # mini-batch K-mean (default: 1024 points, 1000 steps, see -seed)\n");
+        fprintf(stdout, "   -init <name>            # K-mean seeding: random (default), forgy, kmeans++, kmeans||\n");
+        fprintf(stdout, "   -tol-shift <value>      # K-mean stops when no centroid moves more than value\n");
+        fprintf(stdout, "   -tol-inertia <value>    # K-mean stops when the inertia decreases by less than value (relative)\n");
+        fprintf(stdout, "   -tol-moved <value>      # K-mean stops when less than a fraction value of the points move\n");
+        fprintf(stdout, "   -n-init <n>             # K-mean: n runs in parallel, the lowest inertia is kept (default: 1)\n");
+        fprintf(stdout, "   -ksweep <kmin> <kmax>   # K-mean of each k in [kmin, kmax]: inertia, elbow and silhouette table\n");
+        fprintf(stdout, "   -bisect <n>             # bisecting K-mean: cluster tree of n leaves\n");
+        fprintf(stdout, "   -coreset <size>         # K-mean on a weighted sample (coreset) of size points\n");
+        fprintf(stdout, "   -coreset-assign         # coreset K-mean: a last pass assigns all the points\n");
+        fprintf(stdout, "   -kmedoids [n]           # K-medoids (FasterPAM) with n clusters (default: 2)\n");
+        fprintf(stdout, "   -medoid-metric <name>   # K-medoids distance: l2 (default), sql2, l1, cosine\n");
+        fprintf(stdout, "   -clara [n] [size]       # K-medoids on n samples of size points (default: above 10000 points)\n");
         return true;
     }
     for(CommandLine arg(argc,argv); !arg.end();  )
@@ -71,6 +133,18 @@ bool parseCommandLine(CommandLineOptions& options, const int argc, const char**
         {
             options.m_dsfname = arg.next();
         }
+        else if(key == "-write-binary")
+        {
+            options.m_binfname = arg.next();
+        }
+        else if(key == "-weights")
+        {
+            options.m_weightfname = arg.next();
+        }
+        else if(key == "-dedup")
+        {
+            options.m_bDedup = true;
+        }
         else if(key == "-dbscan")
         {
             std::vector<double> next = arg.nextDoubleArray( );
@@ -107,6 +181,172 @@ bool parseCommandLine(CommandLineOptions& options, const int argc, const char**
         {
             options.m_seed = arg.nextInt();
         }
+        else if(key == "-threads")
+        {
+            options.m_nbThreads = arg.nextInt();
+        }
+        else if(key == "-stream")
+        {
+            // the block size is optional
+            options.m_streamBlockSize = arg.isCommand() ? 65536 : arg.nextInt(65536);
+        }
+        else if(key == "-distance-kernel")
+        {
+            if(!setDistanceKernel(arg.next()))
+            {
+                return false;
+            }
+        }
+        else if(key == "-quantize")
+        {
+            const size_t nbBits = arg.nextInt(8);
+            if(nbBits != 8 && nbBits != 16)
+            {
+                fprintf(stdout, "Error: -quantize: 8 or 16 bits expected\n");
+                return false;
+            }
+            options.m_quantize = (nbBits == 8) ? Quantize8 : Quantize16;
+        }
+        else if(key == "-minibatch")
+        {
+            // the batch size and the number of steps are optional
+            options.m_miniBatchSize = arg.isCommand() ? 1024 : arg.nextInt(1024);
+            options.m_miniBatchStep = arg.isCommand() ? 1000 : arg.nextInt(1000);
+            if(options.m_miniBatchSize == 0)
+            {
+                fprintf(stdout, "Error: -minibatch: the batch size must be > 0\n");
+                return false;
+            }
+        }
+        else if(key == "-init")
+        {
+            const std::string name = arg.next();
+            if     (name == "random")   options.m_init = RandomPartition;
+            else if(name == "forgy")    options.m_init = ForgyMethod;
+            else if(name == "kmeans++") options.m_init = KMeansPlusPlus;
+            else if(name == "kmeans||") options.m_init = KMeansParallel;
+            else
+            {
+                fprintf(stdout, "Error: unknown k-means seeding '%s'\n", name.c_str());
+                return false;
+            }
+        }
+        else if(key == "-ksweep")
+        {
+            options.m_command   = Command_KNN;
+            options.m_kSweepMin = arg.nextInt(2);
+            options.m_kSweepMax = arg.nextInt(options.m_kSweepMin);
+            if(options.m_kSweepMin == 0 || options.m_kSweepMax < options.m_kSweepMin)
+            {
+                fprintf(stdout, "Error: -ksweep: 0 < kmin <= kmax expected\n");
+                return false;
+            }
+        }
+        else if(key == "-bisect")
+        {
+            options.m_command      = Command_KNN;
+            options.m_bisectLeaves = arg.nextInt(2);
+            if(options.m_bisectLeaves == 0)
+            {
+                fprintf(stdout, "Error: -bisect: at least 1 leaf expected\n");
+                return false;
+            }
+        }
+        else if(key == "-coreset")
+        {
+            options.m_command     = Command_KNN;
+            options.m_coresetSize = arg.nextInt(0);
+            if(options.m_coresetSize == 0)
+            {
+                fprintf(stdout, "Error: -coreset: a size > 0 expected\n");
+                return false;
+            }
+        }
+        else if(key == "-coreset-assign")
+        {
+            options.m_bCoresetAssign = true;
+        }
+        else if(key == "-kmedoids")
+        {
+            options.m_command   = Command_KNN;
+            options.m_bKMedoids = true;
+            // the number of clusters is optional
+            const int nbCluster = arg.isCommand() ? 2 : arg.nextInt(2);
+            if(nbCluster < 1)
+            {
+                fprintf(stdout, "Error: -kmedoids: at least 1 cluster expected\n");
+                return false;
+            }
+            options.m_knn = nbCluster;
+        }
+        else if(key == "-medoid-metric")
+        {
+            if(!medoidMetricFromName(arg.next(), options.m_medoidMetric))
+            {
+                return false;
+            }
+        }
+        else if(key == "-clara")
+        {
+            // the number of samples and the sample size are optional
+            const int nbSample   = arg.isCommand() ? 5 : arg.nextInt(5);
+            const int sampleSize = arg.isCommand() ? 0 : arg.nextInt(0);
+            if(nbSample < 1 || sampleSize < 0)
+            {
+                fprintf(stdout, "Error: -clara: at least 1 sample expected\n");
+                return false;
+            }
+            options.m_claraSamples    = nbSample;
+            options.m_claraSampleSize = sampleSize;
+        }
+        else if(key == "-n-init")
+        {
+            const int nbInit = arg.nextInt(1);
+            if(nbInit < 1)
+            {
+                fprintf(stdout, "Error: -n-init: at least 1 run expected\n");
+                return false;
+            }
+            options.m_nbInit = nbInit;
+        }
+        else if(key == "-tol-shift")
+        {
+            options.m_tol.m_centroidShift = arg.nextDouble();
+        }
+        else if(key == "-tol-inertia")
+        {
+            options.m_tol.m_inertiaChange = arg.nextDouble();
+        }
+        else if(key == "-tol-moved")
+        {
+            options.m_tol.m_movedFraction = arg.nextDouble();
+        }
+        else if(key == "-kmeans-method")
+        {
+            if(!kmeansMethodFromName(arg.next(), options.m_method))
+            {
+                return false;
+            }
+        }
+    }
+    // the codes are read from the file: no full precision copy in memory
+    if(options.m_quantize != QuantizeNone && options.m_streamBlockSize == 0)
+    {
+        fprintf(stdout, "Error: -quantize needs a binary data set read by -stream\n");
+        return false;
+    }
+    // the weights are in memory only: not in the binary file, not read by
+    // the stream and mini-batch K-means
+    const bool bWeighted = !options.m_weightfname.empty() || options.m_bDedup;
+    if(bWeighted && !options.m_binfname.empty())
+    {
+        fprintf(stdout, "Error: -weights and -dedup cannot be used with -write-binary (no weights in binary files)\n");
+        return false;
+    }
+    if(bWeighted && (options.m_streamBlockSize > 0 || options.m_miniBatchSize > 0))
+    {
+        fprintf(stdout, "Error: -weights and -dedup cannot be used with -stream or -minibatch\n");
+        return false;
     }
     return true;
 }
@@ -117,15 +357,47 @@ int main(const int argc, const char** argv)
 {
     CommandLineOptions options;
     bool bOk = parseCommandLine(options, argc, argv);
+    setNbThreads(options.m_nbThreads);
 
-    DataSet ds;
-    if(bOk && !options.m_dsfname.empty())
+    DataSet input;
+    DataSet unique;
+    DataSet& ds = options.m_bDedup ? unique : input;
+    // the stream mode reads the data set during the computation
+    if(bOk && !options.m_dsfname.empty() && options.m_streamBlockSize == 0)
     {
         // opens te ds file
-        bOk = ds.read(options.m_dsfname);
+        bOk = input.read(options.m_dsfname);
+        if(bOk && !options.m_weightfname.empty())
+        {
+            bOk = input.readWeights(options.m_weightfname);
+        }
+        if(bOk && options.m_bDedup)
+        {
+            input.aggregateDuplicates(unique);
+        }
         fprintf(stdout, "* Data set '%s'\n", options.m_dsfname.c_str());
         fprintf(stdout, "  Size     %ld\n", ds.size());
         fprintf(stdout, "  Dim      %ld\n", ds.dim());
+        fprintf(stdout, "  Mapped   %s\n", ds.isMapped() ? "yes" : "no");
+        fprintf(stdout, "  Weight   %g%s\n", ds.totalWeight(), ds.weights() ? "" : " (unweighted)");
+        fprintf(stdout, "  Distance %s\n", distanceKernelName());
+    }
+    // the distances of k-means and DBSCAN reuse the |x|^2 of the points
+    if(bOk && ((options.m_command == Command_KNN && options.m_miniBatchSize == 0) || 
+               options.m_command == Command_DBSCAN))
+    {
+        ds.computeSquareNorms();
+    }
+    // the kd-tree of the filtering k-means, shared by the runs
+    if(bOk && options.m_command == Command_KNN && options.m_method == KMeansFilter && 
+       options.m_miniBatchSize == 0 && options.m_coresetSize == 0 && !options.m_bKMedoids)
+    {
+        ds.computeKdTree();
+    }
+    if(bOk && !options.m_binfname.empty())
+    {
+        bOk = ds.writeBinary(options.m_binfname);
+        fprintf(stdout, "* Binary data set '%s'\n", options.m_binfname.c_str());
     }
     if(bOk)
     {
@@ -134,6 +406,7 @@ int main(const int argc, const char** argv)
             size_t new_seed = time(NULL);
              srand(new_seed);
              fprintf(stdout, "Using random seed: %ld\n", new_seed);
+             options.m_seed = new_seed;
         }
         else
         {
@@ -155,6 +428,88 @@ int main(const int argc, const char** argv)
             case Command_KNN:
             {
                 fprintf(stdout, "computing xx knn: %s\n", options.m_outfile.c_str());
+                if(options.m_kSweepMax > 0)
+                {
+                    bOk = computeKMeansSweep(ds, 
+                                             options.m_kSweepMin, 
+                                             options.m_kSweepMax, 
+                                             "cluster", 
+                                             options.m_maxIter, 
+                                             options.m_method, 
+                                             options.m_tol);
+                    break;
+                }
+                if(options.m_bisectLeaves > 0)
+                {
+                    bOk = computeBisectingKMeans(ds, 
+                                                 options.m_bisectLeaves, 
+                                                 "cluster", 
+                                                 options.m_maxIter, 
+                                                 options.m_method, 
+                                                 options.m_tol,
+                                                 options.m_verbose);
+                    break;
+                }
+                if(options.m_coresetSize > 0)
+                {
+                    bOk = computeCoresetKMeans(ds, 
+                                               options.m_knn, 
+                                               options.m_coresetSize, 
+                                               "cluster", 
+                                               options.m_maxIter, 
+                                               options.m_method, 
+                                               options.m_init,
+                                               options.m_tol,
+                                               options.m_bCoresetAssign,
+                                               options.m_verbose);
+                    break;
+                }
+                if(options.m_bKMedoids)
+                {
+                    computeKMedoids(ds, 
+                                    options.m_knn, 
+                                    "cluster", 
+                                    options.m_maxIter, 
+                                    options.m_medoidMetric, 
+                                    options.m_claraSamples,
+                                    options.m_claraSampleSize,
+                                    options.m_verbose);
+                    break;
+                }
+                if(options.m_miniBatchSize > 0 && options.m_streamBlockSize > 0)
+                {
+                    computeMiniBatchStreamKMeans(options.m_dsfname, 
+                                                 options.m_knn, 
+                                                 "cluster", 
+                                                 options.m_miniBatchSize,
+                                                 options.m_miniBatchStep,
+                                                 options.m_seed,
+                                                 options.m_streamBlockSize,
+                                                 options.m_verbose);
+                    break;
+                }
+                if(options.m_miniBatchSize > 0)
+                {
+                    computeMiniBatchKMeans(ds, 
+                                           options.m_knn, 
+                                           "cluster", 
+                                           options.m_miniBatchSize,
+                                           options.m_miniBatchStep,
+                                           options.m_seed,
+                                           options.m_verbose);
+                    break;
+                }
+                if(options.m_streamBlockSize > 0)
+                {
+                    computeStreamKMeans(options.m_dsfname, 
+                                        options.m_knn, 
+                                        "cluster", 
+                                        options.m_maxIter, 
+                                        options.m_streamBlockSize,
+                                        options.m_verbose,
+                                        options.m_quantize);
+                    break;
+                }
                      /*
                      std::vector<DistPair> dist;
                      KMean(ds, 
@@ -164,18 +519,19 @@ int main(const int argc, const char** argv)
                            options.m_verbose);
                      */      
                            
-                computeKMeans(ds, options.m_knn, "cluster", options.m_maxIter, options.m_verbose);
+                bOk = computeKMeans(ds, options.m_knn, "cluster", options.m_maxIter, options.m_verbose, 
+                                    options.m_method, options.m_init, options.m_tol, options.m_nbInit);
                 break;
             }
             break;
             case Command_KNNTest:
-                KMeanTest(0, 0);
+                bOk = (KMeanTest(0, 0) == 0);
                 break;
             case Command_DBSCANTest:
                 DBScanTest(0, 0);
                 break;
         }
     }
-    return 0;
+    return bOk ? 0 : 1;
 }
 
@@ -10,12 +10,18 @@ QT       -= gui
 
 TARGET = cluster
 CONFIG   += console
+CONFIG   += c++11 thread
 CONFIG   -= app_bundle
 
 TEMPLATE = app
 
 INCLUDEPATH += $$(BOOSTDIR)
 
+# single precision coordinates storage: qmake CONFIG+=float_coord
+float_coord {
+    DEFINES += CLUSTER_FLOAT_COORD
+}
+
 
 CONFIG(debug, debug|release) {
     DESTDIR = ../build/debug
@@ -29,32 +35,58 @@ RCC_DIR = $$DESTDIR/.qrc
 UI_DIR = $$DESTDIR/.ui
 
 SOURCES += \
+    BatchAssigner.cpp \
     ClusterFunctions.cpp \
     ClusterSet.cpp \
     computeDBSCAN.cpp \
     DataSet.cpp \
     DataSetUtil.cpp \
+    DataSetStream.cpp \
+    Distance.cpp \
     GrahamScan.cpp \
     KMean.cpp \
+    BisectingKMeans.cpp \
+    Coreset.cpp \
+    KMeansBounds.cpp \
+    KMeansInit.cpp \
+    KdTree.cpp \
+    KMedoids.cpp \
     Point.cpp \
+    QuantizedDataSet.cpp \
     Random.cpp \
     cluster.cpp \
     KMeanTest.cpp \
     CommandLine.cpp \
+    Parallel.cpp \
+    StreamKMeans.cpp \
     Sort.cpp
 
 HEADERS += \
+    BatchAssigner.h \
     ClusterFunctions.h \
     ClusterSet.h \
     computeDBSCAN.h \
     DataSet.h \
     DataSetUtil.h \
+    DataSetFile.h \
+    DataSetStream.h \
+    Distance.h \
+    FixedPoint.h \
     GrahamScan.h \
     KMean.h \
+    BisectingKMeans.h \
+    Coreset.h \
+    KMeansBounds.h \
+    KMeansInit.h \
+    KdTree.h \
+    KMedoids.h \
     Point.h \
+    QuantizedDataSet.h \
     Random.h \
     KMeanTest.h \
     CommandLine.h \
+    Parallel.h \
+    StreamKMeans.h \
     Sort.h
 
 
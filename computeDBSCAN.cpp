@@ -3,68 +3,124 @@
 #include <algorithm>
 #include <vector>
 #include <cmath>
+#include <memory>
 
 #include "Point.h"
 #include "DataSet.h"
 #include "DataSetUtil.h"
+#include "Distance.h"
+#include "FixedPoint.h"
 #include "ClusterFunctions.h"
 
 ///////////////////////////////////////////////////////////////////////////////
 
-double distance(const Point& p1, const Point& p2)
+//
+// The points sorted by their norm |x|. By the triangle inequality, the points
+// at a distance <= eps of p have a norm in [|p|-eps, |p|+eps]: a query only
+// looks at the points of this band.
+//
+struct NormIndex
 {
-    double dist = sqrt(pow((p1.x() - p2.x()), 2) +
-                       pow((p1.y() - p2.y()), 2) );
-    return dist;
+    std::vector<DistanceType> m_pointNorm;  // |x| of each point
+    std::vector<DistanceType> m_norms;      // sorted |x|
+    std::vector<size_t>       m_points;     // the point of each sorted norm
+};
+
+// builds the index, from the cached square norms of the data set if any
+static void buildNormIndex(const DataSet& dbase, NormIndex& index)
+{
+    const size_t        nbPoints    = dbase.size();
+    const DistanceType* squareNorms = dbase.squareNorms();
+
+    std::vector<std::pair<DistanceType, size_t> > byNorm(nbPoints);
+    index.m_pointNorm.resize(nbPoints);
+    for(size_t i=0; i<nbPoints; i++)
+    {
+        const DistanceType norm2 = squareNorms 
+                                    ?   squareNorms[i] 
+                                    :   coordDot(dbase.coords(i), dbase.coords(i), dbase.dim());
+        index.m_pointNorm[i] = sqrt(norm2);
+        byNorm[i] = std::make_pair(index.m_pointNorm[i], i);
+    }
+    std::sort(byNorm.begin(), byNorm.end());
+
+    index.m_norms.resize(nbPoints);
+    index.m_points.resize(nbPoints);
+    for(size_t i=0; i<nbPoints; i++)
+    {
+        index.m_norms[i]  = byNorm[i].first;
+        index.m_points[i] = byNorm[i].second;
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 // pick the elements from the data base that are close to keypoint.
-void findNeighborPoints(const DataSet&       dbase,
-                        const size_t         pointId,
-                       double                eps,
-                       std::vector<size_t>&  queryRegion)
+template<class Dim>
+static void findNeighborPoints(const DataSet&       dbase,
+                               const NormIndex&     index,
+                               const size_t         pointId,
+                               double               eps,
+                               std::vector<size_t>& queryRegion)
 {
     queryRegion.resize(0);
-    double maxdist = 0.0;
-    double mindist = 1e38;
 
-    for(size_t i=0; i< dbase.size(); i++)
+    const size_t       dim    = dbase.dim();
+    const Coord*       p0     = dbase.coords(pointId);
+    const DistanceType eps2   = eps * eps;
+
+    // the band of norms, with a margin for the rounding errors of the norms
+    const DistanceType norm0  = index.m_pointNorm[pointId];
+    const DistanceType margin = 1e-9 * (norm0 + eps);
+    const size_t       begin  = std::lower_bound(index.m_norms.begin(), index.m_norms.end(), 
+                                                 norm0 - eps - margin) - index.m_norms.begin();
+    const size_t       end    = std::upper_bound(index.m_norms.begin(), index.m_norms.end(), 
+                                                 norm0 + eps + margin) - index.m_norms.begin();
+
+    for(size_t k=begin; k<end; k++)
     {
+        const size_t i = index.m_points[k];
         if(pointId == i) continue;
-        const double dist = distance(dbase[i], dbase[pointId]);
-
-        maxdist = std::max(maxdist, dist);
-        mindist = std::min(mindist, dist);
+        const DistanceType dist2 = Dim::squareDistance(dbase.coords(i), p0, dim);
 
-        //fprintf(stdout, "%g\n", dist);
-        if(dist>0 && dist <= eps)
+        if(dist2>0 && dist2 <= eps2)
         {
             queryRegion.push_back(i);
         }
     }
-    //fprintf(stdout, "poin:%ld, queryRegion size: %ld (eps:%g) dist:[%g, %g]\n",
-    //       pointId, queryRegion.size(), eps, maxdist, mindist);
+    // the data set order, as the clusters expansion depends on it
+    std::sort(queryRegion.begin(), queryRegion.end());
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-
-void compute_DBSCAN(const DataSet&              dbase,
-                    const double                eps,
-                    const size_t                minPts,
-                    std::vector<PointIdSet >&   clusters,
-                    PointIdSet&                 noise,
-                    bool                        bVerbose)
+// the number of points of a neighbourhood, compared to minPts: a point of
+// weight w counts as w points (as its copies do not count in their own
+// neighbourhood, the points at a distance 0 are not neighbours)
+static double regionWeight(const DataSet&             dbase,
+                           const std::vector<size_t>& queryRegion)
 {
-    if(bVerbose)
+    const double* weights = dbase.weights();
+    if(!weights)
     {
-        fprintf(stdout, "** Computing DBSCAN.(minPts:%ld, eps:%g, nbPts:%ld)\n", 
-                    minPts, 
-                    eps, 
-                    dbase.size());
+        return (double)queryRegion.size();
+    }
+    double weight = 0.0;
+    for(size_t k=0; k<queryRegion.size(); k++)
+    {
+        weight += weights[queryRegion[k]];
     }
+    return weight;
+}
+
+///////////////////////////////////////////////////////////////////////////////
 
+template<class Dim>
+static void compute_DBSCAN_(const DataSet&              dbase,
+                            const double                eps,
+                            const size_t                minPts,
+                            std::vector<PointIdSet >&   clusters,
+                            PointIdSet&                 noise)
+{
     std::vector<size_t>              neighborPts;
     std::vector<size_t>              neighborPts_;
 
@@ -79,14 +135,17 @@ void compute_DBSCAN(const DataSet&              dbase,
     // starts with an empty cluster
     clusters.resize(0);
 
+    NormIndex index;
+    buildNormIndex(dbase, index);
+
     //for each un-visted point P in dataset dbase
     for(size_t i=0; i<nbPoints; i++)
     {
         if(visited[i]) continue;
         visited[i] = true;
 
-        findNeighborPoints(dbase, i, eps, neighborPts);
-        if(neighborPts.size() < minPts)
+        findNeighborPoints<Dim>(dbase, index, i, eps, neighborPts);
+        if(regionWeight(dbase, neighborPts) < minPts)
         {
             // Mark P noise, since there is less then minPts in the neighbourhood.
             noise.insert(dbase[i].getId());
@@ -113,8 +172,8 @@ void compute_DBSCAN(const DataSet&              dbase,
                     //Mark P' as visited
                     visited[neighbour_j] = true;
 
-                    findNeighborPoints(dbase, neighbour_j, eps, neighborPts_);
-                    if(neighborPts_.size() >= minPts)
+                    findNeighborPoints<Dim>(dbase, index, neighbour_j, eps, neighborPts_);
+                    if(regionWeight(dbase, neighborPts_) >= minPts)
                     {
                         neighborPts.insert(neighborPts.end(), neighborPts_.begin(), neighborPts_.end());
                     }
@@ -130,6 +189,31 @@ void compute_DBSCAN(const DataSet&              dbase,
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+void compute_DBSCAN(const DataSet&              dbase,
+                    const double                eps,
+                    const size_t                minPts,
+                    std::vector<PointIdSet >&   clusters,
+                    PointIdSet&                 noise,
+                    bool                        bVerbose)
+{
+    if(bVerbose)
+    {
+        fprintf(stdout, "** Computing DBSCAN.(minPts:%ld, eps:%g, nbPts:%ld)\n", 
+                    minPts, 
+                    eps, 
+                    dbase.size());
+    }
+    switch(dbase.dim())
+    {
+        case 2:  compute_DBSCAN_< FixedDim<2> >(dbase, eps, minPts, clusters, noise); break;
+        case 3:  compute_DBSCAN_< FixedDim<3> >(dbase, eps, minPts, clusters, noise); break;
+        case 4:  compute_DBSCAN_< FixedDim<4> >(dbase, eps, minPts, clusters, noise); break;
+        default: compute_DBSCAN_< FixedDim<0> >(dbase, eps, minPts, clusters, noise); break;
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 #include "DataSet.h"
 #include "DataSetUtil.h"
@@ -188,12 +272,12 @@ void computeDBSCAN(const DataSet&       ds,
     fprintf(stdout, "* eps:         %g\n",  eps);
     fprintf(stdout, "* minPts:      %ld\n", minPts);
 
-    std::auto_ptr<ClusterSet> cs(createClusterSet(ds, clusters, noise));
+    std::unique_ptr<ClusterSet> cs(createClusterSet(ds, clusters, noise));
 
 
     for(ClusterId cid=0; cid<cs->nbCluster(); cid++)
     {
-        std::vector<Point*> curve;
+        std::vector<Point> curve;
 
         std::string curveName = clusterName + ".region." + toString(cid) + ".txt";
         computeClusterBondary(*cs, cid, curve, curveName, bVerbose);